@@ -0,0 +1,767 @@
+#include "Benchmarks.h" // We are implementing these
+
+#include "Metric.h" // Metrics
+#include "Diagnostics.h" // Diagnostics (and their options)
+#include "Terminations.h" // Terminations (and their options)
+#include "Geodesic.h" // Geodesic, GeodesicBatch, NoSource
+#include "ViewScreen.h" // ViewScreen
+#include "Mesh.h" // Meshes
+#include "Integrators.h" // integrator functions
+#include "InputOutput.h" // GeodesicOutputHandler, ScreenOutput
+#include "Utilities.h" // Utilities::Timer, Utilities::GetDiagNameStrings
+
+#include <algorithm> // std::sort, std::max, std::min
+#include <array> // std::array
+#include <cmath> // std::floor, std::sqrt, std::isfinite
+#include <ctime> // std::time, std::strftime
+#include <cstdio> // std::snprintf
+#include <filesystem> // std::filesystem (for the output benchmarks)
+#include <functional> // std::function
+#include <iomanip> // std::setprecision
+#include <memory> // std::unique_ptr, std::shared_ptr
+#include <random> // std::mt19937, std::uniform_real_distribution
+#include <sstream> // std::ostringstream
+#include <utility> // std::move
+
+#include <omp.h> // omp_get_max_threads
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Internal helpers: benchmark registration, the shared setup and the benchmarks themselves
+
+namespace
+{
+    /// <summary>
+    /// Benchmark registration and timing
+    /// </summary>
+
+    // What a single timed repetition of a benchmark returns
+    struct TimedRun
+    {
+        double Seconds{};
+        real Checksum{};
+        largecounter Items{};
+        largecounter Bytes{};
+    };
+
+    // A registered benchmark: its name, group, what it processes, and the function that performs one timed repetition
+    struct Benchmark
+    {
+        std::string Name;
+        std::string Group;
+        std::string ItemName;
+        std::function<TimedRun()> Run;
+    };
+
+    // The number of iterations of a benchmark, taking into account the scale factor of the settings
+    largecounter Scaled(largecounter iterations, const BenchmarkSettings& settings)
+    {
+        return std::max(static_cast<largecounter>(1), static_cast<largecounter>(iterations * settings.Scale));
+    }
+
+    // Runs a benchmark: one warmup run, then settings.Repetitions timed runs
+    BenchmarkResult RunBenchmark(const Benchmark& theBenchmark, const BenchmarkSettings& settings)
+    {
+        theBenchmark.Run();
+
+        std::vector<double> times{};
+        TimedRun lastrun{};
+        for (int i = 0; i < std::max(settings.Repetitions, 1); ++i)
+        {
+            lastrun = theBenchmark.Run();
+            times.push_back(lastrun.Seconds);
+        }
+        std::sort(times.begin(), times.end());
+
+        BenchmarkResult result{};
+        result.Name = theBenchmark.Name;
+        result.Group = theBenchmark.Group;
+        result.Items = lastrun.Items;
+        result.ItemName = theBenchmark.ItemName;
+        result.Bytes = lastrun.Bytes;
+        result.BestTime = times.front();
+        result.MedianTime = times.size() % 2 == 1 ? times[times.size() / 2]
+            : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+        result.Checksum = lastrun.Checksum;
+        return result;
+    }
+
+
+    /// <summary>
+    /// Shared setup
+    /// </summary>
+
+    // The Diagnostics, Terminations and camera used by all geodesic-related benchmarks: these are the same as the default
+    // precompiled options (see LoadPrecompiledOptions() in Main.cpp), with the ClosestRadius Diagnostic added
+    const DiagBitflag BenchDiags{ Diag_FourColorScreen | Diag_EquatorialPasses | Diag_ClosestRadius };
+    const DiagBitflag BenchValDiag{ Diag_EquatorialPasses };
+    const TermBitflag BenchTerms{ Term_BoundarySphere | Term_Horizon | Term_TimeOut };
+    const Point CameraPos{ 0, 1000, pi / 2, 0 };
+    const ScreenPoint CameraScreenSize{ 15, 15 };
+
+    // Sets the static Diagnostic and Termination options for the given Metric
+    void SetBenchmarkOptions(const Metric* theMetric)
+    {
+        EquatorialPassesDiagnostic::DiagOptions =
+            std::unique_ptr<EquatorialPassesOptions>(new EquatorialPassesOptions{ 0.01, UpdateFrequency{1,false,false} });
+        ClosestRadiusDiagnostic::DiagOptions =
+            std::unique_ptr<ClosestRadiusOptions>(new ClosestRadiusOptions{ false, UpdateFrequency{1,false,false} });
+        GeodesicPositionDiagnostic::DiagOptions =
+            std::unique_ptr<GeodesicPositionOptions>(new GeodesicPositionOptions{ 5000, UpdateFrequency{1,false,false} });
+
+        const SphericalHorizonMetric* theHorizonMetric{ dynamic_cast<const SphericalHorizonMetric*>(theMetric) };
+        if (theHorizonMetric)
+            HorizonTermination::TermOptions = std::unique_ptr<HorizonTermOptions>(new HorizonTermOptions{
+                theHorizonMetric->getHorizonRadius(), theHorizonMetric->getrLogScale(), 0.01, 1 });
+        BoundarySphereTermination::TermOptions =
+            std::unique_ptr<BoundarySphereTermOptions>(new BoundarySphereTermOptions{ 1000, false, 1 });
+        TimeOutTermination::TermOptions =
+            std::unique_ptr<TimeOutTermOptions>(new TimeOutTermOptions{ 100000, 1 });
+    }
+
+    // All state shared by the integrator and geodesic benchmarks: a Kerr black hole seen from the equator,
+    // the initial conditions of a captured, a scattered and a near-critical ray, and a sample of (position, velocity)
+    // states along the near-critical ray (which probes the strong-field region where most integration steps are taken)
+    struct GeodesicSetup
+    {
+        std::unique_ptr<Metric> theMetric{};
+        std::unique_ptr<Source> theSource{};
+        CameraRayGenerator theRayGenerator{};
+
+        ScreenPoint CapturedPoint{ 0.5, 0.5 };
+        ScreenPoint ScatteredPoint{ 0.95, 0.7 };
+        ScreenPoint NearCriticalPoint{};
+
+        std::vector<Point> SamplePos{};
+        std::vector<OneIndex> SampleVel{};
+    };
+
+    // Integrates the geodesic through the given screen point to the end; returns the number of steps taken
+    largecounter IntegrateRay(Geodesic& theGeodesic, const CameraRayGenerator& theRayGenerator, const ScreenPoint& unitpoint)
+    {
+        theGeodesic.Reset(ScreenIndex{}, theRayGenerator.getPosition(), theRayGenerator.getVelocity(unitpoint));
+        largecounter steps{ 0 };
+        while (theGeodesic.getTermCondition() == Term::Continue)
+        {
+            theGeodesic.Update();
+            ++steps;
+        }
+        return steps;
+    }
+
+    std::shared_ptr<GeodesicSetup> CreateGeodesicSetup()
+    {
+        auto setup{ std::make_shared<GeodesicSetup>() };
+        setup->theMetric = std::unique_ptr<Metric>(new KerrMetric(0.9, false));
+        setup->theSource = std::unique_ptr<Source>(new NoSource(setup->theMetric.get()));
+        SetBenchmarkOptions(setup->theMetric.get());
+
+        // The ViewScreen sets up the camera; we only keep its ray generator
+        ViewScreen theView(CameraPos, OneIndex{ 0,-1,0,0 }, CameraScreenSize, ScreenPoint{ 0,0 },
+            std::unique_ptr<Mesh>(new SimpleSquareMesh(1, BenchValDiag)), setup->theMetric.get());
+        setup->theRayGenerator = theView.getRayGenerator();
+
+        // Find the edge of the shadow along the horizontal line through the screen center by bisection:
+        // the center of the screen is captured and its edge is scattered
+        Geodesic theGeodesic(setup->theMetric.get(), setup->theSource.get(), BenchDiags, BenchValDiag, BenchTerms,
+            Integrators::IntegrateGeodesicStep_RK4);
+        real captured{ 0.5 }, scattered{ 1.0 };
+        IntegrateRay(theGeodesic, setup->theRayGenerator, ScreenPoint{ captured, 0.5 });
+        const bool centercaptured{ theGeodesic.getTermCondition() == Term::Horizon };
+        IntegrateRay(theGeodesic, setup->theRayGenerator, ScreenPoint{ scattered, 0.5 });
+        if (!centercaptured || theGeodesic.getTermCondition() != Term::BoundarySphere)
+            ScreenOutput("Benchmarks: could not bracket the shadow edge; the near-critical ray is not near-critical!",
+                OutputLevel::Level_0_WARNING);
+        for (int i = 0; i < 30; ++i)
+        {
+            const real middle{ 0.5 * (captured + scattered) };
+            IntegrateRay(theGeodesic, setup->theRayGenerator, ScreenPoint{ middle, 0.5 });
+            if (theGeodesic.getTermCondition() == Term::Horizon)
+                captured = middle;
+            else
+                scattered = middle;
+        }
+        // Take the scattered side, so that the ray does end on the boundary sphere
+        setup->NearCriticalPoint = ScreenPoint{ scattered, 0.5 };
+
+        // Sample states along the near-critical ray
+        std::vector<Point> allpos{};
+        std::vector<OneIndex> allvel{};
+        theGeodesic.Reset(ScreenIndex{}, setup->theRayGenerator.getPosition(),
+            setup->theRayGenerator.getVelocity(setup->NearCriticalPoint));
+        while (theGeodesic.getTermCondition() == Term::Continue)
+        {
+            allpos.push_back(theGeodesic.getCurrentPos());
+            allvel.push_back(theGeodesic.getCurrentVel());
+            theGeodesic.Update();
+        }
+        constexpr std::size_t nrsamples{ 512 };
+        for (std::size_t i = 0; i < nrsamples && !allpos.empty(); ++i)
+        {
+            setup->SamplePos.push_back(allpos[i * allpos.size() / nrsamples]);
+            setup->SampleVel.push_back(allvel[i * allvel.size() / nrsamples]);
+        }
+
+        return setup;
+    }
+
+
+    /// <summary>
+    /// Regression checks
+    /// </summary>
+
+    // Geodesics through the polar axis (see SphericalHorizonMetric::PolarAxisThreshold): two rays with zero angular
+    // momentum (on the vertical line through the screen center) of a camera close to the north pole of a Kerr black hole,
+    // which pass (almost) exactly through the polar axis. The first ray falls into the black hole, the second one escapes
+    // (on the other side of the axis). A ray that blows up on the axis ends up far outside 0 <= theta <= pi.
+    bool CheckPolarAxisGeodesics()
+    {
+        KerrMetric theMetric(0.5, false);
+        NoSource theSource(&theMetric);
+        SetBenchmarkOptions(&theMetric);
+        ViewScreen theView(Point{ 0, 1000, 0.2966972222222, 0 }, OneIndex{ 0,-1,0,0 }, CameraScreenSize, ScreenPoint{ 0,0 },
+            std::unique_ptr<Mesh>(new SimpleSquareMesh(1, BenchValDiag)), &theMetric);
+        Geodesic theGeodesic(&theMetric, &theSource, BenchDiags, BenchValDiag, BenchTerms, Integrators::IntegrateGeodesicStep_RK4);
+
+        IntegrateRay(theGeodesic, theView.getRayGenerator(), ScreenPoint{ 0.5, 0.75 });
+        const bool captured{ theGeodesic.getTermCondition() == Term::Horizon };
+        IntegrateRay(theGeodesic, theView.getRayGenerator(), ScreenPoint{ 0.5, 1.0 });
+        const real escapetheta{ theGeodesic.getCurrentPos()[2] };
+        const bool escaped{ theGeodesic.getTermCondition() == Term::BoundarySphere && escapetheta >= 0 && escapetheta <= pi };
+
+        if (!captured || !escaped)
+            ScreenOutput("Benchmarks: geodesics through the polar axis are not integrated correctly!", OutputLevel::Level_0_WARNING);
+        return captured && escaped;
+    }
+
+
+    /// <summary>
+    /// Metric benchmarks: getMetric_dd(), getMetric_uu() and getChristoffel_udd() for every Metric
+    /// </summary>
+
+    void AddMetricBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings)
+    {
+        struct MetricCase
+        {
+            std::string Name;
+            std::shared_ptr<Metric> theMetric;
+        };
+        const std::vector<MetricCase> allMetrics{
+            { "Kerr", std::make_shared<KerrMetric>(0.9, false) },
+            { "KerrLogR", std::make_shared<KerrMetric>(0.9, true) },
+            { "FlatSpace", std::make_shared<FlatSpaceMetric>() },
+            { "RasheedLarsen", std::make_shared<RasheedLarsenMetric>(0.3556562853309941, 0.2969060968239216,
+                3.057664971085168, 0.942335028914832, false) },
+            { "Johannsen", std::make_shared<JohannsenMetric>(0.7, 2.0, 0.5, 0.3, 0.2, false) },
+            { "MankoNovikov", std::make_shared<MankoNovikovMetric>(0.5, 0.3, false) }
+        };
+
+        const largecounter nrevaluations{ Scaled(500000, settings) };
+
+        for (const auto& thecase : allMetrics)
+        {
+            // Fixed (pseudo)random points outside all horizons and away from the poles
+            auto points{ std::make_shared<std::vector<Point>>() };
+            std::mt19937 generator{ 1 };
+            std::uniform_real_distribution<real> rdist{ 3.5, 25.0 }, thdist{ 0.3, pi - 0.3 }, phidist{ 0, 2 * pi };
+            const SphericalHorizonMetric* theHorizonMetric{ dynamic_cast<const SphericalHorizonMetric*>(thecase.theMetric.get()) };
+            const bool rlogscale{ theHorizonMetric && theHorizonMetric->getrLogScale() };
+            for (int i = 0; i < 1024; ++i)
+            {
+                const real r{ rdist(generator) };
+                points->push_back(Point{ 0, rlogscale ? log(r) : r, thdist(generator), phidist(generator) });
+            }
+
+            std::shared_ptr<Metric> theMetric{ thecase.theMetric };
+
+            benchmarks.push_back({ "metric/" + thecase.Name + "/getMetric_dd", "metric", "evaluations",
+                [theMetric, points, nrevaluations]()
+                {
+                    real checksum{ 0 };
+                    Utilities::Timer thetimer;
+                    for (largecounter i = 0; i < nrevaluations; ++i)
+                        checksum += theMetric->getMetric_dd((*points)[i % points->size()])[0][3];
+                    return TimedRun{ thetimer.elapsed(), checksum, nrevaluations };
+                } });
+            benchmarks.push_back({ "metric/" + thecase.Name + "/getMetric_uu", "metric", "evaluations",
+                [theMetric, points, nrevaluations]()
+                {
+                    real checksum{ 0 };
+                    Utilities::Timer thetimer;
+                    for (largecounter i = 0; i < nrevaluations; ++i)
+                        checksum += theMetric->getMetric_uu((*points)[i % points->size()])[0][3];
+                    return TimedRun{ thetimer.elapsed(), checksum, nrevaluations };
+                } });
+            benchmarks.push_back({ "metric/" + thecase.Name + "/getChristoffel_udd", "metric", "evaluations",
+                [theMetric, points, nrevaluations]()
+                {
+                    real checksum{ 0 };
+                    Utilities::Timer thetimer;
+                    for (largecounter i = 0; i < nrevaluations / 10; ++i)
+                        checksum += theMetric->getChristoffel_udd((*points)[i % points->size()])[1][0][3];
+                    return TimedRun{ thetimer.elapsed(), checksum, nrevaluations / 10 };
+                } });
+        }
+    }
+
+
+    /// <summary>
+    /// Integrator benchmarks: a single step of every integrator, taken from states along the near-critical ray
+    /// </summary>
+
+    void AddIntegratorBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings,
+        const std::shared_ptr<GeodesicSetup>& setup)
+    {
+        const largecounter nrsteps{ Scaled(100000, settings) };
+
+        struct IntegratorCase
+        {
+            std::string Name;
+            GeodesicIntegratorFunc theIntegrator;
+        };
+        const std::vector<IntegratorCase> allIntegrators{
+            { "RK4", Integrators::IntegrateGeodesicStep_RK4 },
+            { "Verlet", Integrators::IntegrateGeodesicStep_Verlet },
+            { "RK45", Integrators::IntegrateGeodesicStep_RK45 }
+        };
+
+        for (const auto& thecase : allIntegrators)
+        {
+            for (bool specialized : { false, true })
+            {
+                GeodesicIntegratorFunc theIntegrator{ specialized
+                    ? Integrators::SpecializeIntegrator(thecase.theIntegrator, setup->theMetric.get())
+                    : thecase.theIntegrator };
+                benchmarks.push_back({ "integrator/" + thecase.Name + (specialized ? "/specialized" : "/generic"),
+                    "integrator", "steps",
+                    [setup, theIntegrator, nrsteps]()
+                    {
+                        real checksum{ 0 };
+                        Point nextpos{};
+                        OneIndex nextvel{};
+                        real stepsize{};
+                        const std::size_t nrsamples{ setup->SamplePos.size() };
+                        Utilities::Timer thetimer;
+                        for (largecounter i = 0; i < nrsteps; ++i)
+                        {
+                            theIntegrator(setup->SamplePos[i % nrsamples], setup->SampleVel[i % nrsamples],
+                                nextpos, nextvel, stepsize, setup->theMetric.get(), setup->theSource.get());
+                            checksum += stepsize;
+                        }
+                        return TimedRun{ thetimer.elapsed(), checksum, nrsteps };
+                    } });
+            }
+        }
+
+        // The batched RK4 integrator, with every lane of the batch taking a step (a step per lane is counted)
+        benchmarks.push_back({ "integrator/RK4/batch", "integrator", "steps",
+            [setup, nrsteps]()
+            {
+                real checksum{ 0 };
+                BatchPoint curpos{}, nextpos{};
+                BatchOneIndex curvel{}, nextvel{};
+                BatchReal stepsize{};
+                const std::size_t nrsamples{ setup->SamplePos.size() };
+                const largecounter nrbatches{ nrsteps / BatchSize };
+                Utilities::Timer thetimer;
+                for (largecounter i = 0; i < nrbatches; ++i)
+                {
+                    for (int lane = 0; lane < BatchSize; ++lane)
+                    {
+                        const std::size_t sample{ (i * BatchSize + lane) % nrsamples };
+                        for (int mu = 0; mu < dimension; ++mu)
+                        {
+                            curpos[mu][lane] = setup->SamplePos[sample][mu];
+                            curvel[mu][lane] = setup->SampleVel[sample][mu];
+                        }
+                    }
+                    Integrators::IntegrateGeodesicStep_RK4_Batch(curpos, curvel, nextpos, nextvel, stepsize,
+                        setup->theMetric.get(), setup->theSource.get());
+                    for (int lane = 0; lane < BatchSize; ++lane)
+                        checksum += stepsize[lane];
+                }
+                return TimedRun{ thetimer.elapsed(), checksum, nrbatches * BatchSize };
+            } });
+    }
+
+
+    /// <summary>
+    /// Geodesic benchmarks: full geodesics (with the default Diagnostics and Terminations) for representative rays
+    /// </summary>
+
+    void AddGeodesicBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings,
+        const std::shared_ptr<GeodesicSetup>& setup)
+    {
+        const std::vector<std::pair<std::string, ScreenPoint>> allRays{
+            { "captured", setup->CapturedPoint },
+            { "scattered", setup->ScatteredPoint },
+            { "nearcritical", setup->NearCriticalPoint }
+        };
+        const largecounter nrgeodesics{ Scaled(100, settings) };
+
+        for (const auto& theray : allRays)
+        {
+            const ScreenPoint unitpoint{ theray.second };
+            benchmarks.push_back({ "geodesic/" + theray.first, "geodesic", "steps",
+                [setup, unitpoint, nrgeodesics]()
+                {
+                    // (The options are set again, since other benchmarks may have changed them)
+                    SetBenchmarkOptions(setup->theMetric.get());
+                    Geodesic theGeodesic(setup->theMetric.get(), setup->theSource.get(), BenchDiags, BenchValDiag, BenchTerms,
+                        Integrators::IntegrateGeodesicStep_RK4);
+                    real checksum{ 0 };
+                    largecounter steps{ 0 };
+                    Utilities::Timer thetimer;
+                    for (largecounter i = 0; i < nrgeodesics; ++i)
+                    {
+                        steps += IntegrateRay(theGeodesic, setup->theRayGenerator, unitpoint);
+                        checksum += theGeodesic.getCurrentLambda();
+                    }
+                    return TimedRun{ thetimer.elapsed(), checksum, steps };
+                } });
+        }
+    }
+
+
+    /// <summary>
+    /// Initial condition benchmarks: ViewScreen::SetNewInitialConditions(), per geodesic and per batch
+    /// </summary>
+
+    void AddInitialConditionBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings,
+        const std::shared_ptr<GeodesicSetup>& setup)
+    {
+        const largecounter nrpixels{ Scaled(250000, settings) };
+        auto theView{ std::make_shared<ViewScreen>(CameraPos, OneIndex{ 0,-1,0,0 }, CameraScreenSize, ScreenPoint{ 0,0 },
+            std::unique_ptr<Mesh>(new SimpleSquareMesh(nrpixels, BenchValDiag)), setup->theMetric.get()) };
+
+        benchmarks.push_back({ "initialconditions/single", "initialconditions", "geodesics",
+            [theView]()
+            {
+                real checksum{ 0 };
+                Point pos{};
+                OneIndex vel{};
+                ScreenIndex scrindex{};
+                const largecounter nrgeodesics{ theView->getCurNrGeodesics() };
+                Utilities::Timer thetimer;
+                for (largecounter i = 0; i < nrgeodesics; ++i)
+                {
+                    theView->SetNewInitialConditions(i, pos, vel, scrindex);
+                    checksum += vel[2];
+                }
+                return TimedRun{ thetimer.elapsed(), checksum, nrgeodesics };
+            } });
+
+        benchmarks.push_back({ "initialconditions/batch", "initialconditions", "geodesics",
+            [theView]()
+            {
+                real checksum{ 0 };
+                std::array<largecounter, BatchSize> indices{};
+                std::array<Point, BatchSize> pos{};
+                std::array<OneIndex, BatchSize> vel{};
+                std::array<ScreenIndex, BatchSize> scrindex{};
+                const largecounter nrgeodesics{ theView->getCurNrGeodesics() };
+                Utilities::Timer thetimer;
+                for (largecounter i = 0; i < nrgeodesics; i += BatchSize)
+                {
+                    const std::size_t nrinbatch{ static_cast<std::size_t>(std::min<largecounter>(BatchSize, nrgeodesics - i)) };
+                    for (std::size_t j = 0; j < nrinbatch; ++j)
+                        indices[j] = i + j;
+                    theView->SetNewInitialConditions(indices.data(), nrinbatch, pos.data(), vel.data(), scrindex.data());
+                    for (std::size_t j = 0; j < nrinbatch; ++j)
+                        checksum += vel[j][2];
+                }
+                return TimedRun{ thetimer.elapsed(), checksum, nrgeodesics };
+            } });
+    }
+
+
+    /// <summary>
+    /// Mesh benchmarks: the adaptive refinement of SquareSubdivisionMeshV2, fed with synthetic values
+    /// </summary>
+
+    void AddMeshBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings)
+    {
+        const largecounter maxpixels{ Scaled(400000, settings) };
+
+        for (bool pipelined : { false, true })
+        {
+            benchmarks.push_back({ std::string("mesh/SquareSubdivisionMeshV2/") + (pipelined ? "pipelined" : "atend"),
+                "mesh", "iterations",
+                [maxpixels, pipelined]()
+                {
+                    EquatorialPassesDiagnostic::DiagOptions =
+                        std::unique_ptr<EquatorialPassesOptions>(new EquatorialPassesOptions{ 0.01, UpdateFrequency{1,false,false} });
+                    SquareSubdivisionMeshV2 theMesh(maxpixels, 10000, 8, maxpixels / 20, true, Diag_EquatorialPasses, pipelined);
+
+                    real checksum{ 0 };
+                    largecounter iterations{ 0 };
+                    double meshtime{ 0 };
+                    while (!theMesh.IsFinished())
+                    {
+                        const largecounter nrgeodesics{ theMesh.getCurNrGeodesics() };
+                        // The synthetic "value" of a pixel is the number of (elliptic) rings around a point near the
+                        // screen center that it lies in, mimicking the number of equatorial passes of an image
+                        std::vector<std::vector<real>> values(nrgeodesics);
+                        for (largecounter i = 0; i < nrgeodesics; ++i)
+                        {
+                            ScreenPoint unitpoint{};
+                            ScreenIndex scrindex{};
+                            theMesh.getNewInitConds(i, unitpoint, scrindex);
+                            const real r{ std::sqrt((unitpoint[0] - 0.5) * (unitpoint[0] - 0.5)
+                                + 2 * (unitpoint[1] - 0.45) * (unitpoint[1] - 0.45)) };
+                            values[i] = std::vector<real>{ std::floor(r * 12) };
+                        }
+
+                        // Only the Mesh's own work is timed
+                        Utilities::Timer thetimer;
+                        for (largecounter i = 0; i < nrgeodesics; ++i)
+                            theMesh.GeodesicFinished(i, std::move(values[i]));
+                        // (like main(), the Mesh wraps up the iteration in a single thread of a parallel region)
+#pragma omp parallel
+#pragma omp single
+                        theMesh.EndCurrentLoop();
+                        meshtime += thetimer.elapsed();
+
+                        checksum += nrgeodesics;
+                        ++iterations;
+                    }
+                    return TimedRun{ meshtime, checksum, iterations };
+                } });
+        }
+    }
+
+
+    /// <summary>
+    /// Output benchmarks: throughput of the GeodesicOutputHandler, from receiving output to having written it to file
+    /// </summary>
+
+    void AddOutputBenchmarks(std::vector<Benchmark>& benchmarks, const BenchmarkSettings& settings,
+        const std::shared_ptr<GeodesicSetup>& setup)
+    {
+        const largecounter nrrecords{ Scaled(200000, settings) };
+        const std::string outputdir{ settings.OutputDirectory };
+
+        // The output of a (scattered) geodesic, which is used for every record
+        SetBenchmarkOptions(setup->theMetric.get());
+        Geodesic theGeodesic(setup->theMetric.get(), setup->theSource.get(), BenchDiags, BenchValDiag, BenchTerms,
+            Integrators::IntegrateGeodesicStep_RK4);
+        IntegrateRay(theGeodesic, setup->theRayGenerator, setup->ScatteredPoint);
+        auto textoutput{ std::make_shared<GeodesicOutputRecord>() };
+        auto valoutput{ std::make_shared<GeodesicOutputRecord>() };
+        theGeodesic.WriteAllOutput(*textoutput, false);
+        theGeodesic.WriteAllOutput(*valoutput, true);
+
+        struct OutputCase
+        {
+            std::string Name;
+            OutputFormat Format;
+            largecounter StreamBufferSize;
+        };
+        const std::vector<OutputCase> allCases{
+            { "text", OutputFormat::Text, 0 },
+            { "binary", OutputFormat::Binary, 0 },
+            { "text/streaming", OutputFormat::Text, 10000 },
+            { "binary/streaming", OutputFormat::Binary, 10000 }
+        };
+
+        for (const auto& thecase : allCases)
+        {
+            benchmarks.push_back({ "output/" + thecase.Name, "output", "records",
+                [thecase, nrrecords, outputdir, textoutput, valoutput]()
+                {
+                    const std::filesystem::path thedir{ std::filesystem::path(outputdir) / "run" };
+                    std::filesystem::remove_all(thedir);
+                    std::filesystem::create_directories(thedir);
+
+                    // The same record is passed for every geodesic (as in FOORT itself), only its screen index changes
+                    const pixelcoord rowsize{ static_cast<pixelcoord>(std::sqrt(nrrecords)) + 1 };
+                    GeodesicOutputRecord therecord{ thecase.Format == OutputFormat::Text ? *textoutput : *valoutput };
+
+                    Utilities::Timer thetimer;
+                    {
+                        GeodesicOutputHandler theHandler((thedir / "bench").string(), "", "dat",
+                            Utilities::GetDiagNameStrings(BenchDiags, BenchValDiag), 50000, LARGECOUNTER_MAX, "",
+                            thecase.Format, thecase.StreamBufferSize);
+                        theHandler.PrepareForOutput(nrrecords);
+                        for (largecounter i = 0; i < nrrecords; ++i)
+                        {
+                            therecord.Index = ScreenIndex{ i % rowsize, i / rowsize };
+                            theHandler.NewGeodesicOutput(i, therecord);
+                        }
+                        theHandler.OutputFinished();
+                    }
+                    const double elapsed{ thetimer.elapsed() };
+
+                    largecounter bytes{ 0 };
+                    for (const auto& entry : std::filesystem::directory_iterator(thedir))
+                        bytes += std::filesystem::file_size(entry.path());
+                    std::filesystem::remove_all(thedir);
+
+                    return TimedRun{ elapsed, static_cast<real>(bytes), nrrecords, bytes };
+                } });
+        }
+    }
+
+
+    // Creates the list of all benchmarks (in the order in which they are run)
+    std::vector<Benchmark> CreateAllBenchmarks(const BenchmarkSettings& settings)
+    {
+        std::vector<Benchmark> benchmarks{};
+        auto setup{ CreateGeodesicSetup() };
+
+        AddMetricBenchmarks(benchmarks, settings);
+        AddIntegratorBenchmarks(benchmarks, settings, setup);
+        AddGeodesicBenchmarks(benchmarks, settings, setup);
+        AddInitialConditionBenchmarks(benchmarks, settings, setup);
+        AddMeshBenchmarks(benchmarks, settings);
+        AddOutputBenchmarks(benchmarks, settings, setup);
+
+        return benchmarks;
+    }
+
+    // Does the benchmark pass the filter of the settings?
+    bool PassesFilter(const Benchmark& theBenchmark, const BenchmarkSettings& settings)
+    {
+        return settings.Filter.empty() || theBenchmark.Name.find(settings.Filter) != std::string::npos;
+    }
+
+
+    /// <summary>
+    /// JSON output helpers
+    /// </summary>
+
+    // A string as a JSON string literal
+    std::string JSONString(const std::string& str)
+    {
+        std::string escaped{ "\"" };
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += buf;
+                }
+                else
+                    escaped += c;
+            }
+        }
+        return escaped + "\"";
+    }
+
+    // A number as a JSON number (JSON has no inf or nan, so these become null)
+    std::string JSONNumber(double number)
+    {
+        if (!std::isfinite(number))
+            return "null";
+        std::ostringstream out;
+        out << std::setprecision(10) << number;
+        return out.str();
+    }
+
+    // The compiler this suite was built with
+    std::string CompilerString()
+    {
+#if defined(__clang__)
+        return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    // The current time (UTC) in ISO 8601 format
+    std::string CurrentTimeString()
+    {
+        std::time_t now{ std::time(nullptr) };
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buf;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks namespace functions
+
+std::vector<std::string> Benchmarks::ListBenchmarks(const BenchmarkSettings& settings)
+{
+    std::vector<std::string> names{};
+    for (const auto& theBenchmark : CreateAllBenchmarks(settings))
+    {
+        if (PassesFilter(theBenchmark, settings))
+            names.push_back(theBenchmark.Name);
+    }
+    return names;
+}
+
+bool Benchmarks::RunRegressionChecks()
+{
+    const bool passed{ CheckPolarAxisGeodesics() };
+    ScreenOutput(std::string("Regression checks ") + (passed ? "passed." : "FAILED!"), OutputLevel::Level_1_PROC);
+    return passed;
+}
+
+std::vector<BenchmarkResult> Benchmarks::RunBenchmarks(const BenchmarkSettings& settings)
+{
+    std::vector<BenchmarkResult> results{};
+    for (const auto& theBenchmark : CreateAllBenchmarks(settings))
+    {
+        if (!PassesFilter(theBenchmark, settings))
+            continue;
+        results.push_back(RunBenchmark(theBenchmark, settings));
+
+        const BenchmarkResult& result{ results.back() };
+        ScreenOutput(result.Name + ": " + std::to_string(result.BestTime * 1e9 / std::max(result.Items, largecounter{ 1 }))
+            + " ns per " + result.ItemName.substr(0, result.ItemName.size() - 1)
+            + " (best of " + std::to_string(settings.Repetitions) + ")", OutputLevel::Level_1_PROC);
+    }
+    return results;
+}
+
+void Benchmarks::WriteJSON(std::ostream& out, const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results)
+{
+    out << "{\n";
+    out << "  \"suite\": \"FOORT microbenchmarks\",\n";
+    out << "  \"label\": " << JSONString(settings.Label) << ",\n";
+    out << "  \"date\": " << JSONString(CurrentTimeString()) << ",\n";
+    out << "  \"compiler\": " << JSONString(CompilerString()) << ",\n";
+    out << "  \"omp_max_threads\": " << omp_get_max_threads() << ",\n";
+    out << "  \"scale\": " << JSONNumber(settings.Scale) << ",\n";
+    out << "  \"repetitions\": " << settings.Repetitions << ",\n";
+    out << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result{ results[i] };
+        const double items{ static_cast<double>(std::max(result.Items, largecounter{ 1 })) };
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\n";
+        out << "      \"name\": " << JSONString(result.Name) << ",\n";
+        out << "      \"group\": " << JSONString(result.Group) << ",\n";
+        out << "      \"items\": " << result.Items << ",\n";
+        out << "      \"item_name\": " << JSONString(result.ItemName) << ",\n";
+        out << "      \"best_s\": " << JSONNumber(result.BestTime) << ",\n";
+        out << "      \"median_s\": " << JSONNumber(result.MedianTime) << ",\n";
+        out << "      \"ns_per_item\": " << JSONNumber(result.BestTime * 1e9 / items) << ",\n";
+        out << "      \"items_per_s\": " << JSONNumber(items / result.BestTime) << ",\n";
+        if (result.Bytes > 0)
+        {
+            out << "      \"bytes\": " << result.Bytes << ",\n";
+            out << "      \"bytes_per_s\": " << JSONNumber(result.Bytes / result.BestTime) << ",\n";
+        }
+        out << "      \"checksum\": " << JSONNumber(result.Checksum) << "\n";
+        out << "    }";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+}
@@ -0,0 +1,72 @@
+#ifndef _FOORT_BENCHMARKS_H
+#define _FOORT_BENCHMARKS_H
+
+///////////////////////////////////////////////////////////////////////////////////////
+////// BENCHMARKS.H
+////// Declarations of the microbenchmarks of the FOORT hot path.
+////// The benchmarks are built against the actual FOORT sources (in ../FOORT),
+////// so that they always time the code as it is in the current commit.
+////// All definitions in Benchmarks.cpp
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "Geometry.h" // for basic tensor objects and largecounter
+
+#include <ostream> // std::ostream
+#include <string> // std::string
+#include <vector> // std::vector
+
+
+// The settings of a benchmark run (set from the command line, see Main.cpp)
+struct BenchmarkSettings
+{
+    // Only run the benchmarks whose name contains this string (all benchmarks if empty)
+    std::string Filter{};
+    // All iteration counts are multiplied by this factor (e.g. 0.1 for a quick run)
+    real Scale{ 1.0 };
+    // Every benchmark is timed this many times; the best and median time are reported
+    int Repetitions{ 5 };
+    // Directory in which the output handler benchmarks write their (temporary) files
+    std::string OutputDirectory{ "BenchmarkOutput" };
+    // Free-form label that is copied into the JSON output (e.g. a commit hash)
+    std::string Label{};
+};
+
+// The result of a single benchmark
+struct BenchmarkResult
+{
+    // Unique name of the benchmark, of the form group/what/variant
+    std::string Name{};
+    // The group the benchmark belongs to (metric, integrator, geodesic, initialconditions, mesh, output)
+    std::string Group{};
+    // The number of items processed in one timed repetition (metric evaluations, integration steps, geodesics,
+    // mesh iterations, output records, ...) and what these items are
+    largecounter Items{};
+    std::string ItemName{};
+    // The number of bytes processed in one timed repetition (only for the output benchmarks, 0 otherwise)
+    largecounter Bytes{};
+    // Best and median wall time (in seconds) of the repetitions
+    double BestTime{};
+    double MedianTime{};
+    // A checksum of the computed values, so that the work cannot be optimized away;
+    // a changing checksum also signals that the benchmarked code now computes something different
+    real Checksum{};
+};
+
+// Namespace containing all benchmarks
+namespace Benchmarks
+{
+    // Names of all benchmarks that would be run with these settings (in the order in which they are run)
+    std::vector<std::string> ListBenchmarks(const BenchmarkSettings& settings);
+
+    // Runs the regression checks (geodesics that must end in a known way, e.g. through the polar axis);
+    // returns whether all of them pass (a warning is given for every check that fails)
+    bool RunRegressionChecks();
+
+    // Runs all benchmarks (that pass the filter of the settings) and returns their results
+    std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkSettings& settings);
+
+    // Writes the results of a run as JSON (one object, with the run information and an array of benchmark results)
+    void WriteJSON(std::ostream& out, const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results);
+}
+
+#endif
@@ -1,6 +1,6 @@
 #include "Config.h" // We are implementing these Config namespace functions here
 
-#include "Utilities.h" // for Utilities::GetDiagNameStrings
+#include "Utilities.h" // for Utilities::GetDiagNameStrings, Utilities::GetDiagFullDataValCounts
 
 #include <algorithm> // for std::transform, std::max, std::min
 #include <cctype> // for std::to_lower
@@ -90,7 +90,7 @@ bool Config::lookupValuelargecounter(const ConfigSetting& theSetting, const char
 }
 
 
-// Initialize screen output options
+// Initialize screen output options (and the precision of the text output)
 void Config::InitializeScreenOutput(const ConfigObject& theCfg)
 {
 	// DEFAULT: highest level output allowed
@@ -113,6 +113,14 @@ void Config::InitializeScreenOutput(const ConfigObject& theCfg)
 		largecounter loopmessagefrequency{ GetLoopMessageFrequency() };
 		lookupValuelargecounter(OutputSettings, "LoopMessageFrequency", loopmessagefrequency);
 		SetLoopMessageFrequency(loopmessagefrequency);
+
+		// Precision of real numbers in all text output (number of decimals, or shortest exact representation)
+		int realprecision{ GetRealPrecision() };
+		OutputSettings.lookupValue("Precision", realprecision);
+		if (realprecision < RealPrecision_Shortest || realprecision > RealPrecision_Max)
+			ScreenOutput("Output precision must be between " + std::to_string(RealPrecision_Shortest) + " and "
+				+ std::to_string(RealPrecision_Max) + ". Using the closest allowed value.", Output_Other_Default);
+		SetRealPrecision(realprecision);
 	}
 }
 
@@ -459,9 +467,12 @@ void Config::InitializeDiagnostics(const ConfigObject& theCfg, DiagBitflag& alld
 			largecounter outputsteps = 0; // keep all steps
 			lookupValuelargecounter(AllDiagSettings["GeodesicPosition"], "OutputSteps", outputsteps);
 
+			bool boundedmemory{ false }; // store all steps until the geodesic is done
+			AllDiagSettings["GeodesicPosition"].lookupValue("BoundedMemory", boundedmemory);
+
 			GeodesicPositionDiagnostic::DiagOptions = 
 				std::unique_ptr<GeodesicPositionOptions>(new GeodesicPositionOptions{ outputsteps,
-											UpdateFrequency{updatensteps,updatestart,updatefinish} });
+											UpdateFrequency{updatensteps,updatestart,updatefinish}, boundedmemory });
 
 			bool isVal{ false };
 			if (valdiag == Diag_None && AllDiagSettings["GeodesicPosition"].lookupValue("UseForMesh", isVal) && isVal)
@@ -535,6 +546,21 @@ void Config::InitializeDiagnostics(const ConfigObject& theCfg, DiagBitflag& alld
 			}
 		}
 
+		// IntegrationCost
+		if (CheckIfDiagOn("IntegrationCost"))
+		{
+			alldiags |= Diag_IntegrationCost;
+
+			// There are no options to set for IntegrationCost
+
+			bool isVal{ false };
+			if (valdiag == Diag_None && AllDiagSettings["IntegrationCost"].lookupValue("UseForMesh", isVal) && isVal)
+			{
+				// Use this Diagnostic for the Mesh values
+				valdiag = Diag_IntegrationCost;
+			}
+		}
+
 		//// DIAGNOSTIC ADD POINT D.2 ////
 		// Add a check to see if your new Diagnostic is turned on here. If it is, check any further options it needs and
 		// make sure to set the diagnostic flags appropriately.
@@ -810,6 +836,7 @@ std::unique_ptr<ViewScreen> Config::GetViewScreen(const ConfigObject& theCfg, Di
 	OneIndex dir{ 0,-1,0,0 };
 	ScreenPoint screensize{ 10.0,10.0 };
 	ScreenPoint screencenter{ 0.0, 0.0 };
+	bool equatorialmirror{ false };
 
 	try
 	{
@@ -847,6 +874,8 @@ std::unique_ptr<ViewScreen> Config::GetViewScreen(const ConfigObject& theCfg, Di
 			ViewSettings["ScreenCenter"].lookupValue("x", screencenter[0]);
 			ViewSettings["ScreenCenter"].lookupValue("y", screencenter[1]);
 		}
+		// Use the equatorial mirror symmetry (ViewScreen checks whether this is possible)
+		ViewSettings.lookupValue("EquatorialSymmetry", equatorialmirror);
 	}
 	catch (SettingError& e)
 	{
@@ -859,7 +888,7 @@ std::unique_ptr<ViewScreen> Config::GetViewScreen(const ConfigObject& theCfg, Di
 
 	// Create the ViewScreen!
 	std::unique_ptr<ViewScreen> theViewScreen{ new ViewScreen(pos, dir, screensize, screencenter,
-		std::move(theMesh),theMetric) };
+		std::move(theMesh),theMetric, GeodesicType::Null, equatorialmirror) };
 
 	return theViewScreen;
 }
@@ -900,7 +929,18 @@ std::unique_ptr<Mesh> Config::GetMesh(const ConfigObject& theCfg, DiagBitflag va
 			largecounter totalpixels{ 100 * 100 };
 			lookupValuelargecounter(MeshSettings, "TotalPixels", totalpixels);
 
-			theMesh = std::unique_ptr<Mesh>(new SimpleSquareMesh(totalpixels, valdiag));
+			// Optionally, refine the grid of a previous run (only integrating the new pixels)
+			largecounter previouspixels{ 0 };
+			lookupValuelargecounter(MeshSettings, "PreviousPixels", previouspixels);
+			std::string previousoutput{};
+			MeshSettings.lookupValue("PreviousOutput", previousoutput);
+			if (previouspixels > 0 && previousoutput == "")
+			{
+				ScreenOutput("No previous output given for previous grid. Will integrate all pixels.", Output_Other_Default);
+				previouspixels = 0;
+			}
+
+			theMesh = std::unique_ptr<Mesh>(new SimpleSquareMesh(totalpixels, valdiag, previouspixels, previousoutput));
 		}
 		else if (meshname == "InputCertainPixelsMesh")
 		{
@@ -954,10 +994,12 @@ std::unique_ptr<Mesh> Config::GetMesh(const ConfigObject& theCfg, DiagBitflag va
 				maxsubdivide = 1;
 			}
 			MeshSettings.lookupValue("InitialSubdivisionToFinal", initialsubtofinal);
+			bool pipelinedweights{ false };
+			MeshSettings.lookupValue("PipelinedWeights", pipelinedweights);
 
 			theMesh = std::unique_ptr<Mesh>(new SquareSubdivisionMeshV2(maxpixels,
 				initialpixels, maxsubdivide,
-				iterationpixels, initialsubtofinal, valdiag));
+				iterationpixels, initialsubtofinal, valdiag, pipelinedweights));
 		}
 		// else if ... (test for other Meshs here)
 		else
@@ -1053,6 +1095,20 @@ GeodesicIntegratorFunc Config::GetGeodesicIntegrator(const ConfigObject& theCfg)
 			IntegratorSettings.lookupValue("VerletVelocityTolerance", verlettolerance);
 			Integrators::VerletVelocityTolerance = verlettolerance;
 		}
+		else if (IntegratorType == "rk45" || IntegratorType == "dormandprince")
+		{
+			// Set the integrator function
+			TheFunc = Integrators::IntegrateGeodesicStep_RK45;
+			Integrators::IntegratorDescription = "RK45";
+
+			// Get the tolerances on the local error of each step
+			real abstolerance{ Integrators::RK45AbsoluteTolerance };
+			IntegratorSettings.lookupValue("AbsoluteTolerance", abstolerance);
+			Integrators::RK45AbsoluteTolerance = abstolerance;
+			real reltolerance{ Integrators::RK45RelativeTolerance };
+			IntegratorSettings.lookupValue("RelativeTolerance", reltolerance);
+			Integrators::RK45RelativeTolerance = reltolerance;
+		}
 		// else if ... (other integrators here)
 		else // no match found: must be incorrect integrator type specified in configuration file
 		{
@@ -1072,6 +1128,110 @@ GeodesicIntegratorFunc Config::GetGeodesicIntegrator(const ConfigObject& theCfg)
 
 
 
+/// <summary>
+/// Config::GetBatchGeodesicIntegrator():  Returns a pointer to the batched integrator function to use
+/// (or nullptr if we are not integrating in batches) as specified in the configuration file.
+/// </summary>
+BatchGeodesicIntegratorFunc Config::GetBatchGeodesicIntegrator(const ConfigObject& theCfg)
+{
+	// SET DEFAULTS HERE: not integrating in batches
+	bool batched{ false };
+
+	// Get the root collection
+	ConfigSetting& root = theCfg.getRoot();
+
+	// Look up whether we want batches (no default message necessary)
+	if (root.exists("Integrator"))
+	{
+		root["Integrator"].lookupValue("Batched", batched);
+	}
+	if (!batched)
+		return nullptr;
+
+	// Only some integrators have a batched version
+	BatchGeodesicIntegratorFunc TheFunc{ nullptr };
+	if (Integrators::IntegratorDescription == "RK4")
+	{
+		TheFunc = Integrators::IntegrateGeodesicStep_RK4_Batch;
+	}
+	// else if ... (other batched integrators here)
+	else
+	{
+		ScreenOutput("No batched version of integrator " + Integrators::IntegratorDescription
+			+ " available. Not integrating in batches.", Output_Other_Default);
+	}
+
+	Integrators::IntegrateInBatches = (TheFunc != nullptr);
+	return TheFunc;
+}
+
+
+
+/// <summary>
+/// Config::GetScheduler():  Creates the GeodesicScheduler object (which distributes the geodesics
+/// of every integration loop over the threads) with options specified according to the configuration file.
+/// </summary>
+std::unique_ptr<Utilities::GeodesicScheduler> Config::GetScheduler(const ConfigObject& theCfg)
+{
+	// DEFAULTS: static schedule, no cost ordering
+	std::unique_ptr<Utilities::GeodesicScheduler> TheScheduler{ new Utilities::GeodesicScheduler() };
+
+	// Get the root collection
+	ConfigSetting& root = theCfg.getRoot();
+
+	try
+	{
+		// Check to see that there are Scheduler settings at all
+		if (!root.exists("Scheduler"))
+		{
+			throw SettingError("No scheduler settings found.");
+		}
+
+		// Go to the Scheduler settings
+		ConfigSetting& SchedulerSettings = root["Scheduler"];
+
+		// Look up the schedule type
+		std::string ScheduleName{ "static" };
+		SchedulerSettings.lookupValue("Type", ScheduleName);
+		// Convert string to lower case
+		std::transform(ScheduleName.begin(), ScheduleName.end(), ScheduleName.begin(),
+			[](unsigned char c) { return std::tolower(c); });
+
+		Utilities::ScheduleType TheType{ Utilities::ScheduleType::Static };
+		if (ScheduleName == "dynamic")
+			TheType = Utilities::ScheduleType::Dynamic;
+		else if (ScheduleName == "guided")
+			TheType = Utilities::ScheduleType::Guided;
+		else if (ScheduleName != "static")
+		{
+			throw SettingError("Unknown scheduler type: " + ScheduleName + ".");
+		}
+
+		// Chunk size (0 means the OpenMP default)
+		int ChunkSize{ 0 };
+		SchedulerSettings.lookupValue("ChunkSize", ChunkSize);
+
+		// Order geodesics by their estimated cost or not
+		bool CostOrdering{ false };
+		SchedulerSettings.lookupValue("CostOrdering", CostOrdering);
+		int CostMapResolution{ 32 };
+		SchedulerSettings.lookupValue("CostMapResolution", CostMapResolution);
+
+		// Create the Scheduler!
+		TheScheduler = std::unique_ptr<Utilities::GeodesicScheduler>(
+			new Utilities::GeodesicScheduler(TheType, ChunkSize, CostOrdering, CostMapResolution));
+	}
+	catch (SettingError& e)
+	{
+		ScreenOutput(e.what(), Output_Other_Default);
+		ScreenOutput("Using static schedule without cost ordering.", Output_Other_Default);
+	}
+
+	return TheScheduler;
+}
+
+
+
 /// <summary>
 /// Config::GetOutputHandler():  Creates the GeodesicOutputHandler object with options specified
 /// according to the configuration file, for handling of geodesic outputs.
@@ -1138,11 +1298,39 @@ std::unique_ptr<GeodesicOutputHandler> Config::GetOutputHandler(const ConfigObje
 		if (FirstLineInfoOn)
 			FirstLineInfoString = FirstLineInfo;
 
+		// Text or binary output files
+		std::string FormatName{ "text" };
+		OutputSettings.lookupValue("Format", FormatName);
+		// Convert string to lower case
+		std::transform(FormatName.begin(), FormatName.end(), FormatName.begin(),
+			[](unsigned char c) { return std::tolower(c); });
+		OutputFormat Format{ OutputFormat::Text };
+		if (FormatName == "binary")
+			Format = OutputFormat::Binary;
+		else if (FormatName != "text")
+			ScreenOutput("Unknown output format: " + FormatName + ". Using text output.", Output_Other_Default);
+
+		// Stream output to file with a background writer thread (instead of caching)
+		bool Streaming{ false };
+		OutputSettings.lookupValue("Streaming", Streaming);
+		largecounter StreamBufferSize{ 10000 };
+		lookupValuelargecounter(OutputSettings, "StreamBufferSize", StreamBufferSize);
+		if (!Streaming)
+			StreamBufferSize = 0;
+
+		// Write (binary) output directly into memory-mapped files (instead of caching or streaming it)
+		bool MemoryMapped{ false };
+		OutputSettings.lookupValue("MemoryMapped", MemoryMapped);
+		std::vector<int> MappedValueCounts{};
+		if (MemoryMapped)
+			MappedValueCounts = Utilities::GetDiagFullDataValCounts(alldiags, valdiag);
+
 		// Create the Output Handler!
 		TheHandler = std::unique_ptr<GeodesicOutputHandler>(new GeodesicOutputHandler(FilePrefix, TimeStampStr,
 															FileExtension,diagstrings, 
 															nrToCache,
-															GeodesicsPerFile,FirstLineInfoString) );
+															GeodesicsPerFile,FirstLineInfoString,
+															Format, StreamBufferSize, MappedValueCounts) );
 	}
 	catch (SettingError& e)
 	{
@@ -1156,6 +1344,53 @@ std::unique_ptr<GeodesicOutputHandler> Config::GetOutputHandler(const ConfigObje
 
 
 
+
+/// <summary>
+/// Config::GetCheckpointOptions():  Reads in whether the run writes checkpoints (and how often),
+/// and whether it resumes from an earlier checkpoint.
+/// </summary>
+Utilities::CheckpointOptions Config::GetCheckpointOptions(const ConfigObject& theCfg)
+{
+	// DEFAULTS: no checkpoints
+	Utilities::CheckpointOptions TheOptions{};
+
+	// Get the root collection
+	ConfigSetting& root = theCfg.getRoot();
+
+	try
+	{
+		// Check to see that there are Checkpoint settings at all
+		if (!root.exists("Checkpoint"))
+		{
+			throw SettingError("No checkpoint settings found.");
+		}
+
+		// Go to the Checkpoint settings
+		ConfigSetting& CheckpointSettings = root["Checkpoint"];
+
+		// Check to see that the checkpoint file name has been specified
+		if (!CheckpointSettings.lookupValue("File", TheOptions.FileName) || TheOptions.FileName == "")
+		{
+			throw SettingError("No checkpoint file name found.");
+		}
+
+		// Write a checkpoint every so many iterations (0: never)
+		CheckpointSettings.lookupValue("Interval", TheOptions.Interval);
+		if (TheOptions.Interval < 0)
+			TheOptions.Interval = 0;
+
+		// Resume from the checkpoint file or not
+		CheckpointSettings.lookupValue("Resume", TheOptions.Resume);
+	}
+	catch (SettingError& e)
+	{
+		TheOptions = Utilities::CheckpointOptions{};
+		ScreenOutput(std::string(e.what()) + " Will not write or resume from checkpoints.", Output_Other_Default);
+	}
+
+	return TheOptions;
+}
+
 #endif // CONFIGURATION_MODE
 
 
@@ -23,6 +23,7 @@
 #include "ViewScreen.h"
 #include "Geodesic.h"
 #include "Integrators.h"
+#include "Utilities.h"
 
 
 // The entire configuration namespace and its functions are only defined in CONFIGURATION MODE!
@@ -63,7 +64,7 @@ namespace Config
 	
 	
 
-	// Use configuration to initialize the screen output level
+	// Use configuration to initialize the screen output level (and the precision of real numbers in the text output)
 	void InitializeScreenOutput(const ConfigObject& theCfg);
 
 	// Use configuration to create the correct Metric with specified parameters
@@ -89,10 +90,20 @@ namespace Config
 	// Use configuration to return a pointer to the correct integration function to use
 	GeodesicIntegratorFunc GetGeodesicIntegrator(const ConfigObject& theCfg);
 
+	// Use configuration to return a pointer to the batched integration function to use,
+	// or nullptr if geodesics are not to be integrated in batches (must be called after GetGeodesicIntegrator())
+	BatchGeodesicIntegratorFunc GetBatchGeodesicIntegrator(const ConfigObject& theCfg);
+
+	// Use configuration to create the scheduler that distributes geodesics over threads
+	std::unique_ptr<Utilities::GeodesicScheduler> GetScheduler(const ConfigObject& theCfg);
+
 	// Use configuration to initialize the output handler
 	std::unique_ptr<GeodesicOutputHandler> GetOutputHandler(const ConfigObject& theCfg,
 		DiagBitflag alldiags, DiagBitflag valdiag, std::string FirstLineInfo );
 
+	// Use configuration to determine whether (and how often) to write checkpoints, and whether to resume from one
+	Utilities::CheckpointOptions GetCheckpointOptions(const ConfigObject& theCfg);
+
 } // end namespace Config
 
 
@@ -2,6 +2,7 @@
 
 #include "Geodesic.h" // We need member functions of the Geodesic class here
 #include "InputOutput.h" // for ScreenOutput()
+#include "Integrators.h" // for the integrator work counters (used by IntegrationCostDiagnostic)
 
 #include <algorithm> // needed for std::rotate()
 #include <cmath> // needed for cos, sin, acos
@@ -73,6 +74,18 @@ DiagnosticUniqueVector CreateDiagnosticVector(DiagBitflag diagflags, DiagBitflag
 			std::rotate(theDiagVector.begin(), theDiagVector.begin() + 1, theDiagVector.end());
 		}
 	}
+	// Is IntegrationCost turned on?
+	if (diagflags & Diag_IntegrationCost)
+	{
+		theDiagVector.emplace_back(new IntegrationCostDiagnostic{ theGeodesic });
+		// If this is the value Diagnostic, we want it to be the first Diagnostic.
+		// Since at the moment it is the last element of the array, we perform a simple rotate right
+		// on the current array to place the Diagnostic in the front.
+		if (valdiag & Diag_IntegrationCost)
+		{
+			std::rotate(theDiagVector.begin(), theDiagVector.begin() + 1, theDiagVector.end());
+		}
+	}
 
 	//// DIAGNOSTIC ADD POINT C ////
 	// Add an if statement that checks if your Diagnostic's DiagBitflag is turned on, if so add a new instance of it
@@ -104,39 +117,7 @@ DiagnosticUniqueVector CreateDiagnosticVector(DiagBitflag diagflags, DiagBitflag
 
 void Diagnostic::Reset()
 {
-	// Reset steps to 0 for starting a new geodesic
-	m_StepsSinceUpdated = 0;
-}
-
-// This helper function returns true if the Diagnostic should update its internal status. Should be called from within
-// UpdateData() with the appropriate DiagnosticOptions::theUpdateFrequency
-bool Diagnostic::DecideUpdate(const UpdateFrequency& myUpdateFrequency)
-{
-	bool decideupdate = false;
-	// First, check if we are to update every so many steps
-	if (myUpdateFrequency.UpdateNSteps > 0)
-	{
-		// increase step counter and check if it is time to update
-		++m_StepsSinceUpdated;
-		if (m_StepsSinceUpdated >= myUpdateFrequency.UpdateNSteps)
-		{
-			// Time to update and reset step counter
-			decideupdate = true;
-			m_StepsSinceUpdated = 0;
-		}
-	}
-	// If UpdateNsteps == 0, then we only update either at start and/or end of the integration, so check these
-	// cases
-	else if (myUpdateFrequency.UpdateStart && m_OwnerGeodesic->getCurrentLambda() == 0.0)
-	{
-		decideupdate = true;
-	}
-	else if (myUpdateFrequency.UpdateFinish && m_OwnerGeodesic->getTermCondition() != Term::Continue)
-	{
-		decideupdate = true;
-	}
-	
-	return decideupdate;
+	// Nothing to reset in the base class
 }
 
 // Base class definition just returns the short name (which itself is pure virtual in the base class!)
@@ -145,6 +126,41 @@ std::string Diagnostic::getFullDescriptionStr() const
 	return getNameStr();
 }
 
+// By default, the data of a Diagnostic is invariant under the equatorial reflection
+void Diagnostic::ReflectEquatorially()
+{
+}
+
+std::vector<real> Diagnostic::getFullDataVal() const
+{
+	// By default, the full output is just the final value
+	return getFinalDataVal();
+}
+
+// By default, the outputs are written to the buffers by appending the (newly created) outputs
+void Diagnostic::WriteFullDataStr(std::string& out) const
+{
+	out += getFullDataStr();
+}
+
+void Diagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	const std::vector<real> fullvals{ getFullDataVal() };
+	out.insert(out.end(), fullvals.begin(), fullvals.end());
+}
+
+void Diagnostic::WriteFinalDataVal(std::vector<real>& out) const
+{
+	const std::vector<real> finalvals{ getFinalDataVal() };
+	out.insert(out.end(), finalvals.begin(), finalvals.end());
+}
+
+// By default, the number of values in the full output is not known in advance
+int Diagnostic::getFullDataValCount() const
+{
+	return -1;
+}
+
 /// <summary>
 /// FourColorScreen functions
 /// </summary>
@@ -156,39 +172,39 @@ void FourColorScreenDiagnostic::Reset()
 	Diagnostic::Reset();
 }
 
-void FourColorScreenDiagnostic::UpdateData()
+void FourColorScreenDiagnostic::UpdateData(const Point& pos, [[maybe_unused]] largecounter step, Term termcond)
 {
 	// Note: FourColorScreen only wants to update at the end, and then only if
 	// the geodesic has exited the boundary sphere.
 	// Check to see that the geodesic has finished, and that in particular
 	// it has finished because it has "escaped" to the boundary sphere.
-	if (m_OwnerGeodesic->getTermCondition() == Term::BoundarySphere)
+	if (termcond == Term::BoundarySphere)
 	{
-		// Position of the terminated geodesic
-		Point pos{ m_OwnerGeodesic->getCurrentPos() };
+		// Phi coordinate of the terminated geodesic
+		real phi{ pos[3] };
 		// Rework phi coordinate to be between 0 and 2pi;
 		// check if phi coordinate is meaningful first, so that this while loop does not take forever
 		// (otherwise a "random" quadrant will be returned)
-		if (fabs(pos[3]) < 2 * pi * 1e5)
+		if (fabs(phi) < 2 * pi * 1e5)
 		{
-			while (pos[3] > 2 * pi)
-				pos[3] -= 2 * pi;
-			while (pos[3] < 0)
-				pos[3] += 2 * pi;
+			while (phi > 2 * pi)
+				phi -= 2 * pi;
+			while (phi < 0)
+				phi += 2 * pi;
 		}
 
 		// Check which quadrant the geodesic is in
 		int quadrant{ 0 };
 		if (pos[2] < pi / 2)
 		{
-			if (pos[3] < pi)
+			if (phi < pi)
 				quadrant = 1;
 			else
 				quadrant = 2;
 		}
 		else
 		{
-			if (pos[3] < pi)
+			if (phi < pi)
 				quadrant = 3;
 			else
 				quadrant = 4;
@@ -211,6 +227,28 @@ std::vector<real> FourColorScreenDiagnostic::getFinalDataVal() const
 	return std::vector<real> {static_cast<real>(m_quadrant)};
 }
 
+void FourColorScreenDiagnostic::WriteFullDataStr(std::string& out) const
+{
+	AppendInteger(out, m_quadrant);
+}
+
+void FourColorScreenDiagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	// The full output is the final value
+	WriteFinalDataVal(out);
+}
+
+void FourColorScreenDiagnostic::WriteFinalDataVal(std::vector<real>& out) const
+{
+	out.push_back(static_cast<real>(m_quadrant));
+}
+
+int FourColorScreenDiagnostic::getFullDataValCount() const
+{
+	// The full output is the single final value
+	return 1;
+}
+
 real FourColorScreenDiagnostic::FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const
 {
 	// Discrete metric for distance: returns 0 if the quadrants are the same, 1 if they are not
@@ -220,6 +258,14 @@ real FourColorScreenDiagnostic::FinalDataValDistance(const std::vector<real>& va
 		return 1;
 }
 
+void FourColorScreenDiagnostic::ReflectEquatorially()
+{
+	// The quadrants above the equator (1, 2) are mapped to the ones below (3, 4) and vice versa;
+	// 0 (the boundary sphere was not reached) stays 0
+	if (m_quadrant > 0)
+		m_quadrant = (m_quadrant + 1) % 4 + 1;
+}
+
 std::string FourColorScreenDiagnostic::getNameStr() const
 {
 	// Simple name without spaces
@@ -238,74 +284,138 @@ std::string FourColorScreenDiagnostic::getFullDescriptionStr() const
 
 void GeodesicPositionDiagnostic::Reset()
 {
-	// Empty out vector of points; also call base class Reset function
+	// Empty out vector of points (this keeps its memory around for the next geodesic); also call base class Reset function
 	m_AllSavedPoints.clear();
+	m_SaveStride = 1;
+	m_NrUpdates = 0;
+	// In bounded memory mode, the buffer never needs to hold more than 2*OutputNrSteps points
+	if (DiagOptions->BoundedMemory && DiagOptions->OutputNrSteps > 0)
+		m_AllSavedPoints.reserve(2 * DiagOptions->OutputNrSteps);
 	Diagnostic::Reset();
 }
 
-void GeodesicPositionDiagnostic::UpdateData()
+void GeodesicPositionDiagnostic::UpdateData(const Point& pos, largecounter step, Term termcond)
 {
+	const largecounter nrstepstokeep{ DiagOptions->OutputNrSteps };
+	// Note that nrstepstokeep == 0 if we keep all of the steps, so then we do not need to decimate
+	const bool bounded{ DiagOptions->BoundedMemory && nrstepstokeep > 0 };
+
 	// This checks to see if we want to update the data now (and increments the step counter if necessary)
-	if (DecideUpdate(DiagOptions->theUpdateFrequency))
+	if (DecideUpdate(DiagOptions->theUpdateFrequency, step, termcond))
 	{
-		// Put the current position in the saved position vector
-		m_AllSavedPoints.push_back(m_OwnerGeodesic->getCurrentPos());
+		if (!bounded)
+		{
+			// Put the current position in the saved position vector
+			m_AllSavedPoints.push_back(pos);
+		}
+		else
+		{
+			m_LastPoint = pos;
+			if (m_NrUpdates % m_SaveStride == 0)
+			{
+				m_AllSavedPoints.push_back(m_LastPoint);
+				// The buffer is full: keep every other point, and from now on save half as often
+				if (m_AllSavedPoints.size() == 2 * nrstepstokeep)
+				{
+					for (largecounter i = 0; i < nrstepstokeep; ++i)
+						m_AllSavedPoints[i] = m_AllSavedPoints[2 * i];
+					m_AllSavedPoints.resize(nrstepstokeep);
+					m_SaveStride *= 2;
+				}
+			}
+			++m_NrUpdates;
+		}
 	}
 
 
 	// We also want extra behaviour at the end, when the geodesic is done integrating:
 	// at this point, we want to resize the vector of saved points if needed.
-	if (m_OwnerGeodesic->getTermCondition() != Term::Continue) // we are done integrating
+	if (termcond != Term::Continue) // we are done integrating
 	{
-		largecounter nrstepstokeep{ DiagOptions->OutputNrSteps };
-
-		// check if we need to resize; note that nrstepstokeep == 0 if we keep all of the steps
-		if (nrstepstokeep > 0 && nrstepstokeep < m_AllSavedPoints.size())
+		if (bounded)
+		{
+			// The points are already decimated; we only need to make sure to keep the last step
+			// (this fits in the buffer, since the buffer is never full after an update)
+			if (m_NrUpdates > 0 && (m_NrUpdates - 1) % m_SaveStride != 0)
+				m_AllSavedPoints.push_back(m_LastPoint);
+		}
+		// check if we need to resize
+		else if (nrstepstokeep > 0 && nrstepstokeep < m_AllSavedPoints.size())
 		{
 			largecounter jettison = static_cast<largecounter>(m_AllSavedPoints.size()) / nrstepstokeep;
-			// we create a temporary vector that stores all the data we are keeping
-			std::vector<Point> tmp{};
+			// we move all the data we are keeping to the front of the vector (in place)
+			largecounter nrkept{ 0 };
 			for (largecounter i = 0; i < m_AllSavedPoints.size(); ++i)
 			{
 				if (i % jettison == 0)
-					tmp.push_back(m_AllSavedPoints[i]);
+					m_AllSavedPoints[nrkept++] = m_AllSavedPoints[i];
 			}
 			// Make sure to keep last step
 			if ((m_AllSavedPoints.size() - 1) % jettison != 0) // if we have not already saved the last step
 			{
-				// delete the last saved step and replace it by the actual last entry of the data
-				tmp.pop_back();
-				tmp.push_back(m_AllSavedPoints[m_AllSavedPoints.size() - 1]);
+				// replace the last saved step by the actual last entry of the data
+				m_AllSavedPoints[nrkept - 1] = m_AllSavedPoints.back();
 			}
 
-			m_AllSavedPoints = tmp;
+			m_AllSavedPoints.resize(nrkept);
 		}
 	}
 }
 
 std::string GeodesicPositionDiagnostic::getFullDataStr() const
+{
+	std::string outputstr{};
+	WriteFullDataStr(outputstr);
+	return outputstr;
+}
+
+std::vector<real> GeodesicPositionDiagnostic::getFullDataVal() const
+{
+	std::vector<real> outputvals{};
+	WriteFullDataVal(outputvals);
+	return outputvals;
+}
+
+std::vector<real> GeodesicPositionDiagnostic::getFinalDataVal() const
+{
+	std::vector<real> outputvals{};
+	WriteFinalDataVal(outputvals);
+	return outputvals;
+}
+
+void GeodesicPositionDiagnostic::WriteFullDataStr(std::string& out) const
 {
 	// The full output string looks like this:
 	// "(total nr steps) ;; (step 1) (step 2) (step 3) ..."
 	// where each step is a (space-separated) output of the geodesic coordinates at that step
-	std::string outputstr{ std::to_string(m_AllSavedPoints.size()) + " ;; "};
+	AppendInteger(out, m_AllSavedPoints.size());
+	out += " ;; ";
 
 	for (auto& output : m_AllSavedPoints)
 	{
 		// We are not using the toString() function since that contains extraneous brackets and commas that
 		// we don't want in our output
 		for (int i = 0; i < dimension; ++i)
-			outputstr += std::to_string(output[i]) + " ";
+		{
+			AppendReal(out, output[i]);
+			out += ' ';
+		}
 	}
+}
 
-	return outputstr;
+void GeodesicPositionDiagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	// All of the saved points, one after the other (the number of steps is then the size divided by dimension)
+	for (const auto& output : m_AllSavedPoints)
+		out.insert(out.end(), output.begin(), output.end());
 }
 
-std::vector<real> GeodesicPositionDiagnostic::getFinalDataVal() const
+void GeodesicPositionDiagnostic::WriteFinalDataVal(std::vector<real>& out) const
 {
-	// return the last (theta, phi) coordinates
-	Point lastpt{ m_AllSavedPoints.back() };
-	return std::vector<real>{lastpt[2],lastpt[3]};
+	// the last (theta, phi) coordinates
+	const Point& lastpt{ m_AllSavedPoints.back() };
+	out.push_back(lastpt[2]);
+	out.push_back(lastpt[3]);
 }
 
 real GeodesicPositionDiagnostic::FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const
@@ -321,6 +431,13 @@ real GeodesicPositionDiagnostic::FinalDataValDistance(const std::vector<real>& v
 	return acos( cos(val1[0]) * cos(val2[0]) + sin(val1[0]) * sin(val2[0]) * cos(val1[1] - val2[1]) );
 }
 
+void GeodesicPositionDiagnostic::ReflectEquatorially()
+{
+	// Every saved point is mirrored in the equatorial plane
+	for (auto& pt : m_AllSavedPoints)
+		pt[2] = pi - pt[2];
+}
+
 std::string GeodesicPositionDiagnostic::getNameStr() const
 {
 	// Simple name string without spaces
@@ -331,7 +448,8 @@ std::string GeodesicPositionDiagnostic::getFullDescriptionStr() const
 {
 	// Full description string; also contains information about how frequently it updates and how many steps it outputs at the end
 	return "Geodesic position (output " + std::to_string(DiagOptions->OutputNrSteps) + 
-		" steps, updates every " + std::to_string(DiagOptions->theUpdateFrequency.UpdateNSteps) + " steps)";
+		" steps, updates every " + std::to_string(DiagOptions->theUpdateFrequency.UpdateNSteps) + " steps"
+		+ (DiagOptions->BoundedMemory && DiagOptions->OutputNrSteps > 0 ? ", bounded memory)" : ")");
 }
 
 
@@ -348,13 +466,13 @@ void EquatorialPassesDiagnostic::Reset()
 }
 
 
-void EquatorialPassesDiagnostic::UpdateData()
+void EquatorialPassesDiagnostic::UpdateData(const Point& pos, largecounter step, Term termcond)
 {
 	// This checks to see if we want to update the data now (and increments the step counter if necessary)
-	if (DecideUpdate(DiagOptions->theUpdateFrequency))
+	if (DecideUpdate(DiagOptions->theUpdateFrequency, step, termcond))
 	{
 		// Get the current theta coordinate of the geodesic
-		real curTheta{ m_OwnerGeodesic->getCurrentPos()[2] };
+		real curTheta{ pos[2] };
 
 		// We only do anything (check for a pass and/or update the past theta) if the geodesic has
 		// passed over a threshold around the equatorial plane
@@ -373,7 +491,7 @@ void EquatorialPassesDiagnostic::UpdateData()
 
 	// If the geodesic is finished integrating and we finish inside the horizon, make the passes negative
 	// (to have a difference between inside and outside the horizon)
-	if (m_OwnerGeodesic->getTermCondition() == Term::Horizon)
+	if (termcond == Term::Horizon)
 	{
 		m_EquatPasses = -m_EquatPasses;
 	}
@@ -392,6 +510,28 @@ std::vector<real> EquatorialPassesDiagnostic::getFinalDataVal() const
 	return std::vector<real> {static_cast<real>(m_EquatPasses)};
 }
 
+void EquatorialPassesDiagnostic::WriteFullDataStr(std::string& out) const
+{
+	AppendInteger(out, m_EquatPasses);
+}
+
+void EquatorialPassesDiagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	// The full output is the final value
+	WriteFinalDataVal(out);
+}
+
+void EquatorialPassesDiagnostic::WriteFinalDataVal(std::vector<real>& out) const
+{
+	out.push_back(static_cast<real>(m_EquatPasses));
+}
+
+int EquatorialPassesDiagnostic::getFullDataValCount() const
+{
+	// The full output is the single final value
+	return 1;
+}
+
 real EquatorialPassesDiagnostic::FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const
 {
 	// Returns the simple distance between two geodesics. Note that
@@ -409,7 +549,7 @@ std::string EquatorialPassesDiagnostic::getNameStr() const
 std::string EquatorialPassesDiagnostic::getFullDescriptionStr() const
 {
 	// More descriptive string (with spaces)
-	return "Equatorial passes (threshold = " + std::to_string(DiagOptions->Threshold) + ")";
+	return "Equatorial passes (threshold = " + RealToString(DiagOptions->Threshold) + ")";
 }
 
 
@@ -424,13 +564,13 @@ void ClosestRadiusDiagnostic::Reset()
 	Diagnostic::Reset();
 }
 
-void ClosestRadiusDiagnostic::UpdateData()
+void ClosestRadiusDiagnostic::UpdateData(const Point& pos, largecounter step, Term termcond)
 {
 	// This checks to see if we want to update the data now (and increments the step counter if necessary)
-	if (DecideUpdate(DiagOptions->theUpdateFrequency))
+	if (DecideUpdate(DiagOptions->theUpdateFrequency, step, termcond))
 	{
 		// Get the current r coordinate of the geodesic
-		real curR{ DiagOptions->RLogScale ? exp(m_OwnerGeodesic->getCurrentPos()[1]) : m_OwnerGeodesic->getCurrentPos()[1] };
+		real curR{ DiagOptions->RLogScale ? exp(pos[1]) : pos[1] };
 
 		// Update the closest radius if it is currently < 0 (indicating the first step of the geodesic)
 		// or if we have reached a new closest radius
@@ -439,7 +579,7 @@ void ClosestRadiusDiagnostic::UpdateData()
 	}
 
 	// If the geodesic is finished integrating and we finish inside the horizon, the geodesic will reach r = 0!
-	if (m_OwnerGeodesic->getTermCondition() == Term::Horizon)
+	if (termcond == Term::Horizon)
 	{
 		m_ClosestRadius = 0.0;
 	}
@@ -448,7 +588,7 @@ void ClosestRadiusDiagnostic::UpdateData()
 std::string ClosestRadiusDiagnostic::getFullDataStr() const
 {
 	// Returns a string of closest radius
-	return std::to_string(m_ClosestRadius);
+	return RealToString(m_ClosestRadius);
 }
 
 std::vector<real> ClosestRadiusDiagnostic::getFinalDataVal() const
@@ -457,6 +597,28 @@ std::vector<real> ClosestRadiusDiagnostic::getFinalDataVal() const
 	return std::vector<real> { m_ClosestRadius };
 }
 
+void ClosestRadiusDiagnostic::WriteFullDataStr(std::string& out) const
+{
+	AppendReal(out, m_ClosestRadius);
+}
+
+void ClosestRadiusDiagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	// The full output is the final value
+	WriteFinalDataVal(out);
+}
+
+void ClosestRadiusDiagnostic::WriteFinalDataVal(std::vector<real>& out) const
+{
+	out.push_back(m_ClosestRadius);
+}
+
+int ClosestRadiusDiagnostic::getFullDataValCount() const
+{
+	// The full output is the single final value
+	return 1;
+}
+
 real ClosestRadiusDiagnostic::FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const
 {
 	// Returns the simple distance between two geodesics as the (radial) distance between their closest point
@@ -476,6 +638,137 @@ std::string ClosestRadiusDiagnostic::getFullDescriptionStr() const
 }
 
 
+/// <summary>
+/// IntegrationCostDiagnostic functions
+/// </summary>
+
+void IntegrationCostDiagnostic::Reset()
+{
+	// Reset the counts; also call base class Reset function
+	m_Steps = 0;
+	m_RHSEvaluations = 0;
+	m_VerletIterations = 0;
+	m_RejectedSteps = 0;
+	m_TermReason = 0;
+	m_Nanoseconds = 0;
+	Diagnostic::Reset();
+
+	// Start the clock and take a snapshot of the work counters of this thread (which is about to integrate our geodesic)
+	const Integrators::WorkCounters& counters{ Integrators::ThreadWorkCounters };
+	m_StartRHSEvaluations = counters.RHSEvaluations;
+	m_StartVerletIterations = counters.VerletIterations;
+	m_StartRejectedSteps = counters.RejectedSteps;
+	m_StartTime = std::chrono::steady_clock::now();
+}
+
+void IntegrationCostDiagnostic::UpdateData([[maybe_unused]] const Point& pos, largecounter step, Term termcond)
+{
+	// The first update is at the starting position (when the Geodesic is reset); every later update is after a step
+	if (step == 0)
+		return;
+	m_Steps = step;
+
+	// When the geodesic terminates, stop the clock and read off the work done since the start
+	if (termcond != Term::Continue)
+	{
+		m_Nanoseconds = static_cast<largecounter>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - m_StartTime).count());
+		m_TermReason = static_cast<int>(termcond);
+
+		if (Integrators::IntegrateInBatches)
+		{
+			// The batch integrator (RK4) evaluates the rhs four times per step (for all lanes at once)
+			// and does not count its work
+			m_RHSEvaluations = 4 * m_Steps;
+		}
+		else
+		{
+			const Integrators::WorkCounters& counters{ Integrators::ThreadWorkCounters };
+			m_RHSEvaluations = counters.RHSEvaluations - m_StartRHSEvaluations;
+			m_VerletIterations = counters.VerletIterations - m_StartVerletIterations;
+			m_RejectedSteps = counters.RejectedSteps - m_StartRejectedSteps;
+		}
+	}
+}
+
+std::string IntegrationCostDiagnostic::getFullDataStr() const
+{
+	std::string outputstr{};
+	WriteFullDataStr(outputstr);
+	return outputstr;
+}
+
+std::vector<real> IntegrationCostDiagnostic::getFullDataVal() const
+{
+	std::vector<real> outputvals{};
+	WriteFullDataVal(outputvals);
+	return outputvals;
+}
+
+void IntegrationCostDiagnostic::WriteFullDataStr(std::string& out) const
+{
+	// The full output string looks like this:
+	// "(steps) (rhs evaluations) (Verlet iterations) (rejected steps) (termination reason) (time in ns)"
+	AppendInteger(out, m_Steps);
+	out += ' ';
+	AppendInteger(out, m_RHSEvaluations);
+	out += ' ';
+	AppendInteger(out, m_VerletIterations);
+	out += ' ';
+	AppendInteger(out, m_RejectedSteps);
+	out += ' ';
+	AppendInteger(out, m_TermReason);
+	out += ' ';
+	AppendInteger(out, m_Nanoseconds);
+}
+
+void IntegrationCostDiagnostic::WriteFullDataVal(std::vector<real>& out) const
+{
+	// The same six numbers as the full output string
+	out.push_back(static_cast<real>(m_Steps));
+	out.push_back(static_cast<real>(m_RHSEvaluations));
+	out.push_back(static_cast<real>(m_VerletIterations));
+	out.push_back(static_cast<real>(m_RejectedSteps));
+	out.push_back(static_cast<real>(m_TermReason));
+	out.push_back(static_cast<real>(m_Nanoseconds));
+}
+
+int IntegrationCostDiagnostic::getFullDataValCount() const
+{
+	// The full output always consists of the six numbers above
+	return 6;
+}
+
+std::vector<real> IntegrationCostDiagnostic::getFinalDataVal() const
+{
+	// Simple vector of size one containing the number of steps
+	return std::vector<real> { static_cast<real>(m_Steps) };
+}
+
+void IntegrationCostDiagnostic::WriteFinalDataVal(std::vector<real>& out) const
+{
+	out.push_back(static_cast<real>(m_Steps));
+}
+
+real IntegrationCostDiagnostic::FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const
+{
+	// Returns the difference in the number of steps taken
+	return fabs(val1[0] - val2[0]);
+}
+
+std::string IntegrationCostDiagnostic::getNameStr() const
+{
+	// Simple name string without spaces
+	return "IntegrationCost";
+}
+
+std::string IntegrationCostDiagnostic::getFullDescriptionStr() const
+{
+	// More descriptive string (with spaces)
+	return "Integration cost (steps, rhs evaluations, Verlet iterations, rejected steps, termination, time in ns)";
+}
+
+
 //// (New Diagnostic classes can define their member functions here)
 
 
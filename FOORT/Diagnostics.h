@@ -8,7 +8,9 @@
 ///////////////////////////////////////////////////////////////////////////////////////
 
 #include "Geometry.h" // for tensors
+#include "Terminations.h" // for Term (the termination condition of the owner Geodesic)
 
+#include <chrono> // for std::chrono::steady_clock
 #include <cstdint> // for std::uint16_t
 #include <string> // for strings
 #include <memory> // for std::unique_ptr
@@ -35,6 +37,7 @@ constexpr DiagBitflag Diag_GeodesicPosition		{ 0b0000'0000'0000'0001 };
 constexpr DiagBitflag Diag_FourColorScreen		{ 0b0000'0000'0000'0010 };
 constexpr DiagBitflag Diag_EquatorialPasses 	{ 0b0000'0000'0000'0100 };
 constexpr DiagBitflag Diag_ClosestRadius		{ 0b0000'0000'0000'1000 };
+constexpr DiagBitflag Diag_IntegrationCost		{ 0b0000'0000'0001'0000 };
 
 //// DIAGNOSTIC ADD POINT B ////
 // Add a DiagBitflag for your new diagnostic. Make sure you use a bitflag that has not been used before!
@@ -69,8 +72,8 @@ public:
 
 	// Resets Diagnostic object. This is called when the owner Geodesic is reset in order to start integrating
 	// a new geodesic.
-	// The base class implementation only resets m_StepsSinceUpdated
-	// Descendants can override this if they need to reset additional internal variables
+	// The base class implementation does nothing (the base class has no internal state)
+	// Descendants can override this if they need to reset internal variables
 	virtual void Reset();
 
 	// virtual destructor to ensure correct destruction of descendants
@@ -78,20 +81,44 @@ public:
 
 	// This is the heart of the Diagnostic. It calls the helper function DecideUpdate(), and if this
 	// returns true, will update its internal status based on the current (new) state of its owner geodesic.
-	virtual void UpdateData() = 0;
+	// This is called when the owner Geodesic is reset (step == 0) and after every step; the Geodesic passes its
+	// current position, the number of steps it has taken and its termination condition
+	virtual void UpdateData(const Point& pos, largecounter step, Term termcond) = 0;
 
 	// These functions are for use at the end of integration of a geodesic.
 	// getFullData() returns all the data stored in the Diagnostic as a string (for output to file)
 	virtual std::string getFullDataStr() const = 0;
+	// getFullDataVal() returns the same data as a vector of numbers (for binary output to file).
+	// The default implementation returns getFinalDataVal(), which is appropriate if the full output
+	// consists of the final value only
+	virtual std::vector<real> getFullDataVal() const;
 	// getFinalDataVal() associates a value to the geodesic corresponding to the final value of this diagnostic
 	// (used for determining coarseness of nearby geodesics)
 	virtual std::vector<real> getFinalDataVal() const = 0;
 
+	// The same three outputs, but appended to a buffer provided by the caller instead of returned in a new object
+	// (the Geodesic calls these with buffers that are reused for every geodesic, so that passing on the output of a
+	// geodesic does not need to allocate memory). The default implementations append the results of the three
+	// functions above; Diagnostics whose output is produced for every geodesic should override them
+	virtual void WriteFullDataStr(std::string& out) const;
+	virtual void WriteFullDataVal(std::vector<real>& out) const;
+	virtual void WriteFinalDataVal(std::vector<real>& out) const;
+	// The number of values returned by getFullDataVal() if this is the same for every geodesic, or -1 if it can vary.
+	// Only Diagnostics with a fixed number of values can be written to memory-mapped output files
+	// (see GeodesicOutputHandler). The default implementation returns -1
+	virtual int getFullDataValCount() const;
+
 	// Function used to determine distance between two values obtained from getFinalDataVal()
 	// (for determining coarseness of nearby geodesics)
 	// This should return a number >=0
 	virtual real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const = 0;
 
+	// Transforms the (final) data of the Diagnostic into the data it would have had for the mirror image of its
+	// owner Geodesic under the equatorial reflection theta -> pi - theta (used to fill in the mirror pixels of an
+	// equatorially symmetric configuration without integrating them, see ViewScreen).
+	// The default implementation does nothing, which is appropriate for Diagnostics that are invariant under the reflection
+	virtual void ReflectEquatorially();
+
 	// Getters for descriptions
 	// This returns the name (only) of the Diagnostic, as a string without spaces that will be appended
 	// to an output file (e.g. prefix_DiagName.ext). Must be implemented!
@@ -104,13 +131,18 @@ protected:
 	// The geodesic that owns the Diagnostic (a const pointer to the Geodesic)
 	Geodesic* const m_OwnerGeodesic;
 
-	// Helper function to decide if the Diagnostic should indeed update its status, based on
-	// its UpdateFrequency struct information (which will come from the Diagnostics's DiagnosticOptions)
-	bool DecideUpdate(const UpdateFrequency& myUpdateFrequency);
-
-	// The diagnostic is itself in charge of keeping track of how many steps it has been since it has been updated
-	// The Diagnostic's DiagnosticOptions struct tells it how many steps it needs to wait between updates
-	largecounter m_StepsSinceUpdated{};
+	// Helper function to decide if the Diagnostic should indeed update its status at the given step, based on
+	// its UpdateFrequency struct information (which will come from the Diagnostics's DiagnosticOptions):
+	// if UpdateNSteps > 0, it updates every UpdateNSteps calls of UpdateData() (counting the one at step 0),
+	// otherwise only at the start and/or the end of the integration
+	// (defined here so that it can be inlined in UpdateData())
+	static bool DecideUpdate(const UpdateFrequency& myUpdateFrequency, largecounter step, Term termcond)
+	{
+		if (myUpdateFrequency.UpdateNSteps > 0)
+			return (step + 1) % myUpdateFrequency.UpdateNSteps == 0;
+		return (myUpdateFrequency.UpdateStart && step == 0)
+			|| (myUpdateFrequency.UpdateFinish && termcond != Term::Continue);
+	}
 };
 
 // Owner vector of derived Diagnostics classes
@@ -138,15 +170,23 @@ public:
 	void Reset() final;
 
 	// Sets the quadrant to the appropriate value, IF the boundary sphere has been reached
-	void UpdateData() override;
+	void UpdateData(const Point& pos, largecounter step, Term termcond) override;
 
 	// Both of these output functions simply returns the quadrant number associated with the geodesic's end position
 	std::string getFullDataStr() const final;
 	std::vector<real> getFinalDataVal() const final;
+	void WriteFullDataStr(std::string& out) const final;
+	void WriteFullDataVal(std::vector<real>& out) const final;
+	void WriteFinalDataVal(std::vector<real>& out) const final;
+	// (the full output is always the quadrant only)
+	int getFullDataValCount() const final;
 
 	// Discrete metric for distance: returns 0 if the quadrants are the same, 1 if they are not
 	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
 
+	// The reflection swaps the upper and lower quadrants
+	void ReflectEquatorially() final;
+
 	// Description string getters
 	std::string getNameStr() const final;
 	std::string getFullDescriptionStr() const final;
@@ -173,17 +213,27 @@ public:
 	void Reset() final;
 
 	// Stores the current position of the geodesic
-	void UpdateData() final;
+	// (in bounded memory mode, see GeodesicPositionOptions, the saved points are decimated as we go along)
+	void UpdateData(const Point& pos, largecounter step, Term termcond) final;
 
 	// This returns as many stored positions as is specified in the options struct
 	std::string getFullDataStr() const final;
+	// Full data as numbers: all saved points, one after the other
+	std::vector<real> getFullDataVal() const final;
 	// This returns the final (theta,phi) value of the geodesic
 	std::vector<real> getFinalDataVal() const final;
+	// (The same, appended to buffers)
+	void WriteFullDataStr(std::string& out) const final;
+	void WriteFullDataVal(std::vector<real>& out) const final;
+	void WriteFinalDataVal(std::vector<real>& out) const final;
 
 	// This determines the angular distance between two geodesic
 	// (based on their final angles on the boundary sphere (theta, phi))
 	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
 
+	// The reflection maps theta to pi - theta for all saved points
+	void ReflectEquatorially() final;
+
 	// Description string getters
 	std::string getNameStr() const final;
 	std::string getFullDescriptionStr() const final;
@@ -194,6 +244,14 @@ public:
 private:
 	// Keeps track of the points that are saved
 	std::vector<Point> m_AllSavedPoints{};
+
+	// Only used in bounded memory mode: we save every m_SaveStride-th update, and m_SaveStride doubles every time
+	// the buffer of saved points is full (and then every other saved point is discarded).
+	// m_NrUpdates is the number of updates so far, and m_LastPoint is the point of the latest update
+	// (which is always kept at the end)
+	largecounter m_SaveStride{ 1 };
+	largecounter m_NrUpdates{ 0 };
+	Point m_LastPoint{};
 };
 
 
@@ -210,11 +268,15 @@ public:
 	void Reset() final;
 
 	// Checks to see if we have a new cross over the equatorial plane
-	void UpdateData() final;
+	void UpdateData(const Point& pos, largecounter step, Term termcond) final;
 
 	// Returns the number of passes over the equatorial plane
 	std::string getFullDataStr() const final;
 	std::vector<real> getFinalDataVal() const final;
+	void WriteFullDataStr(std::string& out) const final;
+	void WriteFullDataVal(std::vector<real>& out) const final;
+	void WriteFinalDataVal(std::vector<real>& out) const final;
+	int getFullDataValCount() const final;
 
 	// Simple absolute value of difference of passes
 	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
@@ -242,10 +304,14 @@ public:
 
 	void Reset() final;
 
-	void UpdateData() final;
+	void UpdateData(const Point& pos, largecounter step, Term termcond) final;
 
 	std::string getFullDataStr() const final;
 	std::vector<real> getFinalDataVal() const final;
+	void WriteFullDataStr(std::string& out) const final;
+	void WriteFullDataVal(std::vector<real>& out) const final;
+	void WriteFinalDataVal(std::vector<real>& out) const final;
+	int getFullDataValCount() const final;
 
 	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
 
@@ -258,8 +324,66 @@ private:
 	real m_ClosestRadius{ -1 };
 };
 
+// Measures the cost of integrating the geodesic: the number of steps taken, the number of evaluations of the rhs of the
+// geodesic equation, the number of Verlet corrector iterations and RK45 rejected steps, the termination reason (the
+// value of Term) and the wall-clock time (in ns) from the start of the integration until termination.
+// Turning this Diagnostic on also turns on the counting in the integrators (see Integrators::CountWork);
+// its output file is then a "cost heatmap" of the screen.
+// Notes:
+// - The time does not include the calculation of the initial conditions, nor the output of the geodesic;
+// - In batch mode (see GeodesicBatch), the lanes of a batch are integrated together, so the time is that of the batch
+//   while the geodesic was in it, and the rhs evaluations are those of the (RK4) batch integrator, i.e. four per step;
+//   the Verlet and RK45 counters are zero;
+// - Mirror pixels of an equatorially symmetric configuration (which are not integrated) get the cost of their image.
+class IntegrationCostDiagnostic final : public Diagnostic
+{
+public:
+	// Basic constructor only passes on Geodesic pointer to base class constructor
+	IntegrationCostDiagnostic(Geodesic* const theGeodesic) : Diagnostic(theGeodesic) {}
+
+	// Reset starts the clock and takes a snapshot of the integrator work counters of this thread
+	void Reset() final;
+
+	// Counts the steps, and stops the clock and the counters when the geodesic terminates
+	void UpdateData(const Point& pos, largecounter step, Term termcond) final;
+
+	// The full output is: steps, rhs evaluations, Verlet iterations, RK45 rejected steps, termination reason, time (ns)
+	std::string getFullDataStr() const final;
+	std::vector<real> getFullDataVal() const final;
+	void WriteFullDataStr(std::string& out) const final;
+	void WriteFullDataVal(std::vector<real>& out) const final;
+	int getFullDataValCount() const final;
+	// The final value is the number of steps (which, unlike the time, is the same for every run)
+	std::vector<real> getFinalDataVal() const final;
+	void WriteFinalDataVal(std::vector<real>& out) const final;
+
+	// Distance is the difference in the number of steps
+	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
+
+	// Description string getters
+	std::string getNameStr() const final;
+	std::string getFullDescriptionStr() const final;
+
+	// IntegrationCost does not need any (static) options!
+
+private:
+	largecounter m_Steps{ 0 };
+	largecounter m_RHSEvaluations{ 0 };
+	largecounter m_VerletIterations{ 0 };
+	largecounter m_RejectedSteps{ 0 };
+	int m_TermReason{ 0 };
+	largecounter m_Nanoseconds{ 0 };
+
+	// The clock and the integrator work counters of this thread at the start of the integration
+	std::chrono::steady_clock::time_point m_StartTime{};
+	largecounter m_StartRHSEvaluations{ 0 };
+	largecounter m_StartVerletIterations{ 0 };
+	largecounter m_StartRejectedSteps{ 0 };
+};
+
 //// DIAGNOSTIC ADD POINT A1 ////
 // Declare your Diagnostic class here, inheriting from Diagnostic.
+// (Optional) also add it to DiagnosticDispatchList in Geodesic.h, so that the Geodesic calls it without virtual dispatch.
 // Sample code:
 /*
 // Forward declaration needed before Diagnostic (if using base class DiagnosticOptions, this is strictly speaking not necessary)
@@ -278,8 +402,9 @@ public:
 	void Reset() final;
 
 	// This is the heart of the Diagnostic: here the Diagnostic updates its internal state according to
-	// the owner Geodesic's current state
-	void UpdateData() final;
+	// the owner Geodesic's current state (its position, number of steps taken and termination condition)
+	// (use DecideUpdate(DiagOptions->theUpdateFrequency, step, termcond) to only update with the desired frequency)
+	void UpdateData(const Point& pos, largecounter step, Term termcond) final;
 
 	// This should return the string that is to be outputted to the file as the final output of this Diagnostic
 	// for its owner Geodesic
@@ -287,11 +412,27 @@ public:
 	// This should return a vector of real numbers that indicates the final "value" that should be associated to
 	// the owner Geodesic --- this is then used in FinalDataValDistance() to find "distances" between geodesics.
 	std::vector<real> getFinalDataVal() const final;
+	// (Optional) if the output string contains more than the final "value", override this to return the full output
+	// as a vector of real numbers (used for binary output files)
+	// std::vector<real> getFullDataVal() const final;
+	// (Optional) override these to append the same outputs to a buffer without allocating memory
+	// (by default, they append the results of the functions above)
+	// void WriteFullDataStr(std::string& out) const final;
+	// void WriteFullDataVal(std::vector<real>& out) const final;
+	// void WriteFinalDataVal(std::vector<real>& out) const final;
+	// (Optional) if the full output always has the same number of values, return this number here
+	// (this allows memory-mapped binary output; by default, the number of values is assumed to vary)
+	// int getFullDataValCount() const final;
 
 	// This should return a (positive) distance of two values returned by getFinalDataVal(), indicated the
 	// "distance" of two geodesics (this is used for Mesh refinement)
 	real FinalDataValDistance(const std::vector<real>& val1, const std::vector<real>& val2) const final;
 
+	// (Optional) if the data of the Diagnostic changes under the equatorial reflection theta -> pi - theta,
+	// override this to transform it accordingly (otherwise, mirrored pixels will get wrong values when the ViewScreen
+	// uses equatorial symmetry)
+	// void ReflectEquatorially() final;
+
 	// Must implement getNameStr() (and recommended also to implement getFullDescriptionStr)
 	// getNameStr() is a simple, short string (without spaces) that will be appended to the file name
 	// where this Diagnostic's output is written. getFullDescriptionStr() is a descriptive string that should list
@@ -331,11 +472,17 @@ public:
 struct GeodesicPositionOptions : public DiagnosticOptions
 {
 public:
-	GeodesicPositionOptions(largecounter outputsteps, UpdateFrequency thefrequency) : OutputNrSteps{ outputsteps }, 
-		DiagnosticOptions(thefrequency)
+	GeodesicPositionOptions(largecounter outputsteps, UpdateFrequency thefrequency, bool boundedmemory = false)
+		: DiagnosticOptions(thefrequency), OutputNrSteps{ outputsteps }, BoundedMemory{ boundedmemory }
 	{}
 
+	// The (approximate) number of points to output; 0 means all points are output
 	const largecounter OutputNrSteps;
+	// In bounded memory mode, at most 2*OutputNrSteps points are stored at any time: every time this buffer is full,
+	// every other point is discarded and from then on only every other update is saved (stride doubling).
+	// In the end, between OutputNrSteps and 2*OutputNrSteps (evenly spaced) points are output, just as without this mode;
+	// only the exact points chosen may differ. (Has no effect if OutputNrSteps is 0.)
+	const bool BoundedMemory;
 };
 
 struct EquatorialPassesOptions : public DiagnosticOptions
@@ -1,6 +1,6 @@
 #include"Geodesic.h" // We are implementing Source & Geodesic member functions declared here
 
-#include "InputOutput.h" // for ScreenOutput()
+#include "InputOutput.h" // for ScreenOutput() and GeodesicOutputRecord
 
 /// <summary>
 /// Source (and descendant classes) functions
@@ -37,8 +37,9 @@ void Geodesic::Reset(ScreenIndex scrindex, Point initpos, OneIndex initvel)
 	m_CurrentPos = initpos;
 	m_CurrentVel = initvel;
 
-	// Start at 0.0 affine parameter
+	// Start at 0.0 affine parameter (and no steps taken)
 	m_curLambda = 0.0;
+	m_NrSteps = 0;
 
 	// Geodesic is set up to be integrated
 	m_TermCond = Term::Continue;
@@ -47,7 +48,7 @@ void Geodesic::Reset(ScreenIndex scrindex, Point initpos, OneIndex initvel)
 	for (const auto& d : m_AllDiagnostics)
 	{
 		d->Reset();
-		d->UpdateData();
+		d->UpdateData(m_CurrentPos, m_NrSteps, m_TermCond);
 	}
 
 	// Also reset all terminations
@@ -66,23 +67,46 @@ Term Geodesic::Update()
 	real step{};
 	// The integrator function will set the new position, new velocity, and the (affine parameter) step taken
 	m_theIntegrator(m_CurrentPos, m_CurrentVel, newpos, newvel, step, m_theMetric, m_theSource);
+
+	return UpdateWithStep(newpos, newvel, step);
+}
+
+Term Geodesic::UpdateWithStep(const Point& newpos, const OneIndex& newvel, real step)
+{
 	m_curLambda += step;
+	++m_NrSteps;
 	m_CurrentPos = newpos;
 	m_CurrentVel = newvel;
 
-	// Check all possible termination conditions
-	for (const auto& t : m_AllTerminations)
+	// If the step took us through the polar axis (which is possible because the metric derivatives are regularized
+	// there, see SphericalHorizonMetric::PolarAxisThreshold), map the geodesic back to 0 <= theta <= pi:
+	// the point (theta, phi) with theta < 0 is (-theta, phi + pi), and theta > pi is (2pi - theta, phi + pi);
+	// the velocity in the theta direction flips sign
+	if (m_CurrentPos[2] < 0.0 || m_CurrentPos[2] > pi)
 	{
-		m_TermCond = t->CheckTermination();
-		if (m_TermCond != Term::Continue)
-			break;
+		m_CurrentPos[2] = m_CurrentPos[2] < 0.0 ? -m_CurrentPos[2] : 2. * pi - m_CurrentPos[2];
+		m_CurrentPos[3] += pi;
+		m_CurrentVel[2] = -m_CurrentVel[2];
 	}
 
+	// The Terminations and Diagnostics all get the (new) position and step count from here,
+	// so that they do not need to ask the Geodesic for them separately
+	const Point& pos{ m_CurrentPos };
+	const largecounter nrsteps{ m_NrSteps };
+
+	// Check all possible termination conditions (until one of them wants to terminate)
+	m_TerminationDispatch.ForEachUntil([this, &pos, nrsteps](auto& t)
+		{
+			m_TermCond = t.CheckTermination(pos, nrsteps);
+			return m_TermCond != Term::Continue;
+		});
+
 	// No matter if we terminate now or not, loop through all Diagnostics to update them
-	for (const auto& d : m_AllDiagnostics)
-	{
-		d->UpdateData();
-	}
+	const Term termcond{ m_TermCond };
+	m_DiagnosticDispatch.ForEach([&pos, nrsteps, termcond](auto& d)
+		{
+			d.UpdateData(pos, nrsteps, termcond);
+		});
 
 	return m_TermCond;
 }
@@ -108,42 +132,156 @@ real Geodesic::getCurrentLambda() const
 }
 
 
-std::vector<std::string> Geodesic::getAllOutputStr() const
+ScreenIndex Geodesic::getScreenIndex() const
+{
+	return m_ScreenIndex;
+}
+
+void Geodesic::WriteAllOutput(GeodesicOutputRecord& theRecord, bool numerical) const
+{
+	// The Geodesic should have terminated if this is called!
+	if (m_TermCond == Term::Continue)
+		ScreenOutput("Geodesic not terminated yet but WriteAllOutput() is called!", OutputLevel::Level_0_WARNING);
+
+	theRecord.Clear();
+	theRecord.Index = m_ScreenIndex;
+	for (const auto& d : m_AllDiagnostics)
+	{
+		if (numerical)
+		{
+			// The number of values, followed by the values
+			const std::size_t countpos{ theRecord.Values.size() };
+			theRecord.Values.push_back(0);
+			d->WriteFullDataVal(theRecord.Values);
+			theRecord.Values[countpos] = static_cast<real>(theRecord.Values.size() - countpos - 1);
+		}
+		else
+		{
+			d->WriteFullDataStr(theRecord.Text);
+			theRecord.TextEnds.push_back(theRecord.Text.size());
+		}
+	}
+}
+
+void Geodesic::WriteDiagnosticFinalValue(std::vector<real>& values) const
+{
+	// The Geodesic should have terminated if this is called!
+	if (m_TermCond == Term::Continue)
+		ScreenOutput("Geodesic not terminated yet but WriteDiagnosticFinalValue() is called!", OutputLevel::Level_0_WARNING);
+
+	// The diagnostic that contributes the value is always at the first position in the Diagnostic array!
+	values.clear();
+	m_AllDiagnostics[0]->WriteFinalDataVal(values);
+}
+
+void Geodesic::ReflectEquatorially(ScreenIndex mirrorscrindex)
 {
 	// The Geodesic should have terminated if this is called!
 	if (m_TermCond == Term::Continue)
-		ScreenOutput("Geodesic not terminated yet but getAllOutputStr() is called!", OutputLevel::Level_0_WARNING);
+		ScreenOutput("Geodesic not terminated yet but ReflectEquatorially() is called!", OutputLevel::Level_0_WARNING);
+
+	m_ScreenIndex = mirrorscrindex;
+	m_CurrentPos[2] = pi - m_CurrentPos[2];
+	m_CurrentVel[2] = -m_CurrentVel[2];
+
+	for (const auto& d : m_AllDiagnostics)
+		d->ReflectEquatorially();
+}
 
 
-	// This gets the complete output that should be written to the output file
-	// Every Diagnostic returns a string, PLUS the FIRST string is the screen index
-	std::vector<std::string> theOutput{};
-	theOutput.reserve(m_AllDiagnostics.size() + 1);
+/// <summary>
+/// GeodesicBatch functions
+/// </summary>
 
-	// First string is the screen index of the Geodesic
-	std::string strScreenIndex{ "" };
-	for (int i = 0; i < m_ScreenIndex.size(); ++i)
+GeodesicBatch::GeodesicBatch(const Metric* const theMetric, const Source* const theSource,
+	DiagBitflag diagbit, DiagBitflag valdiagbit,
+	TermBitflag termbit, BatchGeodesicIntegratorFunc theIntegrator)
+	: m_theMetric{ theMetric }, m_theSource{ theSource }, m_theIntegrator{ theIntegrator }
+{
+	// Create one Geodesic per lane; these never integrate themselves (the batch does this for them),
+	// so they do not need an integrator function
+	m_Geodesics.reserve(BatchSize);
+	for (int lane = 0; lane < BatchSize; ++lane)
 	{
-		// We don't use the toString() function to avoid extraneous parentheses and commas therein
-		strScreenIndex += std::to_string(m_ScreenIndex[i]) + " ";
+		m_Geodesics.emplace_back(new Geodesic(theMetric, theSource, diagbit, valdiagbit, termbit, nullptr));
 	}
-	theOutput.push_back(std::move(strScreenIndex));
+	m_LaneIndices.fill(LARGECOUNTER_MAX);
+}
 
-	// The rest of the strings are the output strings as given by each of the Diagnostics
-	for (const auto& d : m_AllDiagnostics)
+void GeodesicBatch::ResetLane(int lane, largecounter index, ScreenIndex scrindex, Point initpos, OneIndex initvel)
+{
+	m_LaneIndices[lane] = index;
+	m_Geodesics[lane]->Reset(scrindex, initpos, initvel);
+}
+
+void GeodesicBatch::ClearLane(int lane)
+{
+	m_LaneIndices[lane] = LARGECOUNTER_MAX;
+}
+
+int GeodesicBatch::Update()
+{
+	// Find all lanes that are still integrating
+	std::array<int, BatchSize> activelanes{};
+	int nractive{ 0 };
+	for (int lane = 0; lane < BatchSize; ++lane)
+	{
+		if (IsLaneIntegrating(lane))
+			activelanes[nractive++] = lane;
+	}
+	if (nractive == 0)
+		return 0;
+
+	// Gather the current positions and velocities into the batch.
+	// Lanes that are not integrating are masked out: they are filled with a copy of an active lane
+	// (so that the integrator never works on invalid data), and their result is ignored
+	BatchPoint curpos;
+	BatchOneIndex curvel;
+	for (int lane = 0; lane < BatchSize; ++lane)
 	{
-		theOutput.push_back(std::move(d->getFullDataStr()));
+		const Geodesic& theGeod{ IsLaneIntegrating(lane) ? *m_Geodesics[lane] : *m_Geodesics[activelanes[0]] };
+		Point pos{ theGeod.getCurrentPos() };
+		OneIndex vel{ theGeod.getCurrentVel() };
+		for (int mu = 0; mu < dimension; ++mu)
+		{
+			curpos[mu][lane] = pos[mu];
+			curvel[mu][lane] = vel[mu];
+		}
 	}
 
-	return theOutput;
+	// Integrate the whole batch one step
+	BatchPoint nextpos;
+	BatchOneIndex nextvel;
+	BatchReal steps;
+	m_theIntegrator(curpos, curvel, nextpos, nextvel, steps, m_theMetric, m_theSource);
+
+	// Scatter the results back to the active Geodesics, which then update their Terminations and Diagnostics
+	for (int a = 0; a < nractive; ++a)
+	{
+		int lane = activelanes[a];
+		m_Geodesics[lane]->UpdateWithStep(Point{ nextpos[0][lane], nextpos[1][lane], nextpos[2][lane], nextpos[3][lane] },
+			OneIndex{ nextvel[0][lane], nextvel[1][lane], nextvel[2][lane], nextvel[3][lane] }, steps[lane]);
+	}
+
+	return nractive;
 }
 
-std::vector<real> Geodesic::getDiagnosticFinalValue() const
+bool GeodesicBatch::IsLaneIntegrating(int lane) const
 {
-	// The Geodesic should have terminated if this is called!
-	if (m_TermCond == Term::Continue)
-		ScreenOutput("Geodesic not terminated yet but getDiagnosticFinalValue() is called!", OutputLevel::Level_0_WARNING);
+	return m_LaneIndices[lane] != LARGECOUNTER_MAX && m_Geodesics[lane]->getTermCondition() == Term::Continue;
+}
 
-	// The diagnostic that contributes the value is always at the first position in the Diagnostic array!
-	return m_AllDiagnostics[0]->getFinalDataVal();
-}
\ No newline at end of file
+largecounter GeodesicBatch::getLaneIndex(int lane) const
+{
+	return m_LaneIndices[lane];
+}
+
+const Geodesic& GeodesicBatch::getLaneGeodesic(int lane) const
+{
+	return *m_Geodesics[lane];
+}
+
+Geodesic& GeodesicBatch::getLaneGeodesic(int lane)
+{
+	return *m_Geodesics[lane];
+}
@@ -16,6 +16,14 @@
 
 #include <string> // for strings
 #include <vector> // for std::vector
+#include <array> // for std::array
+#include <memory> // for std::unique_ptr
+#include <tuple> // for std::tuple, std::apply (StaticDispatchList)
+#include <type_traits> // for std::is_final_v
+
+// Forward declaration needed of GeodesicOutputRecord
+// (GeodesicOutputRecord is declared in InputOutput.h, which the Geodesic only needs in Geodesic.cpp)
+struct GeodesicOutputRecord;
 
 ///////////////////////////////////////////////////////////
 //// DECLARATIONS OF SOURCE BASE CLASS AND DESCENDANTS ////
@@ -55,6 +63,96 @@ public:
 	std::string getFullDescriptionStr() const final;
 };
 
+/////////////////////////////////////////////////////////////////
+//// STATIC DISPATCH OF DIAGNOSTICS AND TERMINATIONS         ////
+
+// The Geodesic updates all its Diagnostics and checks all its Terminations after every single step, i.e. these are
+// called far more often than anything else (except for the Metric). A StaticDispatchList holds (non-owner) pointers to
+// the objects in an owner vector of Base objects (Diagnostics or Terminations), sorted by their concrete type:
+// for each of the Known types (which must be final classes), member functions called through the list are resolved
+// at compile time instead of through the vtable (so that they can be inlined).
+// Objects of any other type are kept as Base pointers, and are called virtually as usual.
+// The Known types are visited in the order in which they are listed, followed by all other objects (in their original order).
+template<typename Base, typename... Known>
+class StaticDispatchList
+{
+	static_assert((std::is_final_v<Known> && ...), "StaticDispatchList: statically dispatched classes must be final!");
+
+public:
+	// Sort the objects in the owner vector by their concrete type
+	StaticDispatchList(const std::vector<std::unique_ptr<Base>>& objects)
+	{
+		for (const auto& obj : objects)
+		{
+			if (!(AddIfType<Known>(obj.get()) || ...))
+				std::get<std::vector<Base*>>(m_Objects).push_back(obj.get());
+		}
+	}
+
+	// Calls f(obj) for every object, where obj is a reference to the object's concrete type if it is one of the Known types
+	template<typename F>
+	void ForEach(F&& f) const
+	{
+		std::apply([&f](const auto&... lists)
+			{
+				(ForEachIn(lists, f), ...);
+			}, m_Objects);
+	}
+
+	// Calls f(obj) for every object (as in ForEach()) until f returns true; returns true if this happened
+	template<typename F>
+	bool ForEachUntil(F&& f) const
+	{
+		return std::apply([&f](const auto&... lists)
+			{
+				return (ForEachUntilIn(lists, f) || ...);
+			}, m_Objects);
+	}
+
+private:
+	// One vector of pointers per Known type, and one for all other objects
+	std::tuple<std::vector<Known*>..., std::vector<Base*>> m_Objects{};
+
+	// Adds the object to the vector of type T if it is of this type
+	template<typename T>
+	bool AddIfType(Base* obj)
+	{
+		T* objT{ dynamic_cast<T*>(obj) };
+		if (objT)
+			std::get<std::vector<T*>>(m_Objects).push_back(objT);
+		return objT != nullptr;
+	}
+
+	template<typename T, typename F>
+	static void ForEachIn(const std::vector<T*>& list, F& f)
+	{
+		for (T* obj : list)
+			f(*obj);
+	}
+
+	template<typename T, typename F>
+	static bool ForEachUntilIn(const std::vector<T*>& list, F& f)
+	{
+		for (T* obj : list)
+		{
+			if (f(*obj))
+				return true;
+		}
+		return false;
+	}
+};
+
+// The Diagnostics and Terminations that are dispatched statically by the Geodesic.
+// Note that the Terminations are listed in the same order as they are created by CreateTerminationVector(), so that
+// they are checked in the same order as they would be in the owner vector.
+// (Diagnostics and Terminations that are not listed here are called virtually; adding them here is optional)
+using DiagnosticDispatchList = StaticDispatchList<Diagnostic,
+	FourColorScreenDiagnostic, GeodesicPositionDiagnostic, EquatorialPassesDiagnostic, ClosestRadiusDiagnostic,
+	IntegrationCostDiagnostic>;
+using TerminationDispatchList = StaticDispatchList<Termination,
+	HorizonTermination, BoundarySphereTermination, TimeOutTermination, ThetaSingularityTermination>;
+
+
 ////////////////////////////////////////
 //// DECLARATIONS OF GEODESIC CLASS ////
 
@@ -83,7 +181,9 @@ public:
 		m_theMetric{ theMetric }, m_theSource{ theSource },
 		m_AllDiagnostics{ CreateDiagnosticVector(diagbit,valdiagbit,this) },
 		m_AllTerminations{ CreateTerminationVector(termbit,this) },
-		m_theIntegrator{ theIntegrator }
+		m_theIntegrator{ theIntegrator },
+		m_DiagnosticDispatch{ m_AllDiagnostics },
+		m_TerminationDispatch{ m_AllTerminations }
 	{	}
 
 	// This initializes/resets the geodesic with a given ScreenIndex, initial position, and initial velocity
@@ -92,7 +192,11 @@ public:
 	void Reset(ScreenIndex scrindex, Point initpos, OneIndex initvel);
 
 	// This makes the Geodesic integrate itself one step; then the Geodesic loops through all Terminations and Diagnostics to update
+	// (passing them its new position and number of steps taken)
 	Term Update();
+	// This moves the Geodesic to a new position and velocity, after an (affine parameter) step that has been taken outside of the
+	// Geodesic (e.g. by a GeodesicBatch); then the Geodesic loops through all Terminations and Diagnostics to update
+	Term UpdateWithStep(const Point& newpos, const OneIndex& newvel, real step);
 
 	// Getters for properties of its internal state
 	Term getTermCondition() const; // Current termination condition (Term::Continue if not done integrating)
@@ -101,13 +205,23 @@ public:
 	real getCurrentLambda() const; // Current value of affine parameter
 
 	// Output getters, to be called after the Geodesic terminates
-	// This gets the complete output that should be written to the output files;
-	// there is one string more than the count of Diagnostics: one string per Diagnostic,
-	// PLUS the first string is the screen index.
-	std::vector<std::string> getAllOutputStr() const;
-	// This returns the "value" (from the Diagnostic that was set to the value Diagnostic) that is associated
-	// to the Geodesic. Will be used to determine "distance" between Geodesics which is used in Mesh refinement.
-	std::vector<real> getDiagnosticFinalValue() const;
+	// The screen index of the Geodesic
+	ScreenIndex getScreenIndex() const;
+
+	// The outputs are written into buffers provided by the caller (which are emptied first but keep their memory,
+	// so that these do not allocate memory if the buffers are reused for every Geodesic):
+	// - WriteAllOutput() writes the complete output that should be written to the output files into the record:
+	// the screen index and the output of every Diagnostic, as text or (if numerical is true) in numerical form
+	// (for binary output: for every Diagnostic, the number n of values it outputs followed by its n values);
+	// - WriteDiagnosticFinalValue() writes the "value" (from the Diagnostic that was set to the value Diagnostic)
+	// that is associated to the Geodesic. Will be used to determine "distance" between Geodesics which is used in Mesh refinement.
+	void WriteAllOutput(GeodesicOutputRecord& theRecord, bool numerical) const;
+	void WriteDiagnosticFinalValue(std::vector<real>& values) const;
+
+	// This turns the (terminated) Geodesic into its mirror image under the equatorial reflection theta -> pi - theta,
+	// which has screen index mirrorscrindex: its position, velocity and the data of all its Diagnostics are reflected.
+	// Only meaningful if the Metric (and Source) are equatorially symmetric!
+	void ReflectEquatorially(ScreenIndex mirrorscrindex);
 
 private:
 	// These variables define its internal state
@@ -115,6 +229,7 @@ private:
 	Point m_CurrentPos{}; // Current position
 	OneIndex m_CurrentVel{}; // Current proper velocity 
 	real m_curLambda{ 0.0 }; // Current value of affine parameter (starts at 0.0)
+	largecounter m_NrSteps{ 0 }; // Number of steps taken so far (passed on to the Diagnostics and Terminations)
 
 
 	// The Geodesic keeps track of what index it has been assigned;
@@ -129,6 +244,64 @@ private:
 	const DiagnosticUniqueVector m_AllDiagnostics;
 	const TerminationUniqueVector m_AllTerminations;
 	const GeodesicIntegratorFunc m_theIntegrator; // This is the function that will integrate the geodesic equation one step
+	// The same Diagnostics and Terminations (non-owner pointers), sorted by type so that the calls after every step
+	// do not go through the vtable (see StaticDispatchList above)
+	const DiagnosticDispatchList m_DiagnosticDispatch;
+	const TerminationDispatchList m_TerminationDispatch;
+};
+
+
+/////////////////////////////////////////////
+//// DECLARATIONS OF GEODESICBATCH CLASS ////
+
+// GeodesicBatch class: a batch of BatchSize Geodesics that are integrated together (in lockstep)
+// by a BatchGeodesicIntegratorFunc. Every "lane" of the batch holds one Geodesic (and its index in the current
+// loop of geodesics). When the Geodesic in a lane terminates, the lane is masked out of the integration
+// until a new Geodesic is started in it with ResetLane().
+class GeodesicBatch
+{
+public:
+	// Default constructor not allowed
+	GeodesicBatch() = delete;
+	// Copy constructor or copy assignment not allowed
+	GeodesicBatch(const GeodesicBatch&) = delete;
+	GeodesicBatch& operator=(const GeodesicBatch&) = delete;
+
+	// Constructor which creates all Geodesics in the batch;
+	// takes the same arguments as the Geodesic constructor, except for the (batched) integrator
+	GeodesicBatch(const Metric* const theMetric, const Source* const theSource,
+		DiagBitflag diagbit, DiagBitflag valdiagbit,
+		TermBitflag termbit, BatchGeodesicIntegratorFunc theIntegrator);
+
+	// Start integrating a new Geodesic in the lane, with the given index, screen index and initial position/velocity
+	void ResetLane(int lane, largecounter index, ScreenIndex scrindex, Point initpos, OneIndex initvel);
+	// Mark the lane as empty (no more Geodesics to integrate in it)
+	void ClearLane(int lane);
+
+	// Integrate all Geodesics in the batch that have not terminated yet by one step
+	// Returns the number of Geodesics that were integrated
+	int Update();
+
+	// Getters for the lanes
+	// Is the Geodesic in the lane still being integrated?
+	bool IsLaneIntegrating(int lane) const;
+	// The index of the Geodesic in the lane (LARGECOUNTER_MAX if the lane is empty)
+	largecounter getLaneIndex(int lane) const;
+	// The Geodesic in the lane (e.g. for its output after it has terminated)
+	const Geodesic& getLaneGeodesic(int lane) const;
+	Geodesic& getLaneGeodesic(int lane);
+
+private:
+	// The Geodesics in the batch (one per lane)
+	std::vector<std::unique_ptr<Geodesic>> m_Geodesics{};
+	// The index of the Geodesic in each lane
+	std::array<largecounter, BatchSize> m_LaneIndices{};
+
+	// Metric and Source are needed to evaluate the geodesic equation
+	const Metric* const m_theMetric;
+	const Source* const m_theSource;
+	// This is the function that will integrate the geodesic equation one step for the whole batch
+	const BatchGeodesicIntegratorFunc m_theIntegrator;
 };
 
 #endif
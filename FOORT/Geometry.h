@@ -5,6 +5,7 @@
 ////// GEOMETRY.H
 ////// Definitions and some operations with geometric objects
 ////// Defines Point, tensors with 1-4 indices, and the operator toString for them
+////// Also defines the formatting of (real and integer) numbers as text, used for all text output
 ////// Also defines basic tensor arithmetic (+, -, *, /)
 ////// (No .cpp with implementations; all functions are inline)
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +13,8 @@
 #include <limits> // for std::numeric_limits
 #include <string> // needed for toString(...) to convert tensors to strings
 #include <array> // needed to define tensors as fixed-size arrays of real or pixelcoord
+#include <charconv> // std::to_chars, to format numbers as text
+#include <cstddef> // std::size_t
 
 
 // A real number.
@@ -70,6 +73,73 @@ using ThreeIndex = std::array<TwoIndex, dimension>;
 // Object with four indices is an array of ThreeIndex objects
 using FourIndex = std::array<ThreeIndex, dimension>;
 
+// The number of geodesics that are integrated together (in lockstep) by a batched integrator
+inline constexpr int BatchSize{ 8 };
+// A batch of reals (one for each geodesic in the batch)
+using BatchReal = std::array<real, BatchSize>;
+// A batch of Points in structure-of-arrays layout: BatchPoint[mu][i] is the mu-th coordinate of the i-th Point,
+// so that loops over the batch can be vectorized
+using BatchPoint = std::array<BatchReal, dimension>;
+// A batch of OneIndex objects has the same structure as a BatchPoint
+using BatchOneIndex = BatchPoint;
+
+
+/// <summary>
+/// PRINTING NUMBERS TO STRING
+/// </summary>
+
+// All real numbers in the text output (output files, first line info, toString) are written with std::to_chars,
+// which is locale-independent and does not allocate; the numbers are appended to an existing string.
+// The precision is either a fixed number of decimals (the default of 6 decimals gives exactly the same text
+// as std::to_string), or RealPrecision_Shortest: the shortest representation that is read back as exactly
+// the same real (possibly in scientific notation, e.g. 1e-05).
+inline constexpr int RealPrecision_Shortest{ -1 };
+// The largest number of decimals that can be set
+inline constexpr int RealPrecision_Max{ 30 };
+
+// The precision currently in use; set this (once, at startup) with SetRealPrecision()
+inline int theRealPrecision{ 6 };
+
+// Set and Get for the precision of real numbers in the text output;
+// an invalid precision is clamped to [RealPrecision_Shortest, RealPrecision_Max]
+inline void SetRealPrecision(int precision)
+{
+	theRealPrecision = precision < RealPrecision_Shortest ? RealPrecision_Shortest
+		: (precision > RealPrecision_Max ? RealPrecision_Max : precision);
+}
+inline int GetRealPrecision()
+{
+	return theRealPrecision;
+}
+
+// Appends a real number to the string, using the set precision
+inline void AppendReal(std::string& theStr, real number)
+{
+	// Large enough for any double with RealPrecision_Max decimals (at most 309 digits before the decimal point)
+	char numberbuffer[352];
+	const std::to_chars_result res{ theRealPrecision == RealPrecision_Shortest
+		? std::to_chars(numberbuffer, numberbuffer + sizeof(numberbuffer), number)
+		: std::to_chars(numberbuffer, numberbuffer + sizeof(numberbuffer), number, std::chars_format::fixed, theRealPrecision) };
+	theStr.append(numberbuffer, static_cast<std::size_t>(res.ptr - numberbuffer));
+}
+
+// Appends an integer to the string
+template<typename Integer>
+void AppendInteger(std::string& theStr, Integer number)
+{
+	char numberbuffer[24]; // large enough for any 64-bit integer
+	const std::to_chars_result res{ std::to_chars(numberbuffer, numberbuffer + sizeof(numberbuffer), number) };
+	theStr.append(numberbuffer, static_cast<std::size_t>(res.ptr - numberbuffer));
+}
+
+// Converts a real number to a string, using the set precision (to be used instead of std::to_string(real))
+inline std::string RealToString(real number)
+{
+	std::string theStr{};
+	AppendReal(theStr, number);
+	return theStr;
+}
+
 
 /// <summary>
 /// PRINTING TENSORS TO STRING
@@ -85,11 +155,10 @@ std::string toString(const std::array<largecounter, TensorDim>& theTensor)
 	std::string theStr{ "(" }; // no spaces for the innermost brackets
 	for (int i = 0; i < TensorDim - 1; ++i)
 	{
-		// Here we use the std::to_string to convert the real to string
-		theStr += std::to_string(theTensor[i]);
+		AppendInteger(theStr, theTensor[i]);
 		theStr += ", ";
 	}
-	theStr += std::to_string(theTensor[TensorDim - 1]);
+	AppendInteger(theStr, theTensor[TensorDim - 1]);
 	theStr += ")"; // no spaces for the innermost brackets
 
 	return theStr;
@@ -103,11 +172,10 @@ std::string toString(const std::array<real, TensorDim>& theTensor)
 
 	for (int i = 0; i < TensorDim - 1; ++i)
 	{
-		// Here we use the std::to_string to convert the real to string
-		theStr += std::to_string(theTensor[i]);
+		AppendReal(theStr, theTensor[i]);
 		theStr += ", ";
 	}
-	theStr += std::to_string(theTensor[TensorDim - 1]);
+	AppendReal(theStr, theTensor[TensorDim - 1]);
 	theStr += ")"; // no spaces for the innermost brackets
 
 	return theStr;
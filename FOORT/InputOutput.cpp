@@ -1,7 +1,21 @@
 #include "InputOutput.h" // We are defining functions from here
 
 #include <algorithm> // needed for std::min etc
-#include <filesystem> // needed for std::filesystem::create_directories
+#include <sstream> // std::istringstream (reading previous output)
+#include <filesystem> // needed for std::filesystem::create_directories (and file sizes for checkpoints)
+#include <charconv> // std::to_chars
+#include <cstring> // std::memcpy (memory-mapped output)
+#include <utility> // std::swap
+
+#include <omp.h> // omp_get_thread_num() etc. (per-thread output arenas)
+
+// Memory-mapped output files are only supported on POSIX systems
+#if defined(__unix__) || defined(__APPLE__)
+#define FOORT_MAPPED_OUTPUT
+#include <fcntl.h> // open()
+#include <sys/mman.h> // mmap(), munmap(), msync()
+#include <unistd.h> // ftruncate(), close()
+#endif
 
 
 /// <summary>
@@ -61,19 +75,39 @@ void ScreenOutput(std::string_view theOutput, OutputLevel lvl, bool newLine)
 
 // Constructor initializes all const member variables using the arguments
 GeodesicOutputHandler::GeodesicOutputHandler(std::string FilePrefix, std::string TimeStamp, std::string FileExtension,
-	std::vector<std::string> DiagNames, largecounter nroutputstocache, largecounter geodperfile, std::string firstlineinfo) :
-	m_FilePrefix {FilePrefix}, m_TimeStamp{TimeStamp}, m_FileExtension{FileExtension}, m_DiagNames{DiagNames},
+	std::vector<std::string> DiagNames, largecounter nroutputstocache, largecounter geodperfile, std::string firstlineinfo,
+	OutputFormat format, largecounter streambuffersize, std::vector<int> mappedvaluecounts) :
+	m_FilePrefix {FilePrefix}, m_TimeStamp{TimeStamp}, m_FileExtension{FileExtension}, m_DiagNames{DiagNames}, m_Format{ format },
+	m_PrintFirstLineInfo{firstlineinfo != ""}, m_FirstLineInfoString{ firstlineinfo },
 	// Make sure that we only cache up to the max amount that fits in largecounter
 	// OR, if smaller, the max amount of elements that can be reserved in the cache vector
 	m_nrOutputsToCache{ static_cast<largecounter>( std::min({ static_cast<size_t>(nroutputstocache),
-													m_AllCachedData.max_size() - 1,
+													m_AllCachedRecords.max_size() - 1,
 													static_cast<size_t>(LARGECOUNTER_MAX - 1) }) ) },
-	m_nrGeodesicsPerFile{ geodperfile }, m_PrintFirstLineInfo{firstlineinfo != ""},
-	m_FirstLineInfoString{ firstlineinfo }
+	m_nrGeodesicsPerFile{ geodperfile },
+	// There are no files to map if we are writing to console
+	m_MappedValueCounts{ (FilePrefix == "" || geodperfile == 0 || mappedvaluecounts.empty()) ? std::vector<std::uint32_t>{}
+		: CheckMappedValueCounts(mappedvaluecounts, format, DiagNames) },
+	// There is nothing to stream if we are writing to console (or if the output is written to mapped files directly)
+	// (note that m_MappedValueCounts is declared, and so initialized, before m_StreamBufferSize)
+	m_StreamBufferSize{ (FilePrefix == "" || geodperfile == 0 || !m_MappedValueCounts.empty()) ? 0 : streambuffersize }
 {
 	// If no prefix has been set, or we are allowed zero geodesics per file, then we necessarily output to the console
 	if (m_FilePrefix == "" || m_nrGeodesicsPerFile == 0)
 		m_WriteToConsole = true;
+
+	// The ring buffer is allocated once and for all
+	if (m_StreamBufferSize > 0)
+		m_StreamBuffer = std::vector<GeodesicOutputRecord>(m_StreamBufferSize);
+}
+
+GeodesicOutputHandler::~GeodesicOutputHandler()
+{
+	// Make sure the writer thread finishes writing and is joined
+	// (this is already done if OutputFinished() was called)
+	if (m_WriterThread.joinable())
+		OutputFinished();
+	CloseMappedFiles();
 }
 
 std::string GeodesicOutputHandler::getFullDescriptionStr() const
@@ -84,7 +118,10 @@ std::string GeodesicOutputHandler::getFullDescriptionStr() const
 		return "Output Handler: Basic (value diagnostic) file name: " + GetFileName(0, 1)
 			+ ", caching outputs: " + std::to_string(m_nrOutputsToCache)
 			+ ", geodesics per file: " + std::to_string(m_nrGeodesicsPerFile)
-			+ ", printing first line info: " + std::to_string(m_PrintFirstLineInfo);
+			+ ", printing first line info: " + std::to_string(m_PrintFirstLineInfo)
+			+ (m_Format == OutputFormat::Binary ? ", binary format" : "")
+			+ (!m_MappedValueCounts.empty() ? ", memory-mapped files" : "")
+			+ (m_StreamBufferSize > 0 ? ", streaming (buffer size: " + std::to_string(m_StreamBufferSize) + ")" : "");
 	}
 	else
 	{
@@ -92,166 +129,520 @@ std::string GeodesicOutputHandler::getFullDescriptionStr() const
 	}
 }
 
+largecounter GeodesicOutputHandler::IncludePreviousOutput(const std::string& previousoutput, largecounter indexscale)
+{
+	const int nrdiags{ static_cast<int>(m_DiagNames.size()) };
+	constexpr int nrindices{ static_cast<int>(ScreenIndex{}.size()) };
+
+	// The previous output is passed on in chunks of this many geodesics, exactly as if they were integrated
+	constexpr largecounter chunksize{ 10000 };
+	std::vector<GeodesicOutputRecord> chunk(chunksize);
+	largecounter nrinchunk{ 0 };
+	auto PassOnChunk = [this, &chunk, &nrinchunk]()
+	{
+		PrepareForOutput(nrinchunk);
+		for (largecounter i = 0; i < nrinchunk; ++i)
+			NewGeodesicOutput(i, chunk[i]);
+		nrinchunk = 0;
+	};
+
+	// Text files: the next line "(screen index) (output string of the Diagnostic)" (any line that does not start with
+	// a screen index, such as the first line info, is skipped). Returns false at the end of the file
+	auto ReadTextLine = [](std::ifstream& inf, ScreenIndex& index, std::string& output) -> bool
+	{
+		std::string line{};
+		while (std::getline(inf, line))
+		{
+			std::istringstream linestream{ line };
+			bool validindex{ true };
+			for (largecounter& k : index)
+				validindex = validindex && static_cast<bool>(linestream >> k);
+			const std::string indexstr{ ScreenIndexToString(index) };
+			// (the screen index is written as in ScreenIndexToString(), followed by a space)
+			if (validindex && line.compare(0, indexstr.size() + 1, indexstr + " ") == 0)
+			{
+				output = line.substr(indexstr.size() + 1);
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Binary files: the next record (see InputOutput.h), whose values are added to values. Returns false at the end of the file
+	auto ReadBinaryRecord = [](std::ifstream& inf, ScreenIndex& index, std::vector<real>& values) -> bool
+	{
+		for (largecounter& k : index)
+		{
+			std::uint64_t val{};
+			if (!inf.read(reinterpret_cast<char*>(&val), sizeof(val)))
+				return false;
+			k = static_cast<largecounter>(val);
+		}
+		std::uint32_t nrvalues{};
+		if (!inf.read(reinterpret_cast<char*>(&nrvalues), sizeof(nrvalues)))
+			return false;
+		values.push_back(static_cast<real>(nrvalues));
+		values.resize(values.size() + nrvalues);
+		return static_cast<bool>(inf.read(reinterpret_cast<char*>(values.data() + values.size() - nrvalues), nrvalues * sizeof(real)));
+	};
+
+	// Binary files: check and skip the header (see InputOutput.h)
+	auto ReadBinaryHeader = [](std::ifstream& inf) -> bool
+	{
+		char magic[8]{};
+		std::uint32_t version{}, nrscreenindices{}, length{};
+		if (!inf.read(magic, 8) || std::string_view(magic, 8) != std::string_view(BinaryOutputMagic, 8)
+			|| !inf.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != BinaryOutputVersion
+			|| !inf.read(reinterpret_cast<char*>(&nrscreenindices), sizeof(nrscreenindices))
+			|| nrscreenindices != static_cast<std::uint32_t>(nrindices))
+			return false;
+		// Diagnostic name and run information
+		for (int i = 0; i < 2; ++i)
+		{
+			if (!inf.read(reinterpret_cast<char*>(&length), sizeof(length)) || !inf.ignore(length))
+				return false;
+		}
+		return true;
+	};
+
+	largecounter nrincluded{ 0 };
+	bool fileerror{ false };
+
+	// Go through the previous output files in order; in every file, the Diagnostics have written the same geodesics
+	// in the same order, so we read a geodesic from every Diagnostic's file at the same time
+	for (unsigned short filenr = 1; !fileerror; ++filenr)
+	{
+		std::vector<std::ifstream> files(nrdiags);
+		for (int diagnr = 0; diagnr < nrdiags && !fileerror; ++diagnr)
+		{
+			// The name of the previous file, constructed as in GetFileName()
+			std::string filename{ previousoutput + "_" + m_DiagNames[diagnr] };
+			if (filenr > 1)
+				filename += "_" + std::to_string(filenr);
+			if (m_FileExtension != "")
+				filename += "." + m_FileExtension;
+
+			files[diagnr].open(filename, std::ios::in
+				| (m_Format == OutputFormat::Binary ? std::ios::binary : std::ios::openmode{}));
+			if (!files[diagnr])
+			{
+				// If there is no next file (for any Diagnostic), we have read all previous output
+				if (filenr > 1 && diagnr == 0)
+					break;
+				ScreenOutput("Could not open previous output file " + filename + "!", OutputLevel::Level_0_WARNING);
+				fileerror = true;
+			}
+			else if (m_Format == OutputFormat::Binary && !ReadBinaryHeader(files[diagnr]))
+			{
+				ScreenOutput(filename + " is not a valid binary output file!", OutputLevel::Level_0_WARNING);
+				fileerror = true;
+			}
+		}
+		if (fileerror || !files[0].is_open())
+			break;
+
+		while (true)
+		{
+			ScreenIndex index{};
+			GeodesicOutputRecord& record{ chunk[nrinchunk] };
+			record.Clear();
+			int diagsread{ 0 };
+			for (int diagnr = 0; diagnr < nrdiags; ++diagnr)
+			{
+				ScreenIndex diagindex{};
+				std::string diagoutput{};
+				if (m_Format == OutputFormat::Binary ? !ReadBinaryRecord(files[diagnr], diagindex, record.Values)
+					: !ReadTextLine(files[diagnr], diagindex, diagoutput))
+					break;
+				if (diagnr > 0 && diagindex != index)
+					break;
+				index = diagindex;
+				record.Text += diagoutput;
+				record.TextEnds.push_back(record.Text.size());
+				++diagsread;
+			}
+
+			// Done with this file (for all Diagnostics)
+			if (diagsread == 0)
+				break;
+			if (diagsread < nrdiags)
+			{
+				ScreenOutput("Previous output files nr. " + std::to_string(filenr) + " do not match up!",
+					OutputLevel::Level_0_WARNING);
+				fileerror = true;
+				break;
+			}
+
+			// The geodesic's place on the current grid
+			for (largecounter& k : index)
+				k *= indexscale;
+			record.Index = index;
+			++nrinchunk;
+
+			if (++nrincluded % chunksize == 0)
+				PassOnChunk();
+		}
+	}
+
+	PassOnChunk();
+
+	return nrincluded;
+}
+
+void GeodesicOutputHandler::SaveCheckpoint(std::ostream& out)
+{
+	// Everything that has arrived so far must be in the files before we record how large they are
+	std::unique_lock<std::mutex> lock{ m_StreamMutex, std::defer_lock };
+	if (m_StreamBufferSize > 0)
+	{
+		// Wait until the writer thread has written everything in the buffer;
+		// we keep the lock so that it stays idle while we look at the files
+		lock.lock();
+		m_StreamNotFull.wait(lock, [this]() { return m_StreamCount == 0 && !m_StreamWriting; });
+	}
+	else if (IsMappedOutput())
+		FinishMappedOutput();
+	else
+		WriteCachedOutputToFile();
+
+	// The current size of every open output file
+	std::vector<std::uint64_t> filesizes{};
+	if (IsMappedOutput())
+	{
+		// The mapped files always have exactly the size of the records written to them; we make sure these are on disk
+		for (int diagnr = 0; diagnr < static_cast<int>(m_DiagNames.size()); ++diagnr)
+		{
+			std::uint64_t filesize{ 0 };
+			if (!m_MappedFiles.empty())
+			{
+				const MappedFile& mapped{ m_MappedFiles[0][diagnr] };
+#ifdef FOORT_MAPPED_OUTPUT
+				msync(mapped.Data, mapped.Size, MS_SYNC);
+#endif
+				filesize = mapped.Size;
+			}
+			filesizes.push_back(filesize);
+		}
+	}
+	for (int diagnr = 0; diagnr < static_cast<int>(m_OutputFiles.size()); ++diagnr)
+	{
+		std::uint64_t filesize{ 0 };
+		if (m_OutputFiles[diagnr].is_open() && m_OutputFiles[diagnr].flush())
+		{
+			std::error_code ec{};
+			filesize = std::filesystem::file_size(GetFileName(diagnr, m_CurrentFullFiles + 1), ec);
+		}
+		filesizes.push_back(filesize);
+	}
+
+	Checkpoint::WriteString(out, m_TimeStamp);
+	Checkpoint::Write(out, m_WriteToConsole);
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_CurrentFullFiles));
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_CurrentGeodesicsInFile));
+	Checkpoint::WriteVector(out, filesizes);
+}
+
+bool GeodesicOutputHandler::LoadCheckpoint(std::istream& in)
+{
+	std::string timestamp{};
+	bool writetoconsole{};
+	std::uint64_t fullfiles{}, geodesicsinfile{};
+	std::vector<std::uint64_t> filesizes{};
+	if (!Checkpoint::ReadString(in, timestamp) || !Checkpoint::Read(in, writetoconsole)
+		|| !Checkpoint::Read(in, fullfiles) || !Checkpoint::Read(in, geodesicsinfile)
+		|| !Checkpoint::ReadVector(in, filesizes))
+		return false;
+
+	// We continue with the files of the original run
+	m_TimeStamp = timestamp;
+	m_CurrentFullFiles = static_cast<unsigned short>(fullfiles);
+	m_CurrentGeodesicsInFile = static_cast<largecounter>(geodesicsinfile);
+
+	// If the original run had switched to the console (or we are writing to console now), there are no files to continue
+	if (writetoconsole || m_WriteToConsole)
+	{
+		m_WriteToConsole = true;
+		return true;
+	}
+
+	// If the current files were partially written, continue writing in them (otherwise, the next output opens new files)
+	if (m_CurrentGeodesicsInFile > 0)
+	{
+		if (filesizes.size() != m_DiagNames.size())
+			return false;
+		ReopenFiles(filesizes);
+	}
+
+	return true;
+}
+
 void GeodesicOutputHandler::PrepareForOutput(largecounter nrOutputToCome)
 {
+	// In memory-mapped mode, nothing is cached, we only need to make room for the output in the files
+	// (unless this fails: then we continue below, caching the output to write it to console)
+	if (IsMappedOutput())
+	{
+		PrepareMappedFiles(nrOutputToCome);
+		if (IsMappedOutput())
+			return;
+	}
+
+	// In streaming mode, nothing is cached, we only need to make sure the writer thread is running
+	if (m_StreamBufferSize > 0)
+	{
+		if (!m_WriterThread.joinable())
+			m_WriterThread = std::thread(&GeodesicOutputHandler::WriterThreadLoop, this);
+		return;
+	}
+
 	// If the output that is coming will put us over the caching limit, first write the cached data to file
-	if (m_AllCachedData.size() + nrOutputToCome > m_nrOutputsToCache)
+	if (getNrCached() + nrOutputToCome > m_nrOutputsToCache)
 	{
 		WriteCachedOutputToFile();
 	}
 
 	// This many outputs are already stored in the cached data, so we need to offset the incoming data by this much
-	m_PrevCached = static_cast<largecounter>(m_AllCachedData.size());
+	m_PrevCached = getNrCached();
 
-	// We prepare our vector of cache data to receive the output: we must create dummy vectors of strings
-	// so that the received output will simply overwrite these (instead of placing a new vector of strings into
-	// m_AllCachedData, which would introduce data races)
-	m_AllCachedData.insert(m_AllCachedData.end(), nrOutputToCome, std::vector<std::string>{});
+	// We prepare our vector of cached records to receive the output: we must create dummy records
+	// so that the received output will simply overwrite these (instead of placing a new record into
+	// m_AllCachedRecords, which would introduce data races)
+	m_AllCachedRecords.resize(m_AllCachedRecords.size() + nrOutputToCome);
+
+	// Every thread that can pass on output needs its own arena
+	const std::size_t nrthreads{ static_cast<std::size_t>(std::max(omp_get_max_threads(), omp_get_num_threads())) };
+	if (m_Arenas.size() < nrthreads)
+		m_Arenas.resize(nrthreads);
 }
 
 
-void GeodesicOutputHandler::NewGeodesicOutput(largecounter index, std::vector<std::string> theOutput)
+void GeodesicOutputHandler::NewGeodesicOutput(largecounter index, const GeodesicOutputRecord& theOutput)
 {
-	// NOTE: this must be thread-safe! Indeed, we are only overwriting an existing element of m_AllCachedData
-	
+	// In memory-mapped mode, write the output directly to the files
+	if (IsMappedOutput())
+	{
+		WriteGeodesicMapped(index, theOutput);
+		return;
+	}
+
+	// In streaming mode, pass the output on to the writer thread
+	if (m_StreamBufferSize > 0)
+	{
+		StreamOutput(theOutput);
+		return;
+	}
+
+	// NOTE: this must be thread-safe! Indeed, we are only overwriting an existing element of m_AllCachedRecords,
+	// and appending to the arena that only this thread uses
+
 	// We put this current output in the cached data
 	// Note the offset by m_PrevCached
-	// Move semantics to avoid copying the entire vector of string
-	m_AllCachedData[m_PrevCached + index] = std::move(theOutput);
+	const std::size_t arenanr{ static_cast<std::size_t>(omp_get_thread_num()) };
+	OutputArena& arena{ m_Arenas[arenanr] };
+	CachedRecord& cached{ m_AllCachedRecords[m_PrevCached + index] };
+	cached = CachedRecord{ theOutput.Index, arenanr, arena.Text.size(), arena.TextEnds.size(), arena.Values.size() };
+
+	// Only the output of the right format is present in the record
+	arena.Text += theOutput.Text;
+	arena.TextEnds.insert(arena.TextEnds.end(), theOutput.TextEnds.begin(), theOutput.TextEnds.end());
+	arena.Values.insert(arena.Values.end(), theOutput.Values.begin(), theOutput.Values.end());
 }
 
-void GeodesicOutputHandler::OutputFinished()
+bool GeodesicOutputHandler::IsBinaryOutput() const
 {
-	// There is no more output, so we write anything that is cached to file to clean up and finalize
-	WriteCachedOutputToFile();
+	return m_Format == OutputFormat::Binary;
 }
 
-void GeodesicOutputHandler::WriteCachedOutputToFile()
+largecounter GeodesicOutputHandler::getNrCached() const
 {
-	// Check if there is anything to do
-	if (m_AllCachedData.size() == 0)
-		return;
+	return static_cast<largecounter>(m_AllCachedRecords.size());
+}
 
-	if (!m_WriteToConsole)	// We are writing to files
+void GeodesicOutputHandler::OutputFinished()
+{
+	if (m_StreamBufferSize > 0)
 	{
-		ScreenOutput("Writing cached geodesic output to file(s)...", OutputLevel::Level_2_SUBPROC);
+		// Tell the writer thread that no more output is coming; it will write everything left in the buffer and then finish
+		{
+			std::lock_guard<std::mutex> lock{ m_StreamMutex };
+			m_StreamFinished = true;
+		}
+		m_StreamNotEmpty.notify_one();
+		if (m_WriterThread.joinable())
+			m_WriterThread.join();
+	}
+	else if (IsMappedOutput())
+	{
+		// All output is already in the files
+		FinishMappedOutput();
+	}
+	else
+	{
+		// There is no more output, so we write anything that is cached to file to clean up and finalize
+		WriteCachedOutputToFile();
+	}
 
-		// Check if we will be breaking the cached output into multiple files
-		unsigned short nrfiles{ 1 };
-		// Note that the constructor has checked that indeed m_nrGeodesicsPerFile > 0
-		while (m_CurrentGeodesicsInFile + m_AllCachedData.size() > nrfiles * m_nrGeodesicsPerFile)
-			++nrfiles;
+	// All output has been written, so we can close the files
+	CloseFiles();
+	CloseMappedFiles();
+}
 
-		// Keeps track of the current file we are working in; note that this will be offset by the number of
-		// full files when specifying the true file number to write to
-		unsigned short curfile{ 1 };
-		// The next geodesic (index in m_AllCachedData) that we need to output
-		largecounter curgeod{ 0 };
-		// The number of geodesics stored in the last file we will open for output
-		largecounter lastfilecount{ 0 };
-		// We are sure that the number of diagnostics fits in an int!
-		// Note that the first element of each output vector is the screen index
-		const int nrdiags{ static_cast<int>(m_AllCachedData[0].size()) - 1 };
+void GeodesicOutputHandler::StreamOutput(const GeodesicOutputRecord& theOutput)
+{
+	// NOTE: this is called by all integrating threads at the same time, so everything happens under the lock
+	{
+		std::unique_lock<std::mutex> lock{ m_StreamMutex };
+		// Back-pressure: if the buffer is full, wait until the writer thread has taken outputs out of it
+		m_StreamNotFull.wait(lock, [this]() { return m_StreamCount < m_StreamBufferSize; });
+
+		// (copying into the record in the buffer reuses its memory)
+		m_StreamBuffer[(m_StreamFirst + m_StreamCount) % m_StreamBufferSize] = theOutput;
+		++m_StreamCount;
+	}
+	m_StreamNotEmpty.notify_one();
+}
+
+void GeodesicOutputHandler::WriterThreadLoop()
+{
+	// The outputs that the writer thread is currently writing (taken out of the buffer all at once, by exchanging them
+	// with the records in here, which were written before)
+	std::vector<GeodesicOutputRecord> towrite(m_StreamBufferSize);
+	largecounter nrtowrite{ 0 };
 
-		// Are we exactly at a point where we need to start a new file for the first file we write to?
-		// If so, open each of the necessary new output files for the first time
-		if (m_CurrentGeodesicsInFile == 0)
+	while (true)
+	{
 		{
-			// Starting a new file (for each diagnostic), so open it for the first time
-			for (int i = 0; i < nrdiags && !m_WriteToConsole; ++i)
+			std::unique_lock<std::mutex> lock{ m_StreamMutex };
+			m_StreamNotEmpty.wait(lock, [this]() { return m_StreamCount > 0 || m_StreamFinished; });
+
+			// No more output is coming and everything has been written
+			if (m_StreamCount == 0)
+				break;
+
+			// Take everything that is in the buffer, so that the integrating threads can continue filling it
+			// while we write this to file
+			for (nrtowrite = 0; m_StreamCount > 0; --m_StreamCount, ++nrtowrite)
 			{
-				OpenForFirstTime( GetFileName(i, m_CurrentFullFiles + curfile) );
+				std::swap(towrite[nrtowrite], m_StreamBuffer[m_StreamFirst]);
+				m_StreamFirst = (m_StreamFirst + 1) % m_StreamBufferSize;
 			}
+			m_StreamWriting = true;
 		}
+		m_StreamNotFull.notify_all();
 
-		// The m_WriteToConsole check is because any file I/O error will trigger setting this to true
-		// We now loop through all of the files we need to write to
-		while (curfile <= nrfiles && !m_WriteToConsole)
+		for (largecounter i = 0; i < nrtowrite; ++i)
 		{
-			largecounter loopmax{ static_cast<largecounter>(m_AllCachedData.size()) };
-			if (curfile == 1)
+			const RecordView output{ getRecordView(towrite[i]) };
+
+			// Are we starting a new file (for each Diagnostic)?
+			if (m_CurrentGeodesicsInFile == 0 && !m_WriteToConsole)
+				OpenNextFiles();
+
+			if (m_WriteToConsole)
 			{
-				// if this is the first file we are writing to, then there could already be geodesics written
-				// to this file which we need to take into account
-				// (note that then automatically curgeod == 0)
-				loopmax = std::min(static_cast<largecounter>(m_AllCachedData.size()), m_nrGeodesicsPerFile - m_CurrentGeodesicsInFile);
+				WriteGeodesicToConsole(output);
+				continue;
 			}
-			else
+
+			for (int curdiag = 0; curdiag < static_cast<int>(m_OutputFiles.size()); ++curdiag)
 			{
-				// If this is not the first file we are writing to, then see if we will write all geodesics to this file or not
-				loopmax = std::min(static_cast<largecounter>(m_AllCachedData.size()) - curgeod, m_nrGeodesicsPerFile);
+				if (m_Format == OutputFormat::Binary)
+					WriteGeodesicBinary(m_OutputFiles[curdiag], output, curdiag);
+				else
+					WriteGeodesicText(m_OutputFiles[curdiag], output, curdiag);
 			}
 
-			// loop through each diagnostic
-			for (int curdiag = 0; curdiag < nrdiags; ++curdiag)
+			// Is the current file full now?
+			if (++m_CurrentGeodesicsInFile == m_nrGeodesicsPerFile)
 			{
-				// open appropriate file for appending
-				std::string outputfile{ GetFileName(curdiag, m_CurrentFullFiles + curfile) };
-				std::ofstream outf{ outputfile, std::ios::out | std::ios::app };
-
-				// If something goes wrong in opening the file,
-				// then write to console from now on
-				if (!outf)
-				{
-					ScreenOutput("Output file error! Could not open " + GetFileName(curdiag, m_CurrentFullFiles + curfile)
-						+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
-					m_WriteToConsole = true;
-				}
-				else
-				{
-					// All went well opening the file. Output the current diagnostic data of the current diagnostic
-					// for all geodesics that go in this file
-					for (largecounter j = curgeod; j < curgeod + loopmax; ++j)
-					{
-						// Output pixel and then diagnostic data
-						outf << m_AllCachedData[j][0] << " " << m_AllCachedData[j][curdiag + 1] << "\n";
-					}
-
-					// We are done with this diagnostic file, close file
-					outf.close();
-				}
+				++m_CurrentFullFiles;
+				m_CurrentGeodesicsInFile = 0;
 			}
+		}
+
+		// Done writing these outputs (SaveCheckpoint() may be waiting for this)
+		{
+			std::lock_guard<std::mutex> lock{ m_StreamMutex };
+			m_StreamWriting = false;
+		}
+		m_StreamNotFull.notify_all();
+	}
 
-			// We have now filled up the current file (or we have outputted all cached data already)
-			++curfile;
-			if (curfile <= nrfiles) // Is there still a file to be (partially) written?
+	// Make sure everything that is written is actually in the files
+	for (std::ofstream& outf : m_OutputFiles)
+		outf.flush();
+}
+
+void GeodesicOutputHandler::WriteCachedOutputToFile()
+{
+	// Check if there is anything to do
+	const largecounter nrcached{ getNrCached() };
+	if (nrcached == 0)
+		return;
+
+	if (!m_WriteToConsole)	// We are writing to files
+	{
+		ScreenOutput("Writing cached geodesic output to file(s)...", OutputLevel::Level_2_SUBPROC);
+
+		// We are sure that the number of diagnostics fits in an int!
+		const int nrdiags{ static_cast<int>(m_DiagNames.size()) };
+
+		// The next geodesic (index in the cache) that we need to output
+		largecounter curgeod{ 0 };
+
+		// The m_WriteToConsole check is because any file I/O error will trigger setting this to true
+		// We keep writing until all cached output is written, starting a new file whenever the current one is full
+		while (curgeod < nrcached && !m_WriteToConsole)
+		{
+			// Are we exactly at a point where we need to start a new file? If so, open the next file for each diagnostic
+			if (m_CurrentGeodesicsInFile == 0)
+				OpenNextFiles();
+			if (m_WriteToConsole)
+				break;
+
+			// This many geodesics still fit in the current file
+			largecounter nrtowrite{ std::min(nrcached - curgeod, m_nrGeodesicsPerFile - m_CurrentGeodesicsInFile) };
+
+			// Every diagnostic writes to its own file, so these can be written in parallel.
+			// Note: this is called from within a single thread in the parallel region of main(), so the other threads
+			// (waiting at the end of the single region) will pick up these tasks; outside of a parallel region,
+			// this simply loops over the diagnostics
+#pragma omp taskloop grainsize(1)
+			for (int curdiag = 0; curdiag < nrdiags; ++curdiag)
 			{
-				// We have outputted another loopmax geodesics, so increment curgeod accordingly
-				curgeod += loopmax;
-				// We will be starting a new file (for each diagnostic), so open it for the first time
-				for (int i = 0; i < nrdiags && !m_WriteToConsole; ++i)
+				for (largecounter j = curgeod; j < curgeod + nrtowrite; ++j)
 				{
-					OpenForFirstTime( GetFileName(i, m_CurrentFullFiles + curfile) );
+					// Output pixel and then diagnostic data
+					if (m_Format == OutputFormat::Text)
+						WriteGeodesicText(m_OutputFiles[curdiag], getCachedRecordView(j), curdiag);
+					else
+						WriteGeodesicBinary(m_OutputFiles[curdiag], getCachedRecordView(j), curdiag);
 				}
 			}
-			else // curfile > nrfiles, so we just did the last file
+
+			curgeod += nrtowrite;
+			m_CurrentGeodesicsInFile += nrtowrite;
+
+			// Is the current file full now? Then the next output goes to a new file
+			if (m_CurrentGeodesicsInFile == m_nrGeodesicsPerFile)
 			{
-				// This is how many geodesics went into the last file
-				lastfilecount = loopmax;
+				++m_CurrentFullFiles;
+				m_CurrentGeodesicsInFile = 0;
 			}
-			// We are now done with one iteration of the loop; the next iteration
-			// will write to the next file (for each geodesic). Note that we have prepared
-			// this next file (for each geodesic) for writing by opening it already for the first time.
-		} // end while
-
-		// We are done writing all the output to files. Now, we update the internal counters 
-		// We have filled up entirely nrfiles-1 files for sure.
-		m_CurrentFullFiles += nrfiles - 1;
-		// The last file may have been exactly filled, check this
-		if (lastfilecount == m_nrGeodesicsPerFile)
+		}
+
+		// Make sure everything has actually been written to the files (they stay open for the next output)
+		// and check that nothing went wrong
+		for (int curdiag = 0; curdiag < nrdiags && !m_WriteToConsole; ++curdiag)
 		{
-			// If the last file was exactly filled, we have one more full file, and the next file to write to
-			// will be empty
-			++m_CurrentFullFiles;
-			lastfilecount = 0;
+			m_OutputFiles[curdiag].flush();
+			if (!m_OutputFiles[curdiag])
+			{
+				ScreenOutput("Output file error! Could not write to " + GetFileName(curdiag, m_CurrentFullFiles + 1)
+					+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+				m_WriteToConsole = true;
+			}
 		}
-		// Set how many geodesics have already been written to in the current (non-full) file
-		// If nrfiles == 1, then we have written more into the already existing file, so we increment
-		// m_CurrentGeodesicsInFile by lastfilecount; otherwise m_CurrentGeodesicsInFile is equal to the lastfilecount
-		if (nrfiles == 1)
-			m_CurrentGeodesicsInFile += lastfilecount;
-		else
-			m_CurrentGeodesicsInFile = lastfilecount;
 
 		ScreenOutput("Done writing cached geodesic output to file(s).", OutputLevel::Level_2_SUBPROC);
 	} // end if (!m_WriteToConsole)
@@ -260,17 +651,113 @@ void GeodesicOutputHandler::WriteCachedOutputToFile()
 	if (m_WriteToConsole)	// write everything to console; note this is not an else from the previous if since in the previous if,
 							// we may encounter file I/O problems that sets this to true in the if block above
 	{
-		for (int i = 0; i < m_AllCachedData.size(); ++i)
+		for (largecounter j = 0; j < nrcached; ++j)
+			WriteGeodesicToConsole(getCachedRecordView(j));
+	}
+
+	// Whether we have written all output to file or to console, in any case we have outputted all cached data,
+	// so empty the cache now (keeping the memory of the cache for the next output)
+	m_AllCachedRecords.clear();
+	for (OutputArena& arena : m_Arenas)
+	{
+		arena.Text.clear();
+		arena.TextEnds.clear();
+		arena.Values.clear();
+	}
+}
+
+GeodesicOutputHandler::RecordView GeodesicOutputHandler::getRecordView(const GeodesicOutputRecord& theOutput)
+{
+	return RecordView{ theOutput.Index, theOutput.Text.data(), theOutput.TextEnds.data(), theOutput.Values.data() };
+}
+
+GeodesicOutputHandler::RecordView GeodesicOutputHandler::getCachedRecordView(largecounter j) const
+{
+	const CachedRecord& cached{ m_AllCachedRecords[j] };
+	const OutputArena& arena{ m_Arenas[cached.Arena] };
+	return RecordView{ cached.Index, arena.Text.data() + cached.TextStart, arena.TextEnds.data() + cached.TextEndsStart,
+		arena.Values.data() + cached.ValuesStart };
+}
+
+void GeodesicOutputHandler::WriteGeodesicText(std::ofstream& outf, const RecordView& theOutput, int diagnr)
+{
+	// Line: screen index (every component followed by a space), a space, and the Diagnostic's output string
+	char indexbuffer[64]; // large enough for all components of the screen index
+	char* indexend{ indexbuffer };
+	for (largecounter k : theOutput.Index)
+	{
+		indexend = std::to_chars(indexend, indexbuffer + sizeof(indexbuffer), k).ptr;
+		*indexend++ = ' ';
+	}
+	*indexend++ = ' ';
+	outf.write(indexbuffer, indexend - indexbuffer);
+	const std::size_t start{ diagnr == 0 ? 0 : theOutput.TextEnds[diagnr - 1] };
+	outf.write(theOutput.Text + start, static_cast<std::streamsize>(theOutput.TextEnds[diagnr] - start));
+	outf.put('\n');
+}
+
+void GeodesicOutputHandler::WriteGeodesicBinary(std::ofstream& outf, const RecordView& theOutput, int diagnr)
+{
+	// Find where the values of this Diagnostic start: skip over the values (and counts) of the previous Diagnostics
+	size_t start{ 0 };
+	for (int d = 0; d < diagnr; ++d)
+		start += 1 + static_cast<size_t>(theOutput.Values[start]);
+	std::uint32_t nrvalues{ static_cast<std::uint32_t>(theOutput.Values[start]) };
+
+	// Record: screen index, number of values, values
+	for (largecounter k : theOutput.Index)
+	{
+		std::uint64_t index{ k };
+		outf.write(reinterpret_cast<const char*>(&index), sizeof(index));
+	}
+	outf.write(reinterpret_cast<const char*>(&nrvalues), sizeof(nrvalues));
+	static_assert(sizeof(real) == 8, "Binary output assumes real is a double.");
+	outf.write(reinterpret_cast<const char*>(theOutput.Values + start + 1), nrvalues * sizeof(real));
+}
+
+void GeodesicOutputHandler::WriteGeodesicToConsole(const RecordView& theOutput) const
+{
+	const int nrdiags{ static_cast<int>(m_DiagNames.size()) };
+	if (m_Format == OutputFormat::Text)
+	{
+		// The screen index, and then the output string of every Diagnostic on its own line
+		ScreenOutput(ScreenIndexToString(theOutput.Index), OutputLevel::Level_1_PROC);
+		for (int d = 0; d < nrdiags; ++d)
 		{
-			// write output line to console
-			for (int j = 0; j < m_AllCachedData[i].size(); ++j)
-				ScreenOutput(m_AllCachedData[i][j], OutputLevel::Level_1_PROC);
+			const std::size_t start{ d == 0 ? 0 : theOutput.TextEnds[d - 1] };
+			ScreenOutput(std::string_view(theOutput.Text + start, theOutput.TextEnds[d] - start), OutputLevel::Level_1_PROC);
+		}
+	}
+	else
+	{
+		// (binary output is written to the console as text)
+		// Screen index followed by all values (including the number of values for each Diagnostic)
+		std::string outputline{ ScreenIndexToString(theOutput.Index) };
+		size_t pos{ 0 };
+		for (int d = 0; d < nrdiags; ++d)
+		{
+			const size_t nrvalues{ static_cast<size_t>(theOutput.Values[pos]) };
+			for (size_t i = pos; i <= pos + nrvalues; ++i)
+			{
+				AppendReal(outputline, theOutput.Values[i]);
+				outputline += ' ';
+			}
+			pos += 1 + nrvalues;
 		}
+		ScreenOutput(outputline, OutputLevel::Level_1_PROC);
 	}
+}
 
-	// Whether we have written all output to file or to console, in any case we have outputted all cached data,
-	// so empty the cache now
-	m_AllCachedData.clear();
+std::string GeodesicOutputHandler::ScreenIndexToString(const ScreenIndex& theIndex)
+{
+	// Every component followed by a space
+	std::string indexstr{};
+	for (largecounter k : theIndex)
+	{
+		AppendInteger(indexstr, k);
+		indexstr += ' ';
+	}
+	return indexstr;
 }
 
 std::string GeodesicOutputHandler::GetFileName(int diagnr, unsigned short filenr) const
@@ -298,35 +785,397 @@ std::string GeodesicOutputHandler::GetFileName(int diagnr, unsigned short filenr
 	return FullFileName;
 }
 
-void GeodesicOutputHandler::OpenForFirstTime(const std::string& filename)
+void GeodesicOutputHandler::OpenNextFiles()
+{
+	// The file number we are opening (starting from 1)
+	const unsigned short filenr{ static_cast<unsigned short>(m_CurrentFullFiles + 1) };
+
+	// Make sure we have an output file stream (and its buffer) for every Diagnostic
+	m_OutputFiles.resize(m_DiagNames.size());
+	m_OutputFileBuffers.resize(m_DiagNames.size());
+
+	for (int diagnr = 0; diagnr < static_cast<int>(m_DiagNames.size()); ++diagnr)
+	{
+		const std::string filename{ GetFileName(diagnr, filenr) };
+		std::ofstream& outf{ m_OutputFiles[diagnr] };
+
+		// Close the previous (full) file for this Diagnostic, if there was one
+		if (outf.is_open())
+			outf.close();
+		outf.clear();
+
+		// We check here to see if the files are being put in a (sub)directory;
+		// if so, we create the directory/directories first to make sure creating/opening the file
+		// will succeed.
+		auto pos = filename.find_last_of("/");
+		if (pos != std::string::npos) // there is at least one slash, so files are in a (sub)directory
+		{
+			// This creates all necessary directories in this structure
+			// If the directory already exists, it does nothing
+			std::filesystem::create_directories(filename.substr(0, pos));
+		}
+
+		// Give the file stream a large buffer, so that it does not need to go to the OS for every geodesic written.
+		// Note: this must be done before opening the file to have an effect
+		m_OutputFileBuffers[diagnr].resize(OutputFileBufferSize);
+		outf.rdbuf()->pubsetbuf(m_OutputFileBuffers[diagnr].data(), OutputFileBufferSize);
+
+		// Open the file, effectively overwriting the file; it stays open until it is full (or output is finished)
+		outf.open(filename, std::ios::out | std::ios::trunc
+			| (m_Format == OutputFormat::Binary ? std::ios::binary : std::ios::openmode{}));
+
+		if (!outf) // Trigger writing to console if failed to open file
+		{
+			ScreenOutput("Output file error! Could not open " + filename
+				+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+			m_WriteToConsole = true;
+			CloseFiles();
+			return;
+		}
+		else if (m_Format == OutputFormat::Binary)
+		{
+			WriteBinaryHeader(outf, diagnr);
+		}
+		else
+		{
+			// write first line info in the file; it is then prepared for geodesic output
+			if (m_PrintFirstLineInfo)
+				outf << m_FirstLineInfoString << "\n";
+		}
+	}
+}
+
+void GeodesicOutputHandler::CloseFiles()
 {
-	// We check here to see if the files are being put in a (sub)directory;
-	// if so, we create the directory/directories first to make sure creating/opening the file
-	// will succeed.
-	auto pos = filename.find_last_of("/");
-	if (pos != std::string::npos) // there is at least one slash, so files are in a (sub)directory
+	for (std::ofstream& outf : m_OutputFiles)
 	{
-		// This creates all necessary directories in this structure
-		// If the directory already exists, it does nothing
-		std::filesystem::create_directories(filename.substr(0, pos));
+		if (outf.is_open())
+			outf.close();
 	}
+}
 
-	// Open the file, effectively overwriting the file
-	std::ofstream outf{ filename, std::ios::out | std::ios::trunc};
+void GeodesicOutputHandler::WriteBinaryHeader(std::ostream& outf, int diagnr) const
+{
+	// write the header (see InputOutput.h)
+	auto WriteUInt32 = [&outf](std::uint32_t val) { outf.write(reinterpret_cast<const char*>(&val), sizeof(val)); };
+	auto WriteString = [&outf, &WriteUInt32](const std::string& str)
+	{
+		WriteUInt32(static_cast<std::uint32_t>(str.size()));
+		outf.write(str.data(), str.size());
+	};
+
+	outf.write(BinaryOutputMagic, 8);
+	WriteUInt32(BinaryOutputVersion);
+	WriteUInt32(static_cast<std::uint32_t>(ScreenIndex{}.size()));
+	WriteString(m_DiagNames[diagnr]);
+	WriteString(m_FirstLineInfoString);
+}
+
+void GeodesicOutputHandler::ReopenFiles(const std::vector<std::uint64_t>& filesizes)
+{
+	// The file number we are reopening (starting from 1)
+	const unsigned short filenr{ static_cast<unsigned short>(m_CurrentFullFiles + 1) };
 
-	if (!outf) // Trigger writing to console if failed to open file
+	// In memory-mapped mode, we map the files again (with the size they had when the checkpoint was written)
+	if (IsMappedOutput())
 	{
-		ScreenOutput("Output file error! Could not open " + filename
-			+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
-		m_WriteToConsole = true;
+		CloseMappedFiles();
+		m_MappedFiles.assign(1, std::vector<MappedFile>(m_DiagNames.size()));
+		for (int diagnr = 0; diagnr < static_cast<int>(m_DiagNames.size()); ++diagnr)
+		{
+			const std::string filename{ GetFileName(diagnr, filenr) };
+			if (!MapFile(m_MappedFiles[0][diagnr], filename, static_cast<std::size_t>(filesizes[diagnr])))
+			{
+				ScreenOutput("Output file error! Could not reopen " + filename
+					+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+				m_WriteToConsole = true;
+				CloseMappedFiles();
+				return;
+			}
+		}
+		return;
 	}
-	else
+
+	m_OutputFiles.resize(m_DiagNames.size());
+	m_OutputFileBuffers.resize(m_DiagNames.size());
+
+	for (int diagnr = 0; diagnr < static_cast<int>(m_DiagNames.size()); ++diagnr)
 	{
-		// write first line info in the file; it is then prepared for geodesic output
-		if (m_PrintFirstLineInfo)
-			outf << m_FirstLineInfoString << "\n";
+		const std::string filename{ GetFileName(diagnr, filenr) };
+		std::ofstream& outf{ m_OutputFiles[diagnr] };
+
+		if (outf.is_open())
+			outf.close();
+		outf.clear();
+
+		// Anything written to the file after the checkpoint was saved will be written again, so we throw it away
+		std::error_code ec{};
+		std::filesystem::resize_file(filename, filesizes[diagnr], ec);
 
-		// Close the file
-		outf.close();
+		m_OutputFileBuffers[diagnr].resize(OutputFileBufferSize);
+		outf.rdbuf()->pubsetbuf(m_OutputFileBuffers[diagnr].data(), OutputFileBufferSize);
+
+		// Open the file for appending (the header or first line is already in there)
+		if (!ec)
+			outf.open(filename, std::ios::out | std::ios::app
+				| (m_Format == OutputFormat::Binary ? std::ios::binary : std::ios::openmode{}));
+
+		if (ec || !outf) // Trigger writing to console if failed to open file
+		{
+			ScreenOutput("Output file error! Could not reopen " + filename
+				+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+			m_WriteToConsole = true;
+			CloseFiles();
+			return;
+		}
 	}
-}
\ No newline at end of file
+}
+
+
+/// <summary>
+/// GeodesicOutputHandler functions: memory-mapped output
+/// </summary>
+
+std::vector<std::uint32_t> GeodesicOutputHandler::CheckMappedValueCounts([[maybe_unused]] const std::vector<int>& valuecounts,
+	[[maybe_unused]] OutputFormat format, [[maybe_unused]] const std::vector<std::string>& diagnames)
+{
+#ifndef FOORT_MAPPED_OUTPUT
+	ScreenOutput("Memory-mapped output files are not supported on this platform. Using normal output.",
+		OutputLevel::Level_0_WARNING);
+	return {};
+#else
+	if (format != OutputFormat::Binary)
+	{
+		ScreenOutput("Memory-mapped output files are only possible with binary output. Using normal output.",
+			OutputLevel::Level_0_WARNING);
+		return {};
+	}
+	if (valuecounts.size() != diagnames.size())
+	{
+		ScreenOutput("Memory-mapped output: the number of values is not given for every Diagnostic. Using normal output.",
+			OutputLevel::Level_0_WARNING);
+		return {};
+	}
+
+	std::vector<std::uint32_t> thecounts{};
+	for (std::size_t diagnr = 0; diagnr < valuecounts.size(); ++diagnr)
+	{
+		// Every record of a file must have the same size
+		if (valuecounts[diagnr] < 0)
+		{
+			ScreenOutput("Memory-mapped output files are not possible with the Diagnostic " + diagnames[diagnr]
+				+ ", which does not always output the same number of values. Using normal output.", OutputLevel::Level_0_WARNING);
+			return {};
+		}
+		thecounts.push_back(static_cast<std::uint32_t>(valuecounts[diagnr]));
+	}
+	return thecounts;
+#endif
+}
+
+bool GeodesicOutputHandler::IsMappedOutput() const
+{
+	return !m_MappedValueCounts.empty() && !m_WriteToConsole;
+}
+
+std::size_t GeodesicOutputHandler::getBinaryHeaderSize(int diagnr) const
+{
+	// See WriteBinaryHeader()
+	return 8 + 3 * sizeof(std::uint32_t) + m_DiagNames[diagnr].size() + sizeof(std::uint32_t) + m_FirstLineInfoString.size();
+}
+
+std::size_t GeodesicOutputHandler::getMappedRecordSize(int diagnr) const
+{
+	// Screen index, number of values, values (see InputOutput.h)
+	return ScreenIndex{}.size() * sizeof(std::uint64_t) + sizeof(std::uint32_t) + m_MappedValueCounts[diagnr] * sizeof(double);
+}
+
+void GeodesicOutputHandler::PrepareMappedFiles(largecounter nrOutputToCome)
+{
+	// The output of the previous iteration has all arrived
+	FinishMappedOutput();
+	m_MappedPending = nrOutputToCome;
+	if (nrOutputToCome == 0)
+		return;
+
+	const int nrdiags{ static_cast<int>(m_DiagNames.size()) };
+
+	// The outputs go to the positions m_CurrentGeodesicsInFile, ..., lastpos - 1 (counted from the start of the current file),
+	// spread over this many files
+	const largecounter lastpos{ m_CurrentGeodesicsInFile + nrOutputToCome };
+	const largecounter nrfiles{ (lastpos - 1) / m_nrGeodesicsPerFile + 1 };
+	if (m_MappedFiles.size() < nrfiles)
+		m_MappedFiles.resize(nrfiles, std::vector<MappedFile>(nrdiags));
+
+	for (largecounter k = 0; k < nrfiles; ++k)
+	{
+		const unsigned short filenr{ static_cast<unsigned short>(m_CurrentFullFiles + 1 + k) };
+		// The number of records that this file will contain after this iteration
+		const largecounter nrrecords{ std::min(m_nrGeodesicsPerFile, lastpos - k * m_nrGeodesicsPerFile) };
+
+		for (int diagnr = 0; diagnr < nrdiags; ++diagnr)
+		{
+			MappedFile& mapped{ m_MappedFiles[k][diagnr] };
+			const std::string filename{ GetFileName(diagnr, filenr) };
+
+			// A new file: create it (as in OpenNextFiles()) with its header
+			if (mapped.Descriptor < 0)
+			{
+				auto pos = filename.find_last_of("/");
+				if (pos != std::string::npos)
+					std::filesystem::create_directories(filename.substr(0, pos));
+				std::ofstream outf{ filename, std::ios::out | std::ios::trunc | std::ios::binary };
+				WriteBinaryHeader(outf, diagnr);
+				if (!outf)
+				{
+					ScreenOutput("Output file error! Could not open " + filename
+						+ ". Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+					m_WriteToConsole = true;
+					CloseMappedFiles();
+					return;
+				}
+			}
+
+			// Make room for all records in the file
+			const std::size_t filesize{ getBinaryHeaderSize(diagnr) + nrrecords * getMappedRecordSize(diagnr) };
+			if (mapped.Size != filesize && !MapFile(mapped, filename, filesize))
+			{
+				ScreenOutput("Output file error! Could not map " + filename
+					+ " into memory. Will write rest of output to console.", OutputLevel::Level_0_WARNING);
+				m_WriteToConsole = true;
+				CloseMappedFiles();
+				return;
+			}
+		}
+	}
+}
+
+void GeodesicOutputHandler::FinishMappedOutput()
+{
+	// All outputs of the current iteration are in the files now
+	m_CurrentGeodesicsInFile += m_MappedPending;
+	m_MappedPending = 0;
+
+	// Close the files that are full (the next output goes to the next file)
+	while (m_CurrentGeodesicsInFile >= m_nrGeodesicsPerFile)
+	{
+		if (!m_MappedFiles.empty())
+		{
+			for (MappedFile& mapped : m_MappedFiles.front())
+				CloseMappedFile(mapped);
+			m_MappedFiles.erase(m_MappedFiles.begin());
+		}
+		++m_CurrentFullFiles;
+		m_CurrentGeodesicsInFile -= m_nrGeodesicsPerFile;
+	}
+}
+
+void GeodesicOutputHandler::WriteGeodesicMapped(largecounter index, const GeodesicOutputRecord& theOutput)
+{
+	// NOTE: this must be thread-safe! Every geodesic has its own record in the files, and the files are not
+	// remapped while output is arriving (see PrepareForOutput())
+	const largecounter pos{ m_CurrentGeodesicsInFile + index };
+	std::vector<MappedFile>& files{ m_MappedFiles[pos / m_nrGeodesicsPerFile] };
+	const largecounter recordnr{ pos % m_nrGeodesicsPerFile };
+
+	size_t start{ 0 };
+	for (int diagnr = 0; diagnr < static_cast<int>(files.size()); ++diagnr)
+	{
+		char* record{ files[diagnr].Data + getBinaryHeaderSize(diagnr) + recordnr * getMappedRecordSize(diagnr) };
+
+		// Record: screen index, number of values, values (as in WriteGeodesicBinary())
+		for (largecounter k : theOutput.Index)
+		{
+			const std::uint64_t scrindex{ k };
+			std::memcpy(record, &scrindex, sizeof(scrindex));
+			record += sizeof(scrindex);
+		}
+		const std::uint32_t nrvalues{ m_MappedValueCounts[diagnr] };
+		std::memcpy(record, &nrvalues, sizeof(nrvalues));
+		record += sizeof(nrvalues);
+
+		// The record has room for exactly nrvalues values; if the Diagnostic output a different number,
+		// the rest is set to zero (or the extra values are left out)
+		const size_t nroutput{ static_cast<size_t>(theOutput.Values[start]) };
+		if (nroutput != nrvalues)
+		{
+			std::call_once(m_MappedCountWarning, [&]()
+				{
+					ScreenOutput("Diagnostic " + m_DiagNames[diagnr] + " output " + std::to_string(nroutput) + " values instead of "
+						+ std::to_string(nrvalues) + "! (This is only reported once.)", OutputLevel::Level_0_WARNING);
+				});
+		}
+		for (std::uint32_t i = 0; i < nrvalues; ++i)
+		{
+			const double val{ i < nroutput ? static_cast<double>(theOutput.Values[start + 1 + i]) : 0.0 };
+			std::memcpy(record, &val, sizeof(val));
+			record += sizeof(val);
+		}
+		start += 1 + nroutput;
+	}
+}
+
+bool GeodesicOutputHandler::MapFile([[maybe_unused]] MappedFile& theFile, [[maybe_unused]] const std::string& filename,
+	[[maybe_unused]] std::size_t size)
+{
+#ifdef FOORT_MAPPED_OUTPUT
+	if (theFile.Descriptor < 0)
+	{
+		theFile.Descriptor = open(filename.c_str(), O_RDWR);
+		if (theFile.Descriptor < 0)
+			return false;
+	}
+
+	// The previous mapping (if any) is too small, so we map the file again after resizing it
+	if (theFile.Data != nullptr)
+		munmap(theFile.Data, theFile.Size);
+	theFile.Data = nullptr;
+	theFile.Size = 0;
+
+	if (ftruncate(theFile.Descriptor, static_cast<off_t>(size)) != 0)
+		return false;
+	void* data{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, theFile.Descriptor, 0) };
+	if (data == MAP_FAILED)
+		return false;
+	theFile.Data = static_cast<char*>(data);
+	theFile.Size = size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GeodesicOutputHandler::CloseMappedFile(MappedFile& theFile)
+{
+#ifdef FOORT_MAPPED_OUTPUT
+	// (the operating system writes the mapped memory to the file, also after it is unmapped)
+	if (theFile.Data != nullptr)
+		munmap(theFile.Data, theFile.Size);
+	if (theFile.Descriptor >= 0)
+		close(theFile.Descriptor);
+#endif
+	theFile = MappedFile{};
+}
+
+void GeodesicOutputHandler::CloseMappedFiles()
+{
+	for (auto& files : m_MappedFiles)
+	{
+		for (MappedFile& mapped : files)
+			CloseMappedFile(mapped);
+	}
+	m_MappedFiles.clear();
+}
+
+
+/// <summary>
+/// GeodesicOutputRecord functions
+/// </summary>
+
+void GeodesicOutputRecord::Clear()
+{
+	// clear() keeps the memory of the containers
+	Text.clear();
+	TextEnds.clear();
+	Values.clear();
+}
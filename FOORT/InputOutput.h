@@ -14,6 +14,11 @@
 #include <fstream> // needed for file ouput
 #include <string> // std::string used in various places
 #include <vector> // needed to create vectors of strings
+#include <cstdint> // fixed-width integers for binary output
+#include <thread> // background writer thread (streaming output)
+#include <mutex> // std::mutex, std::unique_lock (streaming output), std::once_flag (memory-mapped output)
+#include <condition_variable> // std::condition_variable (streaming output)
+#include <type_traits> // std::is_trivially_copyable_v (checkpoint files)
 
 
 //////////////////////
@@ -42,13 +47,121 @@ void SetLoopMessageFrequency(largecounter thefreq);
 largecounter GetLoopMessageFrequency();
 
 
+//////////////////////////
+//// CHECKPOINT FILES ////
+// Helper functions to write the state of objects to a (binary) checkpoint file and read it back in
+// (see Utilities::SaveCheckpoint() and Utilities::LoadCheckpoint()).
+// All numbers are written in native byte order; checkpoints are only meant to be read on the machine that wrote them.
+// The Read functions return false if the stream has run out of data (or has another error).
+namespace Checkpoint
+{
+	// A single trivially copyable value
+	template<typename T>
+	void Write(std::ostream& out, const T& val)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written to a checkpoint.");
+		out.write(reinterpret_cast<const char*>(&val), sizeof(T));
+	}
+	template<typename T>
+	bool Read(std::istream& in, T& val)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read from a checkpoint.");
+		in.read(reinterpret_cast<char*>(&val), sizeof(T));
+		return static_cast<bool>(in);
+	}
+
+	// A vector of trivially copyable values (preceded by its size)
+	template<typename T>
+	void WriteVector(std::ostream& out, const std::vector<T>& vec)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written to a checkpoint.");
+		Write(out, static_cast<std::uint64_t>(vec.size()));
+		out.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+	}
+	template<typename T>
+	bool ReadVector(std::istream& in, std::vector<T>& vec)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read from a checkpoint.");
+		std::uint64_t size{};
+		if (!Read(in, size))
+			return false;
+		vec.resize(size);
+		in.read(reinterpret_cast<char*>(vec.data()), size * sizeof(T));
+		return static_cast<bool>(in);
+	}
+
+	// A string (preceded by its length)
+	inline void WriteString(std::ostream& out, const std::string& str)
+	{
+		Write(out, static_cast<std::uint64_t>(str.size()));
+		out.write(str.data(), str.size());
+	}
+	inline bool ReadString(std::istream& in, std::string& str)
+	{
+		std::uint64_t size{};
+		if (!Read(in, size))
+			return false;
+		str.resize(size);
+		in.read(str.data(), size);
+		return static_cast<bool>(in);
+	}
+}
+
+
 /////////////////////
 //// FILE OUTPUT ////
 // GeodesicOutputHandler declaration
 
+// The format of the output files
+enum class OutputFormat
+{
+	Text,	// Every line is "(screen index) (output string of the Diagnostic)"; first line is (optionally) the run information
+	Binary	// Binary file: a header followed by fixed-width records (see below)
+};
+
+// Layout of BINARY output files (all numbers in native byte order, i.e. little-endian on all usual platforms):
+// Header:
+//		8 bytes "FOORTBIN"; uint32 version (=1); uint32 number of screen index components (k);
+//		uint32 length of Diagnostic name, followed by the Diagnostic name (no terminating 0);
+//		uint32 length of run information string, followed by this string (the first line info; can be empty)
+// Then one record for every geodesic:
+//		k uint64's (the screen index); uint32 n (number of values); n doubles (the values)
+// For most Diagnostics, n is the same for every geodesic, so that the records all have the same width.
+// See Output/read_binary_output.py for a reader.
+inline constexpr char BinaryOutputMagic[]{ "FOORTBIN" };
+inline constexpr std::uint32_t BinaryOutputVersion{ 1 };
+
+// The output of a single Geodesic, as it is passed to the GeodesicOutputHandler (see Geodesic::WriteAllOutput()).
+// A record is meant to be reused for every geodesic (e.g. one record per thread): filling it in again reuses its memory,
+// so that passing on the output of a geodesic does not allocate memory once the record has grown to its working size.
+struct GeodesicOutputRecord
+{
+	// The screen index of the Geodesic
+	ScreenIndex Index{};
+	// Text output: the output strings of all Diagnostics, one after the other; the string of Diagnostic nr. d
+	// ends at position TextEnds[d] in Text (and starts where the string of the previous Diagnostic ends)
+	std::string Text{};
+	std::vector<std::size_t> TextEnds{};
+	// Numerical output (for binary output): for every Diagnostic, the number of values followed by the values
+	std::vector<real> Values{};
+
+	// Empties the record (keeping its memory)
+	void Clear();
+};
+
 // GeodesicOutputHandler handles all of the output to file.
 // It gets passed all of the output strings for every Geodesic, it then
-// stores this data until it eventually writes all data to the appropriate files
+// stores this data until it eventually writes all data to the appropriate files.
+// In streaming mode, the output of every Geodesic is instead put in a (bounded) buffer as soon as it arrives,
+// and a background writer thread writes it to file while the integration continues;
+// if the buffer is full, the integrating threads wait until the writer has caught up.
+// Note that in streaming mode, geodesics are written in the order in which they finish
+// (each line or record always contains the screen index).
+// In memory-mapped mode (binary output only, POSIX systems only), every output file is created with room for
+// the records of all geodesics of the current iteration and mapped into memory; the output of every Geodesic is then
+// written directly into its own record, without caching or streaming it. This requires that every Diagnostic
+// outputs the same number of values for every geodesic (see Diagnostic::getFullDataValCount()), so that all records
+// of a file have the same size. The files are written in the order of the geodesic indices.
 class GeodesicOutputHandler
 {
 public:
@@ -63,17 +176,32 @@ public:
 		largecounter nroutputstocache = LARGECOUNTER_MAX-1, // note -1,
 										// since we will actually cache one more then this number before outputting everything
 		largecounter geodperfile = LARGECOUNTER_MAX,
-		std::string firstlineinfo="");
+		std::string firstlineinfo="",
+		OutputFormat format = OutputFormat::Text,
+		largecounter streambuffersize = 0, // if > 0, use streaming mode with a buffer of this many geodesic outputs
+		std::vector<int> mappedvaluecounts = {}); // if not empty, use memory-mapped mode (overriding streaming mode);
+									// these are the numbers of values of each Diagnostic (see Utilities::GetDiagFullDataValCounts())
+
+	// Destructor makes sure the writer thread (if any) is finished
+	~GeodesicOutputHandler();
+
+	// Since there is a thread and a mutex involved, no copying
+	GeodesicOutputHandler(const GeodesicOutputHandler&) = delete;
+	GeodesicOutputHandler& operator=(const GeodesicOutputHandler&) = delete;
 
 	// This tells the OutputHandler to prepare for this many geodesic outputs to arrive;
 	// the internal state needs to be prepared such that they can come in without providing a data race
 	void PrepareForOutput(largecounter nrOutputToCome);
 
-	// A new vector of output strings from a (single) Geodesic;
-	// the length of the vector should be m_DiagNames.size()+1, since the first entry
-	// is the screen index
-	// NOTE: this procedure needs to be thread-safe!
-	void NewGeodesicOutput(largecounter index, std::vector<std::string> theOutput);
+	// The output of a (single) Geodesic, for all m_DiagNames.size() Diagnostics: the record must contain the text output
+	// for text output, and the numerical output for binary output (see IsBinaryOutput()).
+	// The output is copied, so that the record can be reused right away.
+	// NOTE: this procedure needs to be thread-safe! It must be called from (one of the threads of) the parallel region
+	// in which PrepareForOutput() was called, or outside of any parallel region
+	void NewGeodesicOutput(largecounter index, const GeodesicOutputRecord& theOutput);
+
+	// Should the records passed to NewGeodesicOutput() contain the numerical output (true) or the text output (false)?
+	bool IsBinaryOutput() const;
 
 	// Calling this indicates that there is no further output to be expected;
 	// this means we will write all remaining cached output to file
@@ -82,24 +210,78 @@ public:
 	// Returns full description string of output handler
 	std::string getFullDescriptionStr() const;
 
+	// Includes the output of a previous run in the output of this run (e.g. when refining the grid of the previous run,
+	// see SimpleSquareMesh), as if these geodesics had just been integrated. The previous output files must be
+	// in the same format and have the same Diagnostics and file extension; previousoutput is their file name up to
+	// the Diagnostic name (i.e. "FilePrefix" or "FilePrefix_TimeStamp"). The screen indices of the previous
+	// geodesics are multiplied by indexscale. Returns the number of geodesics included.
+	// Note: must be called before any other output has arrived
+	largecounter IncludePreviousOutput(const std::string& previousoutput, largecounter indexscale);
+
+	// Checkpointing (see Utilities::SaveCheckpoint()): writes all output received so far to file, and then writes the state
+	// of the output files to the (binary) stream, so that a resumed run can continue writing to the same files.
+	// Note: must be called between iterations, when no output is arriving
+	void SaveCheckpoint(std::ostream& out);
+	// Restores this state: the current output files are truncated to the size they had when the checkpoint was written,
+	// and are reopened so that new output is appended to them. Returns false if this failed.
+	// Note: must be called before any output has arrived
+	bool LoadCheckpoint(std::istream& in);
+
 private:
 	// Helper function: write everything that is cached to file now (clear the cache)
 	void WriteCachedOutputToFile();
 
-	// Helper function: open the file with name filename for the first time, preparing it to write
-	// This will effectively clear this file of any pre-existing content.
-	void OpenForFirstTime(const std::string& filename);
+	// Helper function: open the next output file (nr m_CurrentFullFiles+1) for every Diagnostic, preparing it to write.
+	// This will effectively clear these files of any pre-existing content. The files are kept open (in m_OutputFiles)
+	// until they are full, so that every flush of cached output does not need to reopen them.
+	void OpenNextFiles();
+	// Helper function: reopen the current output files (nr m_CurrentFullFiles+1) after resuming from a checkpoint,
+	// first truncating them to the given sizes (in bytes); new output is appended to them
+	void ReopenFiles(const std::vector<std::uint64_t>& filesizes);
+	// Helper function: close all currently open output files
+	void CloseFiles();
+	// Helper function: write the header of a binary output file for the Diagnostic diagnr (see above)
+	void WriteBinaryHeader(std::ostream& outf, int diagnr) const;
+
+	// A view of the output of a single geodesic, which is stored either in a GeodesicOutputRecord or in an arena
+	// (see below); the pointers point to the start of the geodesic's output (Text and TextEnds are only used for text
+	// output, Values only for binary output)
+	struct RecordView
+	{
+		ScreenIndex Index{};
+		const char* Text{};
+		const std::size_t* TextEnds{};
+		const real* Values{};
+	};
+	// Helper functions: the view of a record, and of the cached geodesic nr j
+	static RecordView getRecordView(const GeodesicOutputRecord& theOutput);
+	RecordView getCachedRecordView(largecounter j) const;
+
+	// Helper functions: write the output of the Diagnostic diagnr of a single geodesic to the (open) file
+	static void WriteGeodesicText(std::ofstream& outf, const RecordView& theOutput, int diagnr);
+	static void WriteGeodesicBinary(std::ofstream& outf, const RecordView& theOutput, int diagnr);
+	// Helper function: write the output of a single geodesic to the console
+	void WriteGeodesicToConsole(const RecordView& theOutput) const;
+	// Helper function: the screen index as a string (as written in text output files)
+	static std::string ScreenIndexToString(const ScreenIndex& theIndex);
+
+	// Helper function: the number of geodesic outputs currently cached
+	largecounter getNrCached() const;
 
 	// Helper function: return the full file name for the n-th output file
 	// for the Diagnostic diagnr (this is an entry in m_DiagNames)
 	std::string GetFileName(int diagnr, unsigned short filenr) const;
 
-	// The const strings that are used to construct the output file names
+	// The strings that are used to construct the output file names
+	// (the time stamp is not const, since a resumed run continues writing to the files of the original run)
 	const std::string m_FilePrefix;
-	const std::string m_TimeStamp;
+	std::string m_TimeStamp;
 	const std::string m_FileExtension;
 	const std::vector<std::string> m_DiagNames;
 
+	// Text or binary files
+	const OutputFormat m_Format;
+
 	// const variables that control whether we write a descriptive first line in
 	// every output file or not, and what that first line is
 	const bool m_PrintFirstLineInfo;
@@ -126,10 +308,118 @@ private:
 	// (We had better not have more than 60k files!)
 	unsigned short m_CurrentFullFiles{ 0 };
 
+	// The currently open output file for every Diagnostic (the files nr m_CurrentFullFiles+1),
+	// together with a large buffer for each of these file streams
+	// (so that writing a single geodesic's output does not go to the OS every time)
+	// NOTE: the buffers are declared first so that they outlive the file streams using them
+	static constexpr std::size_t OutputFileBufferSize{ 1 << 20 };
+	std::vector<std::vector<char>> m_OutputFileBuffers{};
+	std::vector<std::ofstream> m_OutputFiles{};
+
 	// Cached data that has not been written to a file yet
 	// (once this hits a size of > m_nrOutputsToCache,
-	// this must be written to file(s))
-	std::vector<std::vector<std::string>> m_AllCachedData{};
+	// this must be written to file(s)).
+	// The output itself is stored in per-thread arenas: every thread appends the output of the geodesics it passes on
+	// to its own arena, so that no locking is needed. Since the arenas (and m_AllCachedRecords) keep their memory when
+	// the cache is written to file, caching output does not allocate memory once the cache has grown to its working size
+	struct OutputArena
+	{
+		std::string Text{};
+		std::vector<std::size_t> TextEnds{};
+		std::vector<real> Values{};
+	};
+	std::vector<OutputArena> m_Arenas{};
+
+	// For every cached geodesic: its screen index, and where its output is stored
+	// (the arena, and the positions of its output in the three parts of that arena)
+	struct CachedRecord
+	{
+		ScreenIndex Index{};
+		std::size_t Arena{};
+		std::size_t TextStart{};
+		std::size_t TextEndsStart{};
+		std::size_t ValuesStart{};
+	};
+	std::vector<CachedRecord> m_AllCachedRecords{};
+
+
+	//// Memory-mapped mode ////
+
+	// Helper function: check that memory-mapped output is possible with the given numbers of values of the Diagnostics;
+	// returns these numbers if it is, and an empty vector (after a warning) if it is not
+	static std::vector<std::uint32_t> CheckMappedValueCounts(const std::vector<int>& valuecounts, OutputFormat format,
+		const std::vector<std::string>& diagnames);
+
+	// The number of values that every Diagnostic outputs for every geodesic (empty: not in memory-mapped mode)
+	const std::vector<std::uint32_t> m_MappedValueCounts;
+
+	// An output file that is mapped into memory: its file descriptor, and the memory it is mapped to
+	// (the whole file, of Size bytes)
+	struct MappedFile
+	{
+		int Descriptor{ -1 };
+		char* Data{ nullptr };
+		std::size_t Size{ 0 };
+	};
+	// The mapped files: m_MappedFiles[k][diagnr] is the file nr. m_CurrentFullFiles+1+k of the Diagnostic diagnr
+	// (the output of a single iteration can be spread over several files)
+	std::vector<std::vector<MappedFile>> m_MappedFiles{};
+	// The number of geodesic outputs of the current iteration (starting at position m_CurrentGeodesicsInFile
+	// in the current file), for which room has been made in the mapped files
+	largecounter m_MappedPending{ 0 };
+	// A Diagnostic that outputs a different number of values than promised in m_MappedValueCounts is only reported
+	// once (WriteGeodesicMapped() is called from all threads, for every geodesic)
+	std::once_flag m_MappedCountWarning{};
+
+	// Helper function: are we (still) writing memory-mapped output?
+	// (after a file error, output is written to console through the cache instead)
+	bool IsMappedOutput() const;
+	// Helper function: makes sure the mapped files have room for the next nrOutputToCome geodesic outputs
+	void PrepareMappedFiles(largecounter nrOutputToCome);
+	// Helper function: the outputs of the current iteration are done; closes the files that are full now
+	void FinishMappedOutput();
+	// Helper function: write the output of a single geodesic to its record in the mapped files; thread-safe
+	void WriteGeodesicMapped(largecounter index, const GeodesicOutputRecord& theOutput);
+	// Helper function: (re)map the file (which is opened first if needed) after resizing it to size bytes;
+	// returns false if this failed
+	static bool MapFile(MappedFile& theFile, const std::string& filename, std::size_t size);
+	// Helper functions: unmap and close a mapped file, and all mapped files
+	static void CloseMappedFile(MappedFile& theFile);
+	void CloseMappedFiles();
+	// Helper functions: the size (in bytes) of the header, and of a single record, of the files of Diagnostic diagnr
+	std::size_t getBinaryHeaderSize(int diagnr) const;
+	std::size_t getMappedRecordSize(int diagnr) const;
+
+
+	//// Streaming mode ////
+
+	// Size of the (ring) buffer of outputs that are waiting to be written (0: not streaming)
+	const largecounter m_StreamBufferSize;
+
+	// The ring buffer, with the position of the oldest output and the number of outputs currently in the buffer.
+	// (The records in the buffer are exchanged with those of the writer thread, so that they all keep their memory)
+	std::vector<GeodesicOutputRecord> m_StreamBuffer{};
+	largecounter m_StreamFirst{ 0 };
+	largecounter m_StreamCount{ 0 };
+	// Set to true when no more output will arrive (the writer thread then finishes)
+	bool m_StreamFinished{ false };
+	// True while the writer thread is writing outputs that it has taken out of the buffer
+	bool m_StreamWriting{ false };
+
+	// Protects the ring buffer; the writer thread waits on m_StreamNotEmpty, integrating threads on m_StreamNotFull
+	// (as does SaveCheckpoint(), waiting for the writer thread to have written everything)
+	std::mutex m_StreamMutex{};
+	std::condition_variable m_StreamNotEmpty{};
+	std::condition_variable m_StreamNotFull{};
+
+	// The background writer thread
+	std::thread m_WriterThread{};
+
+	// Helper function: puts an output in the buffer (waiting if the buffer is full); thread-safe
+	void StreamOutput(const GeodesicOutputRecord& theOutput);
+
+	// The function run by the writer thread: writes outputs to file as they come in, until m_StreamFinished
+	void WriterThreadLoop();
 };
 
 #endif
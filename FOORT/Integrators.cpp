@@ -1,9 +1,11 @@
 #include "Integrators.h" // We are defining functions declared here
 
 #include "Geodesic.h" // Needed for Source member functions
+#include "InputOutput.h" // for ScreenOutput()
 
 #include <algorithm> // for std::min, std::max
 #include <cmath> // for std::abs
+#include <type_traits> // for std::is_same_v
 
 #include <sstream> // std::stringstream
 #include <iostream> // std::scientific 
@@ -25,6 +27,15 @@ std::string Integrators::GetFullIntegratorDescription()
 	{
 		fullintegratorstring += " (velocity tolerance: " + to_string_scientific(Integrators::VerletVelocityTolerance) + ")";
 	}
+	else if (Integrators::IntegratorDescription == "RK45")
+	{
+		fullintegratorstring += " (absolute tolerance: " + to_string_scientific(Integrators::RK45AbsoluteTolerance)
+			+ ", relative tolerance: " + to_string_scientific(Integrators::RK45RelativeTolerance) + ")";
+	}
+	if (Integrators::IntegrateInBatches)
+	{
+		fullintegratorstring += " (integrating batches of " + std::to_string(BatchSize) + " geodesics)";
+	}
 	return fullintegratorstring + ", basic step size: " + to_string_scientific(Integrators::epsilon)
 		+ ", min. step size: " + to_string_scientific(Integrators::SmallestPossibleStepsize)
 		+ ", derivative h: " + to_string_scientific(Integrators::Derivative_hval);
@@ -46,26 +57,51 @@ real Integrators::GetAdaptiveStep(Point curpos, OneIndex curvel)
 	return h;
 }
 
+// The rhs of the geodesic equation for the velocity is:
+// d/d\lambda(u^a) = - Gamma^a_{bc} u^b u^c + [Source(x,u)]^a;
+OneIndex Integrators::GeodesicEquationRHS(const Point& p, const OneIndex& v, const Metric* theMetric, const Source* theSource)
+{
+	// The Christoffel symbols are constructed from Metric::getMetricAndDerivatives(),
+	// which calculates the metric, its inverse and its derivatives all in one pass;
+	// the contraction only sums over the nonzero Christoffel symbols if the Metric has a known structure
+	return theSource->getSource(p, v) - theMetric->getChristoffelContraction(p, v);
+}
+
+// The rhs of the geodesic equation for a Metric of known type
+template<typename MetricType>
+OneIndex Integrators::GeodesicEquationRHSFor(const Point& p, const OneIndex& v, const Metric* theMetric, const Source* theSource)
+{
+	// All (non-batched) integrators evaluate the rhs through here, so this is where the evaluations are counted
+	if (CountWork)
+		++ThreadWorkCounters.RHSEvaluations;
+
+	if constexpr (std::is_same_v<MetricType, Metric>)
+		return GeodesicEquationRHS(p, v, theMetric, theSource);
+	else
+		return theSource->getSource(p, v)
+			- Metric::getChristoffelContractionStatic(*static_cast<const MetricType*>(theMetric), p, v);
+}
+
 // This is a GeodesicIntegratorFunc
 // Integrate the geodesic equation by one step using Runge-Kutta-4
 void Integrators::IntegrateGeodesicStep_RK4(Point curpos, OneIndex curvel,
 	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
+{
+	IntegrateGeodesicStep_RK4_For<Metric>(curpos, curvel, nextpos, nextvel, stepsize, theMetric, theSource);
+}
+
+// Runge-Kutta-4 step, evaluating the geodesic equation for a Metric of type MetricType
+template<typename MetricType>
+void Integrators::IntegrateGeodesicStep_RK4_For(Point curpos, OneIndex curvel,
+	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
 {
 	real h = GetAdaptiveStep(curpos, curvel);
 
 	//// Construct geodesic equation
-	// The rhs of the geodesic equation for the velocity is:
-	// d/d\lambda(u^a) = - Gamma^a_{bc} u^b u^c + [Source(x,u)]^a;
-	// This helper function computes the rhs of the geodesic equation
-	auto geoRHS = [theMetric, theSource](Point p, OneIndex v)->OneIndex
+	// This helper function computes the rhs of the geodesic equation (see GeodesicEquationRHSFor())
+	auto geoRHS = [theMetric, theSource](const Point& p, const OneIndex& v)->OneIndex
 	{
-		ThreeIndex christ{ theMetric->getChristoffel_udd(p) };
-		OneIndex ret{ theSource->getSource(p,v) };
-		for (int i = 0; i < dimension; ++i)
-			for (int j = 0; j < dimension; ++j)
-				for (int k = 0; k < dimension; ++k)
-					ret[i] -= christ[i][j][k] * v[j] * v[k];
-		return ret;
+		return GeodesicEquationRHSFor<MetricType>(p, v, theMetric, theSource);
 	};
 
 
@@ -94,26 +130,96 @@ void Integrators::IntegrateGeodesicStep_RK4(Point curpos, OneIndex curvel,
 }
 
 
+// Batched rhs of the geodesic equation
+BatchOneIndex Integrators::GeodesicEquationRHSBatch(const BatchPoint& p, const BatchOneIndex& v, const Metric* theMetric, const Source* theSource)
+{
+	BatchOneIndex ret{ theMetric->getChristoffelContractionBatch(p, v) };
+	for (int i = 0; i < BatchSize; ++i)
+	{
+		OneIndex source{ theSource->getSource(Point{ p[0][i], p[1][i], p[2][i], p[3][i] }, OneIndex{ v[0][i], v[1][i], v[2][i], v[3][i] }) };
+		for (int mu = 0; mu < dimension; ++mu)
+			ret[mu][i] = source[mu] - ret[mu][i];
+	}
+	return ret;
+}
+
+// This is a BatchGeodesicIntegratorFunc
+// Integrate the geodesic equation by one step using Runge-Kutta-4, for a whole batch of geodesics;
+// this is exactly the same algorithm as IntegrateGeodesicStep_RK4(), but every operation is done on the whole batch
+void Integrators::IntegrateGeodesicStep_RK4_Batch(const BatchPoint& curpos, const BatchOneIndex& curvel,
+	BatchPoint& nextpos, BatchOneIndex& nextvel, BatchReal& stepsize, const Metric* theMetric, const Source* theSource)
+{
+	// Every geodesic in the batch determines its own step size
+	BatchReal h;
+	for (int i = 0; i < BatchSize; ++i)
+		h[i] = GetAdaptiveStep(Point{ curpos[0][i], curpos[1][i], curpos[2][i], curpos[3][i] },
+			OneIndex{ curvel[0][i], curvel[1][i], curvel[2][i], curvel[3][i] });
+
+	// Helper function that returns x + factor * h * k (for all members of the batch)
+	auto AddStep = [&h](const BatchPoint& x, real factor, const BatchOneIndex& k)->BatchPoint
+	{
+		BatchPoint ret;
+		for (int mu = 0; mu < dimension; ++mu)
+		{
+#pragma omp simd
+			for (int i = 0; i < BatchSize; ++i)
+				ret[mu][i] = x[mu][i] + factor * h[i] * k[mu][i];
+		}
+		return ret;
+	};
+
+	//// Perform Runge-Kutta 4 algorithm
+
+	// RK step 1
+	BatchOneIndex k1{ GeodesicEquationRHSBatch(curpos, curvel, theMetric, theSource) };
+	const BatchPoint& l1{ curvel };
+
+	// RK step 2
+	BatchPoint l2{ AddStep(curvel, 0.5, k1) };
+	BatchOneIndex k2{ GeodesicEquationRHSBatch(AddStep(curpos, 0.5, l1), l2, theMetric, theSource) };
+
+	// RK step 3
+	BatchPoint l3{ AddStep(curvel, 0.5, k2) };
+	BatchOneIndex k3{ GeodesicEquationRHSBatch(AddStep(curpos, 0.5, l2), l3, theMetric, theSource) };
+
+	// RK step 4
+	BatchPoint l4{ AddStep(curvel, 1.0, k3) };
+	BatchOneIndex k4{ GeodesicEquationRHSBatch(AddStep(curpos, 1.0, l3), l4, theMetric, theSource) };
+
+	// RK totals give new step
+	for (int mu = 0; mu < dimension; ++mu)
+	{
+#pragma omp simd
+		for (int i = 0; i < BatchSize; ++i)
+		{
+			nextvel[mu][i] = curvel[mu][i] + h[i] / 6.0 * (k1[mu][i] + 2 * k2[mu][i] + 2 * k3[mu][i] + k4[mu][i]);
+			nextpos[mu][i] = curpos[mu][i] + h[i] / 6.0 * (l1[mu][i] + 2 * l2[mu][i] + 2 * l3[mu][i] + l4[mu][i]);
+		}
+	}
+	stepsize = h;
+}
+
+
 // This is a GeodesicIntegratorFunc
 // Integrate the geodesic equation by one step using velocity Verlet algorithm
 void Integrators::IntegrateGeodesicStep_Verlet(Point curpos, OneIndex curvel,
 	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
+{
+	IntegrateGeodesicStep_Verlet_For<Metric>(curpos, curvel, nextpos, nextvel, stepsize, theMetric, theSource);
+}
+
+// Velocity Verlet step, evaluating the geodesic equation for a Metric of type MetricType
+template<typename MetricType>
+void Integrators::IntegrateGeodesicStep_Verlet_For(Point curpos, OneIndex curvel,
+	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
 {
 	real h = GetAdaptiveStep(curpos, curvel);
 
 	//// Construct geodesic equation
-	// The rhs of the geodesic equation for the velocity is:
-	// d/d\lambda(u^a) = - Gamma^a_{bc} u^b u^c + [Source(x,u)]^a;
-	// This helper function computes the rhs of the geodesic equation
-	auto geoRHS = [theMetric, theSource](Point p, OneIndex v)->OneIndex
+	// This helper function computes the rhs of the geodesic equation (see GeodesicEquationRHSFor())
+	auto geoRHS = [theMetric, theSource](const Point& p, const OneIndex& v)->OneIndex
 	{
-		ThreeIndex christ{ theMetric->getChristoffel_udd(p) };
-		OneIndex ret{ theSource->getSource(p,v) };
-		for (int i = 0; i < dimension; ++i)
-			for (int j = 0; j < dimension; ++j)
-				for (int k = 0; k < dimension; ++k)
-					ret[i] -= christ[i][j][k] * v[j] * v[k];
-		return ret;
+		return GeodesicEquationRHSFor<MetricType>(p, v, theMetric, theSource);
 	};
 
 	// Cartesian norm (squared) of vector helper function
@@ -142,6 +248,8 @@ void Integrators::IntegrateGeodesicStep_Verlet(Point curpos, OneIndex curvel,
 	while (VerletVelocityTolerance > 0.0 
 		&& cartvecsq(nextvel - velintermed) / cartvecsq(nextvel) > VerletVelocityTolerance * VerletVelocityTolerance)
 	{
+		if (CountWork)
+			++ThreadWorkCounters.VerletIterations;
 		velintermed = nextvel;
 		accelstep = geoRHS(nextpos, velintermed);
 		nextvel = curvel + h / 2.0 * (accelcur + accelstep);
@@ -151,3 +259,186 @@ void Integrators::IntegrateGeodesicStep_Verlet(Point curpos, OneIndex curvel,
 	stepsize = h;
 }
 
+
+
+// This is a GeodesicIntegratorFunc
+// Integrate the geodesic equation by one step using the embedded Runge-Kutta-Dormand-Prince 5(4) pair
+// (see e.g. Hairer, Norsett & Wanner, Solving Ordinary Differential Equations I, section II.5 and II.4)
+void Integrators::IntegrateGeodesicStep_RK45(Point curpos, OneIndex curvel,
+	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
+{
+	IntegrateGeodesicStep_RK45_For<Metric>(curpos, curvel, nextpos, nextvel, stepsize, theMetric, theSource);
+}
+
+// Dormand-Prince 5(4) step, evaluating the geodesic equation for a Metric of type MetricType
+template<typename MetricType>
+void Integrators::IntegrateGeodesicStep_RK45_For(Point curpos, OneIndex curvel,
+	Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource)
+{
+	//// Butcher tableau of Dormand-Prince 5(4)
+	constexpr int nrstages = 7;
+	constexpr real a[nrstages][nrstages - 1]{
+		{},
+		{1.0 / 5},
+		{3.0 / 40, 9.0 / 40},
+		{44.0 / 45, -56.0 / 15, 32.0 / 9},
+		{19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+		{9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+		{35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84} };
+	// Note that the fifth-order solution coefficients are those of the last stage,
+	// so that the last stage is evaluated at the new point
+	// Difference between the fifth- and fourth-order solution coefficients (used for the error estimate)
+	constexpr real e[nrstages]{ 71.0 / 57600, 0.0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40 };
+
+	// Step size control parameters: safety factor, and maximal/minimal factor by which the step size may change
+	constexpr real safetyfactor = 0.9;
+	constexpr real maxfactor = 5.0;
+	constexpr real minfactor = 0.2;
+
+	//// Construct geodesic equation
+	// This helper function computes the rhs of the geodesic equation (see GeodesicEquationRHSFor())
+	auto geoRHS = [theMetric, theSource](const Point& p, const OneIndex& v)->OneIndex
+	{
+		return GeodesicEquationRHSFor<MetricType>(p, v, theMetric, theSource);
+	};
+
+	// Every thread integrates one geodesic at a time, so we remember (per thread) the state at the end of the last step.
+	// If this step starts where the last one ended (i.e. the same geodesic is continued), then we can reuse
+	// the rhs evaluation of the last stage of the last step (FSAL: "first same as last"),
+	// as well as the step size estimate for the next step. Otherwise, we start with the basic adaptive step size.
+	thread_local Point lastpos{};
+	thread_local OneIndex lastvel{};
+	thread_local OneIndex lastaccel{};
+	thread_local real laststep{ 0.0 };
+
+	real h{};
+	// The stages: velocities (rhs of position equation) and accelerations (rhs of velocity equation)
+	Point kpos[nrstages]{};
+	OneIndex kvel[nrstages]{};
+	kpos[0] = curvel;
+	if (laststep > 0.0 && curpos == lastpos && curvel == lastvel)
+	{
+		h = laststep;
+		kvel[0] = lastaccel;
+	}
+	else
+	{
+		h = GetAdaptiveStep(curpos, curvel);
+		kvel[0] = geoRHS(curpos, curvel);
+	}
+
+	// Keep trying steps until the error is acceptable
+	real errornorm{};
+	while (true)
+	{
+		// Stages 2 to 7; the last stage is evaluated at the new point
+		for (int s = 1; s < nrstages; ++s)
+		{
+			Point stagepos{ curpos };
+			OneIndex stagevel{ curvel };
+			for (int j = 0; j < s; ++j)
+			{
+				stagepos = stagepos + h * a[s][j] * kpos[j];
+				stagevel = stagevel + h * a[s][j] * kvel[j];
+			}
+			kpos[s] = stagevel;
+			kvel[s] = geoRHS(stagepos, stagevel);
+			// The last stage position and velocity are the fifth-order solution
+			if (s == nrstages - 1)
+			{
+				nextpos = stagepos;
+				nextvel = stagevel;
+			}
+		}
+
+		// Estimate the error (difference between fifth- and fourth-order solution),
+		// and its (root mean square) norm relative to the tolerances
+		Point errpos{};
+		OneIndex errvel{};
+		for (int s = 0; s < nrstages; ++s)
+		{
+			errpos = errpos + h * e[s] * kpos[s];
+			errvel = errvel + h * e[s] * kvel[s];
+		}
+		errornorm = 0.0;
+		for (int i = 0; i < dimension; ++i)
+		{
+			real scalepos = RK45AbsoluteTolerance + RK45RelativeTolerance * std::max(std::fabs(curpos[i]), std::fabs(nextpos[i]));
+			real scalevel = RK45AbsoluteTolerance + RK45RelativeTolerance * std::max(std::fabs(curvel[i]), std::fabs(nextvel[i]));
+			errornorm += (errpos[i] / scalepos) * (errpos[i] / scalepos) + (errvel[i] / scalevel) * (errvel[i] / scalevel);
+		}
+		errornorm = std::sqrt(errornorm / (2 * dimension));
+
+		// Accept the step if the error is small enough (or we cannot make the step any smaller)
+		if (errornorm <= 1.0 || h <= SmallestPossibleStepsize)
+			break;
+
+		// Step rejected: try again with a smaller step
+		// (note that errornorm can be NaN if we stepped into a coordinate singularity; then use the smallest factor)
+		if (CountWork)
+			++ThreadWorkCounters.RejectedSteps;
+		real factor = std::isfinite(errornorm) ? std::max(minfactor, safetyfactor * std::pow(errornorm, -1.0 / 5)) : minfactor;
+		h = std::max(h * std::min(factor, 1.0), SmallestPossibleStepsize);
+	}
+
+	// Step accepted; remember where we are and determine the step size for the next step
+	stepsize = h;
+	real factor = errornorm > 0.0 ? std::min(maxfactor, std::max(minfactor, safetyfactor * std::pow(errornorm, -1.0 / 5))) : maxfactor;
+	lastpos = nextpos;
+	lastvel = nextvel;
+	lastaccel = kvel[nrstages - 1];
+	laststep = std::max(h * factor, SmallestPossibleStepsize);
+}
+
+
+
+/// <summary>
+/// Metric-specialized integrators
+/// </summary>
+
+namespace
+{
+	// Helper type holding a list of Metric types
+	template<typename... MetricTypes>
+	struct MetricList {};
+
+	// The Metrics for which the integrators are specialized
+	// (every Metric listed here must also be listed in the explicit instantiations at the end of Metric.cpp)
+	using SpecializedMetrics = MetricList<KerrMetric, FlatSpaceMetric, RasheedLarsenMetric, JohannsenMetric, MankoNovikovMetric>;
+
+	// Returns the specialized version of theIntegrator for MetricType (or nullptr if there is none)
+	template<typename MetricType>
+	GeodesicIntegratorFunc SpecializeIntegratorFor(GeodesicIntegratorFunc theIntegrator)
+	{
+		if (theIntegrator == Integrators::IntegrateGeodesicStep_RK4)
+			return Integrators::IntegrateGeodesicStep_RK4_For<MetricType>;
+		if (theIntegrator == Integrators::IntegrateGeodesicStep_Verlet)
+			return Integrators::IntegrateGeodesicStep_Verlet_For<MetricType>;
+		if (theIntegrator == Integrators::IntegrateGeodesicStep_RK45)
+			return Integrators::IntegrateGeodesicStep_RK45_For<MetricType>;
+		return nullptr;
+	}
+
+	// Finds the type of theMetric among the MetricTypes and returns the specialized version of theIntegrator for it
+	// (or nullptr if there is none)
+	template<typename... MetricTypes>
+	GeodesicIntegratorFunc SpecializeIntegratorForAny(GeodesicIntegratorFunc theIntegrator, const Metric* theMetric,
+		MetricList<MetricTypes...>)
+	{
+		GeodesicIntegratorFunc specialized{ nullptr };
+		// Note: all Metric types are final, so that (at most) one of the dynamic_casts succeeds
+		((dynamic_cast<const MetricTypes*>(theMetric) ? (specialized = SpecializeIntegratorFor<MetricTypes>(theIntegrator), true) : false)
+			|| ...);
+		return specialized;
+	}
+}
+
+GeodesicIntegratorFunc Integrators::SpecializeIntegrator(GeodesicIntegratorFunc theIntegrator, const Metric* theMetric)
+{
+	GeodesicIntegratorFunc specialized{ SpecializeIntegratorForAny(theIntegrator, theMetric, SpecializedMetrics{}) };
+	if (!specialized)
+		return theIntegrator;
+
+	ScreenOutput("Using integrator specialized for the metric.", OutputLevel::Level_2_SUBPROC);
+	return specialized;
+}
@@ -24,6 +24,16 @@ class Source;
 // - pointers to: the Metric, the Source that are used to evaluate the geodesic equation
 using GeodesicIntegratorFunc = void (*)(Point, OneIndex, Point&, OneIndex&, real&, const Metric*, const Source*);
 
+// This is the structure of a function that integrates the geodesic equation one step for a whole batch of geodesics
+// at once (in lockstep), with the batch in structure-of-arrays layout (see Geometry.h).
+// It takes as arguments:
+// - current positions, current velocities of the batch
+// - references to: next positions, next velocities, affine parameter step sizes (which the functions sets)
+// - pointers to: the Metric, the Source that are used to evaluate the geodesic equation
+// Every member of the batch takes its own (adaptive) step size.
+using BatchGeodesicIntegratorFunc = void (*)(const BatchPoint&, const BatchOneIndex&, BatchPoint&, BatchOneIndex&, BatchReal&,
+	const Metric*, const Source*);
+
 // Namespace for integrator constants and functions
 namespace Integrators
 {
@@ -35,10 +45,29 @@ namespace Integrators
 
 	// The name of the integrator selected
 	inline std::string IntegratorDescription{ "RK4" };
+	// Are geodesics integrated in batches (using a BatchGeodesicIntegratorFunc)?
+	inline bool IntegrateInBatches{ false };
 
 	// Full descriptive string of integrator and all integrator options
 	std::string GetFullIntegratorDescription();
 
+	// Counters of the work done by the (non-batched) integrators, used by IntegrationCostDiagnostic to measure the cost
+	// of every geodesic. The counters are only incremented if CountWork is set (it is off by default, so that the
+	// integrators do not pay for the counting unless it is needed). Every thread keeps its own counters, and a thread
+	// integrates one geodesic at a time, so the work done for a geodesic is the difference of the counters
+	// of its thread at the start and at the end of its integration.
+	inline bool CountWork{ false };
+	struct WorkCounters
+	{
+		// Number of evaluations of the rhs of the geodesic equation
+		largecounter RHSEvaluations{ 0 };
+		// Number of corrector iterations of the Verlet integrator (beyond the first velocity estimate)
+		largecounter VerletIterations{ 0 };
+		// Number of steps rejected (and retaken with a smaller step size) by the RK45 integrator
+		largecounter RejectedSteps{ 0 };
+	};
+	inline thread_local WorkCounters ThreadWorkCounters{};
+
 
 	// This is the base step size to be taken (the integrator will adapt this if necessary)
 	inline real epsilon{ 0.03 };
@@ -49,10 +78,33 @@ namespace Integrators
 	// Function to get  (adaptive) step size
 	real GetAdaptiveStep(Point curpos, OneIndex curvel);
 
+	// The rhs of the geodesic equation for the velocity, d/d\lambda(u^a) = - Gamma^a_{bc} u^b u^c + [Source(x,u)]^a,
+	// which is used by all integrators (the Christoffel symbols come from Metric::getMetricAndDerivatives())
+	OneIndex GeodesicEquationRHS(const Point& p, const OneIndex& v, const Metric* theMetric, const Source* theSource);
+
+	// The same rhs, for a Metric of which the (final) type MetricType is known at compile time
+	// (theMetric MUST point to a MetricType), so that the Metric is evaluated without virtual calls.
+	// For MetricType = Metric, this is simply GeodesicEquationRHS()
+	template<typename MetricType>
+	OneIndex GeodesicEquationRHSFor(const Point& p, const OneIndex& v, const Metric* theMetric, const Source* theSource);
+
 	// This is a GeodesicIntegratorFunc
 	// Using the Runge-Kutta-4 algorithm to integrate the geodesic equation
 	void IntegrateGeodesicStep_RK4(Point curpos, OneIndex curvel,
 		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+	// The same, with the geodesic equation evaluated by GeodesicEquationRHSFor<MetricType>()
+	// (IntegrateGeodesicStep_RK4() is IntegrateGeodesicStep_RK4_For<Metric>())
+	template<typename MetricType>
+	void IntegrateGeodesicStep_RK4_For(Point curpos, OneIndex curvel,
+		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+
+	// Batched version of GeodesicEquationRHS() (using Metric::getChristoffelContractionBatch())
+	BatchOneIndex GeodesicEquationRHSBatch(const BatchPoint& p, const BatchOneIndex& v, const Metric* theMetric, const Source* theSource);
+
+	// This is a BatchGeodesicIntegratorFunc
+	// Using the Runge-Kutta-4 algorithm to integrate the geodesic equation for a batch of geodesics at once
+	void IntegrateGeodesicStep_RK4_Batch(const BatchPoint& curpos, const BatchOneIndex& curvel,
+		BatchPoint& nextpos, BatchOneIndex& nextvel, BatchReal& stepsize, const Metric* theMetric, const Source* theSource);
 
 	inline real VerletVelocityTolerance{ 0.001 };
 
@@ -60,6 +112,33 @@ namespace Integrators
 	// Using the velocity Verlet algorithm to integrate the geodesic equation
 	void IntegrateGeodesicStep_Verlet(Point curpos, OneIndex curvel,
 		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+	// The same, with the geodesic equation evaluated by GeodesicEquationRHSFor<MetricType>()
+	template<typename MetricType>
+	void IntegrateGeodesicStep_Verlet_For(Point curpos, OneIndex curvel,
+		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+
+	// The tolerances on the (estimated) local error of a step of the adaptive RK45 integrator;
+	// a step is accepted if the error in every component is (on average) below AbsTol + RelTol * |component|
+	inline real RK45AbsoluteTolerance{ 1e-8 };
+	inline real RK45RelativeTolerance{ 1e-8 };
+
+	// This is a GeodesicIntegratorFunc
+	// Using the embedded Runge-Kutta-Dormand-Prince 5(4) algorithm with local error control
+	// (steps are rejected and retaken if the error is too large; the step size adapts itself to the error estimate)
+	void IntegrateGeodesicStep_RK45(Point curpos, OneIndex curvel,
+		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+	// The same, with the geodesic equation evaluated by GeodesicEquationRHSFor<MetricType>()
+	template<typename MetricType>
+	void IntegrateGeodesicStep_RK45_For(Point curpos, OneIndex curvel,
+		Point& nextpos, OneIndex& nextvel, real& stepsize, const Metric* theMetric, const Source* theSource);
+
+	// Returns the version of the (generic) integrator theIntegrator that is specialized for the type of theMetric,
+	// i.e. IntegrateGeodesicStep_XXX_For<MetricType>, in which the whole evaluation of the geodesic equation
+	// (metric, Christoffel symbols and contraction) can be inlined. This is possible for the Metrics listed in
+	// SpecializedMetrics (see Integrators.cpp); otherwise (or for an unknown integrator), theIntegrator itself is returned.
+	// (The integrator description is the same for both versions, as they calculate exactly the same steps)
+	// The templated integrators are instantiated (in Integrators.cpp) only through this function.
+	GeodesicIntegratorFunc SpecializeIntegrator(GeodesicIntegratorFunc theIntegrator, const Metric* theMetric);
 }
 
 #endif
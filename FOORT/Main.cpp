@@ -50,12 +50,16 @@
 // This function is called if CONFIGURATION_MODE is NOT turned on.
 void LoadPrecompiledOptions(std::unique_ptr<Metric> &theM, std::unique_ptr<Source> &theS, DiagBitflag &AllDiags, DiagBitflag &ValDiag,
     TermBitflag &AllTerms, std::unique_ptr<ViewScreen> &theView, GeodesicIntegratorFunc &theIntegrator,
-    std::unique_ptr<GeodesicOutputHandler> & theOutputHandler)
+    BatchGeodesicIntegratorFunc &theBatchIntegrator, std::unique_ptr<Utilities::GeodesicScheduler> &theScheduler,
+    std::unique_ptr<GeodesicOutputHandler> & theOutputHandler, Utilities::CheckpointOptions &theCheckpointOptions)
 {
     //// Screen output level ////
     SetOutputLevel(OutputLevel::Level_4_DEBUG);
     // Frequency of messages during each integration loop
     SetLoopMessageFrequency(LARGECOUNTER_MAX);
+    // Precision of real numbers in the text output: number of decimals, or RealPrecision_Shortest
+    // for the shortest representation that is read back exactly
+    SetRealPrecision(6);
 
 
     ///// Metric ////
@@ -70,17 +74,18 @@ void LoadPrecompiledOptions(std::unique_ptr<Metric> &theM, std::unique_ptr<Sourc
 
 
     //// Diagnostics ////
-    // Flag possibilities: Diag_FourColorScreen, Diag_GeodesicPosition, Diag_EquatorialPasses
+    // Flag possibilities: Diag_FourColorScreen, Diag_GeodesicPosition, Diag_EquatorialPasses, Diag_ClosestRadius,
+    // Diag_IntegrationCost
     AllDiags = Diag_FourColorScreen | Diag_EquatorialPasses;
     ValDiag = Diag_EquatorialPasses;
 
 
     //// Diagnostic options (static member structs) ////
     // Syntax: UpdateFrequency{ largecounter updateEveryNSteps, bool UpdateOnStart, bool UpdateOnEnd }
-    // Syntax: GeodesicPositionOptions(largecounter outputsteps, UpdateFrequency)
+    // Syntax: GeodesicPositionOptions(largecounter outputsteps, UpdateFrequency, bool boundedmemory = false)
     // Syntax: EquatorialPassesOptions(real thethreshold, UpdateFrequency)
     // Syntax DiagnosticOptions(UpdateFrequency)
-    // Note: FourColorScreen does not have any options
+    // Note: FourColorScreen and IntegrationCost do not have any options
     GeodesicPositionDiagnostic::DiagOptions =
         std::unique_ptr<GeodesicPositionOptions>(new GeodesicPositionOptions{ 5000, UpdateFrequency{1,false,false} });
     EquatorialPassesDiagnostic::DiagOptions =
@@ -128,13 +133,28 @@ void LoadPrecompiledOptions(std::unique_ptr<Metric> &theM, std::unique_ptr<Sourc
         { 15, 15 }, // screen size
         { 0, 0 }, // screen center
         std::move(theMesh), // R-value of Mesh --- ViewScreen becomes owner!
-        theM.get())); // (non-owner) pointer to Metric
+        theM.get(), // (non-owner) pointer to Metric
+        GeodesicType::Null, // type of geodesics
+        false)); // use equatorial mirror symmetry (camera on the equator of an equatorially symmetric metric, SimpleSquareMesh only)
 
 
     //// Integrator ////
-    theIntegrator = Integrators::IntegrateGeodesicStep_RK4; // IntegrateGeodesicStep_RK4 or IntegrateGeodesicStep_Verlet
+    theIntegrator = Integrators::IntegrateGeodesicStep_RK4; // IntegrateGeodesicStep_RK4, IntegrateGeodesicStep_Verlet or IntegrateGeodesicStep_RK45
     Integrators::IntegratorDescription = "RK4";
     Integrators::epsilon = 0.03; // base step size that is used (is adapted dynamically)
+    // Integrators::RK45AbsoluteTolerance = 1e-8; // error tolerances (only used by RK45)
+    // Integrators::RK45RelativeTolerance = 1e-8;
+    // Integrate batches of geodesics in lockstep: set to the batched version of the integrator (only available for RK4)
+    // or nullptr to integrate geodesics one by one
+    theBatchIntegrator = nullptr; // nullptr or Integrators::IntegrateGeodesicStep_RK4_Batch
+    Integrators::IntegrateInBatches = (theBatchIntegrator != nullptr);
+
+
+    //// Scheduler ////
+    // Syntax: GeodesicScheduler(ScheduleType type, int chunksize, bool costordering, int costmapresolution)
+    // ScheduleType possibilities: Static, Dynamic, Guided; chunksize 0 means the OpenMP default
+    theScheduler = std::unique_ptr<Utilities::GeodesicScheduler>(new Utilities::GeodesicScheduler(
+        Utilities::ScheduleType::Static, 0, false, 32)); // e.g. (Dynamic, 16, true, 32) for unevenly expensive screens
 
 
     //// Output handler ////
@@ -146,8 +166,15 @@ void LoadPrecompiledOptions(std::unique_ptr<Metric> &theM, std::unique_ptr<Sourc
         Utilities::GetDiagNameStrings(AllDiags, ValDiag), // strings of names of all Diagnostics turned on
         200000, // nr geodesics to cache
         200000, // nr geodesics per file
-        Utilities::GetFirstLineInfoString(theM.get(), theS.get(), AllDiags, ValDiag, AllTerms, theView.get()) // first line info
+        Utilities::GetFirstLineInfoString(theM.get(), theS.get(), AllDiags, ValDiag, AllTerms, theView.get()), // first line info
+        OutputFormat::Text, // OutputFormat::Text or OutputFormat::Binary
+        0, // streaming buffer size (0: no streaming, cache output instead)
+        {} // memory-mapped output (binary only): Utilities::GetDiagFullDataValCounts(AllDiags, ValDiag); {}: not memory-mapped
     ));
+
+    //// Checkpoints ////
+    // Syntax: {checkpoint file, write checkpoint every this many iterations (0: never), resume from checkpoint file}
+    theCheckpointOptions = Utilities::CheckpointOptions{ "output_checkpoint.dat", 0, false };
 }
 
 
@@ -228,12 +255,19 @@ int main(int argc, char* argv[])
 
     // Initialize Integrator
     GeodesicIntegratorFunc theIntegrator = Config::GetGeodesicIntegrator(cfgObject);
+    BatchGeodesicIntegratorFunc theBatchIntegrator = Config::GetBatchGeodesicIntegrator(cfgObject);
+
+    // Initialize Scheduler
+    std::unique_ptr<Utilities::GeodesicScheduler> theScheduler = Config::GetScheduler(cfgObject);
 
     // Initialize Output Handler
     // First we get the info string to place at the first line of every output file
     std::string FirstLineInfo{ Utilities::GetFirstLineInfoString(theM.get(), theS.get(), AllDiags, ValDiag, AllTerms, theView.get()) };
     std::unique_ptr<GeodesicOutputHandler> theOutputHandler = Config::GetOutputHandler(cfgObject, AllDiags, ValDiag, FirstLineInfo);
 
+    // Initialize checkpoint options
+    Utilities::CheckpointOptions theCheckpointOptions = Config::GetCheckpointOptions(cfgObject);
+
     // Done initializing everything!
     ScreenOutput("Done loading options from configuration file.", OutputLevel::Level_1_PROC);
 
@@ -252,14 +286,24 @@ int main(int argc, char* argv[])
     TermBitflag AllTerms;
     std::unique_ptr<ViewScreen> theView;
     GeodesicIntegratorFunc theIntegrator;
+    BatchGeodesicIntegratorFunc theBatchIntegrator;
+    std::unique_ptr<Utilities::GeodesicScheduler> theScheduler;
     std::unique_ptr<GeodesicOutputHandler> theOutputHandler;
-    LoadPrecompiledOptions(theM, theS, AllDiags, ValDiag, AllTerms, theView, theIntegrator, theOutputHandler);
+    Utilities::CheckpointOptions theCheckpointOptions;
+    LoadPrecompiledOptions(theM, theS, AllDiags, ValDiag, AllTerms, theView, theIntegrator, theBatchIntegrator,
+        theScheduler, theOutputHandler, theCheckpointOptions);
 
     // Done initializing everything!
     ScreenOutput("Done loading precompiled options.", OutputLevel::Level_1_PROC);
 
 #endif              // CONFIGURATION OR PRECOMPILED MODE
 
+    // Use the version of the integrator that is specialized for (the type of) the Metric, if there is one
+    theIntegrator = Integrators::SpecializeIntegrator(theIntegrator, theM.get());
+
+    // The integrators only count their work (rhs evaluations etc.) if the IntegrationCost Diagnostic needs it
+    Integrators::CountWork = (AllDiags & Diag_IntegrationCost) != 0;
+
     // Now, we proceed to list all objects that have been initialized (using their description string)
 
     OutputLevel listallobjects = OutputLevel::Level_2_SUBPROC;
@@ -295,12 +339,52 @@ int main(int argc, char* argv[])
     ScreenOutput(theView->getFullDescriptionStr() + ".", listallobjects);
 
     ScreenOutput(Integrators::GetFullIntegratorDescription(), listallobjects);
+
+    ScreenOutput(theScheduler->getFullDescriptionStr() + ".", listallobjects);
     
     ScreenOutput(theOutputHandler->getFullDescriptionStr(), listallobjects);
 
+    if (theCheckpointOptions.Interval > 0 || theCheckpointOptions.Resume)
+        ScreenOutput("Checkpoint file: " + theCheckpointOptions.FileName + ", writing checkpoint every "
+            + std::to_string(theCheckpointOptions.Interval) + " iterations, resuming: "
+            + std::to_string(theCheckpointOptions.Resume) + ".", listallobjects);
+
     ScreenOutput("--------------------------------\n", listallobjects);
 
 
+    // The number of iterations of geodesics done so far
+    largecounter IterationsDone{ 0 };
+
+    // Checkpoints can only be resumed by a run with exactly the same settings (as described by this string)
+    const std::string RunInfo{ Utilities::GetFirstLineInfoString(theM.get(), theS.get(), AllDiags, ValDiag, AllTerms, theView.get()) };
+
+    // If the Mesh continues from the output of a previous run, that output is included in the output of this run
+    // (when resuming from a checkpoint, it has been included already)
+    {
+        std::string previousoutput{};
+        largecounter indexscale{ 1 };
+        if (!theCheckpointOptions.Resume && theView->getPreviousOutput(previousoutput, indexscale))
+        {
+            ScreenOutput("Including output of previous run (" + previousoutput + ")...", OutputLevel::Level_1_PROC);
+            largecounter nrincluded{ theOutputHandler->IncludePreviousOutput(previousoutput, indexscale) };
+            ScreenOutput("Included " + std::to_string(nrincluded) + " geodesics from previous run.", OutputLevel::Level_1_PROC);
+        }
+    }
+
+    // If we are resuming an earlier run, restore the state of the Mesh and the output files from the checkpoint
+    if (theCheckpointOptions.Resume)
+    {
+        ScreenOutput("Resuming from checkpoint " + theCheckpointOptions.FileName + "...", OutputLevel::Level_1_PROC);
+        if (!Utilities::LoadCheckpoint(theCheckpointOptions.FileName, RunInfo, IterationsDone,
+            theView.get(), theOutputHandler.get()))
+        {
+            ScreenOutput("Could not resume from checkpoint. Exiting...\n", OutputLevel::Level_0_WARNING);
+            exit(0);
+        }
+        ScreenOutput("Resuming run after " + std::to_string(IterationsDone) + " iterations.", OutputLevel::Level_1_PROC);
+    }
+
+
     // totalTimer keeps track of the total time elapsed in integration
     Utilities::Timer totalTimer;
     totalTimer.reset();
@@ -308,115 +392,298 @@ int main(int argc, char* argv[])
 
     // STARTING GEODESIC INTEGRATION
 
-    // start new iteration of integrating geodesics. ViewScreen (through Mesh) will return true when it does not 
-    // want to integrate another iteration of geodesics.
-    while (!theView->IsFinished()) 
-    {
-        ScreenOutput("Starting new integration loop.", OutputLevel::Level_1_PROC);
+    // The loop schedule is inherited by all threads when the parallel region starts
+    theScheduler->SetSchedule();
 
-        // Time this iteration of geodesics
-        Utilities::Timer IterationTimer;
+    // These are shared by all threads, and are (re)set at the start of every iteration of geodesics by a single thread
 
-        // How many geodesics are we integrating this iteration
-        // OpenMP distributed for loops demand a SIGNED integral type as the loop iterator
-        long long CurNrGeod = static_cast<long long>(theView->getCurNrGeodesics());
+    // Time each iteration of geodesics
+    Utilities::Timer IterationTimer;
 
-        // Counter of number of geodesics already integrated in thread 0
-        long long masterIndexCounter{ 0 };
+    // How many geodesics are we integrating this iteration
+    // OpenMP distributed for loops demand a SIGNED integral type as the loop iterator
+    long long CurNrGeod{ 0 };
 
-#pragma omp parallel // start up threads!
-        { 
-#pragma omp single // only output start message and reset timer in single thread; other threads wait until OutputHandler is ready!
-            {
-                ScreenOutput("Integrating " + std::to_string(CurNrGeod) + " geodesics on "
-                    + std::to_string(omp_get_num_threads()) + " threads...",
-                    OutputLevel::Level_1_PROC);
-                IterationTimer.reset();
+    // Counter of number of geodesics already integrated in thread 0
+    long long masterIndexCounter{ 0 };
+
+    // When integrating in batches, this is the index of the next geodesic that has not been handed out to a thread yet
+    long long nextBatchIndex{ 0 };
 
-                // Prepare the output handler for the output to come
-                theOutputHandler->PrepareForOutput(static_cast<largecounter>(CurNrGeod));
+    // Set to true (by a single thread) when the ViewScreen does not want another iteration of geodesics
+    bool AllFinished{ false };
+
+    // Pass the output of a geodesic that has finished integrating to the output handler (as text or in numerical form);
+    // the output is written into the (per-thread) record theRecord, which is reused for every geodesic so that
+    // no memory needs to be allocated per geodesic
+    auto PassGeodesicOutput = [&theOutputHandler](largecounter index, const Geodesic& theGeod, GeodesicOutputRecord& theRecord)
+    {
+        theGeod.WriteAllOutput(theRecord, theOutputHandler->IsBinaryOutput());
+        theOutputHandler->NewGeodesicOutput(index, theRecord);
+    };
+
+    // If the ViewScreen uses mirror symmetry, the mirror image of a geodesic that has finished integrating (if it has one)
+    // is not integrated itself: its output is that of the reflected geodesic, stored after the output of all integrated geodesics
+    auto PassMirrorOutput = [&theView, &PassGeodesicOutput, &CurNrGeod](largecounter index, Geodesic& theGeod, GeodesicOutputRecord& theRecord)
+    {
+        largecounter mirrorindex;
+        ScreenIndex mirrorscrindex;
+        if (theView->getMirrorImage(index, mirrorindex, mirrorscrindex))
+        {
+            theGeod.ReflectEquatorially(mirrorscrindex);
+            PassGeodesicOutput(static_cast<largecounter>(CurNrGeod) + mirrorindex, theGeod, theRecord);
+        }
+    };
+
+    // Keep count of number of geodesics integrated in thread 0 and
+    // output loop progress message if applicable
+    auto LoopProgressMessage = [&masterIndexCounter, &IterationTimer, &CurNrGeod]()
+    {
+        if (omp_get_thread_num() == 0)
+        {
+            ++masterIndexCounter;
+
+            int numthreads{ omp_get_num_threads() };
+            if (masterIndexCounter > 0 && masterIndexCounter % (GetLoopMessageFrequency() / numthreads) == 0)
+            {
+                double speed = masterIndexCounter * numthreads / IterationTimer.elapsed();
+                ScreenOutput("Approx. at geodesic "
+                    + std::to_string(masterIndexCounter * numthreads)
+                    + " ("
+                    + std::to_string(IterationTimer.elapsed()) + "s elapsed; speed: "
+                    + std::to_string(static_cast<long>(speed)) + " geod/s; est. loop time remaining: "
+                    + std::to_string((CurNrGeod - masterIndexCounter * numthreads) / speed)
+                    + "s)..."
+                    , OutputLevel::Level_2_SUBPROC);
             }
+        }
+    };
 
-            // Create one Geodesic instance per thread to work with
-            Geodesic theGeod(theM.get(), theS.get(), // Metric and Source (non-owner pointers!)
+    // The threads are started up only once and are kept alive over all iterations of geodesics;
+    // in between iterations, one thread prepares the next iteration while the others wait
+#pragma omp parallel // start up threads!
+    {
+        // Create one Geodesic (or GeodesicBatch) instance per thread to work with
+        std::unique_ptr<Geodesic> theGeod{};
+        std::unique_ptr<GeodesicBatch> theBatch{};
+        if (theBatchIntegrator)
+        {
+            theBatch = std::unique_ptr<GeodesicBatch>(new GeodesicBatch(theM.get(), theS.get(), // Metric and Source (non-owner pointers!)
+                AllDiags, ValDiag,      // Bitflags for Diagnostics
+                AllTerms,               // Bitflag for Terminations
+                theBatchIntegrator));   // Function to use to integrate geodesic equation for the whole batch
+        }
+        else
+        {
+            theGeod = std::unique_ptr<Geodesic>(new Geodesic(theM.get(), theS.get(), // Metric and Source (non-owner pointers!)
                 AllDiags, ValDiag,      // Bitflags for Diagnostics
                 AllTerms,               // Bitflag for Terminations
-                theIntegrator);         // Function to use to integrate geodesic equation
+                theIntegrator));        // Function to use to integrate geodesic equation
+        }
 
+        // Per-thread buffers for the output of the finished geodesics; these are reused for every geodesic
+        // (and keep their memory), so that passing on the output does not allocate
+        GeodesicOutputRecord theOutputRecord{};
+        std::vector<real> theFinalValues{};
 
-            // distribute for loop iterations over threads
-#pragma omp for     
-            for (long long index = 0; index < CurNrGeod; ++index)
+        // start new iteration of integrating geodesics. ViewScreen (through Mesh) will return true when it does not 
+        // want to integrate another iteration of geodesics.
+        while (true)
+        {
+#pragma omp single // only check whether we are done, output start message and reset timer in single thread; other threads wait until OutputHandler is ready!
             {
+                AllFinished = theView->IsFinished();
+                if (!AllFinished)
+                {
+                    ScreenOutput("Starting new integration loop.", OutputLevel::Level_1_PROC);
+
+                    CurNrGeod = static_cast<long long>(theView->getCurNrGeodesics());
+                    masterIndexCounter = 0;
+                    nextBatchIndex = 0;
+
+                    // Set (possibly) the order in which the geodesics will be integrated
+                    theScheduler->PrepareLoop(theView.get(), static_cast<largecounter>(CurNrGeod));
 
-                // Keep count of number of geodesics integrated in thread 0 and
-                // output loop progress message if applicable
-                if (omp_get_thread_num() == 0)
+                    ScreenOutput("Integrating " + std::to_string(CurNrGeod) + " geodesics on "
+                        + std::to_string(omp_get_num_threads()) + " threads...",
+                        OutputLevel::Level_1_PROC);
+                    IterationTimer.reset();
+
+                    // Prepare the output handler for the output to come (including that of the mirror images, if any)
+                    theOutputHandler->PrepareForOutput(static_cast<largecounter>(CurNrGeod) + theView->getCurNrMirrorImages());
+                }
+            } // (implicit barrier: all threads see the same AllFinished)
+            if (AllFinished)
+                break;
+
+            if (theBatch)
+            {
+                // Time at which the geodesic in each lane started integrating (to estimate its cost)
+                std::array<double, BatchSize> laneStartTime{};
+                double startTime{ IterationTimer.elapsed() };
+
+                // The lanes that are refilled with a new geodesic in the current step, and their geodesics' initial conditions
+                std::array<int, BatchSize> refillLanes{};
+                std::array<largecounter, BatchSize> refillIndices{};
+                std::array<Point, BatchSize> refillPos{};
+                std::array<OneIndex, BatchSize> refillVel{};
+                std::array<ScreenIndex, BatchSize> refillScrIndex{};
+
+                // Keep integrating the batch until all geodesics have been handed out and all lanes have finished
+                do
                 {
-                    ++masterIndexCounter;
+                    int nrRefill{ 0 };
 
-                    int numthreads{ omp_get_num_threads() };
-                    if (masterIndexCounter > 0 && masterIndexCounter % (GetLoopMessageFrequency() / numthreads) == 0)
+                    // Every lane whose geodesic has finished passes on its results, and is refilled with a new geodesic
+                    for (int lane = 0; lane < BatchSize; ++lane)
                     {
-                        double speed = masterIndexCounter * numthreads / IterationTimer.elapsed();
-                        ScreenOutput("Approx. at geodesic "
-                            + std::to_string(masterIndexCounter * numthreads)
-                            + " ("
-                            + std::to_string(IterationTimer.elapsed()) + "s elapsed; speed: "
-                            + std::to_string(static_cast<long>(speed)) + " geod/s; est. loop time remaining: "
-                            + std::to_string((CurNrGeod - masterIndexCounter * numthreads) / speed)
-                            + "s)..."
-                            , OutputLevel::Level_2_SUBPROC);
+                        if (theBatch->IsLaneIntegrating(lane))
+                            continue;
+
+                        largecounter finishedindex{ theBatch->getLaneIndex(lane) };
+                        if (finishedindex != LARGECOUNTER_MAX)
+                        {
+                            // The geodesic has finished integrating; see below (the non-batched loop) for comments
+                            Geodesic& theLaneGeod{ theBatch->getLaneGeodesic(lane) };
+                            theLaneGeod.WriteDiagnosticFinalValue(theFinalValues);
+                            theView->GeodesicFinished(finishedindex, theFinalValues);
+                            PassGeodesicOutput(finishedindex, theLaneGeod, theOutputRecord);
+                            PassMirrorOutput(finishedindex, theLaneGeod, theOutputRecord);
+                            theScheduler->GeodesicCost(finishedindex, IterationTimer.elapsed() - laneStartTime[lane]);
+                            LoopProgressMessage();
+                        }
+
+                        // Claim the next geodesic that has not been integrated yet (if there is one)
+                        long long loopindex;
+#pragma omp atomic capture
+                        loopindex = nextBatchIndex++;
+
+                        if (loopindex < CurNrGeod)
+                        {
+                            refillLanes[nrRefill] = lane;
+                            refillIndices[nrRefill] = theScheduler->getGeodesicIndex(static_cast<largecounter>(loopindex));
+                            ++nrRefill;
+                        }
+                        else
+                        {
+                            theBatch->ClearLane(lane);
+                        }
                     }
-                }
 
-                // Set up initial conditions for a geodesic
-                Point initpos;
-                OneIndex initvel;
-                ScreenIndex scrindex;
-                
-                // Note that SetNewInitialConditions is a const member function, both of ViewScreen
-                // and (called within) of the underlying Mesh objects; it only accesses ViewScreen/Mesh data without changing
-                // anything. Therefore this does not need to be called with #pragma omp critical
-                theView->SetNewInitialConditions(static_cast<largecounter>(index), initpos, initvel, scrindex);
+                    // Set up the initial conditions of all new geodesics at once (see below for comments)
+                    if (nrRefill > 0)
+                    {
+                        theView->SetNewInitialConditions(refillIndices.data(), static_cast<std::size_t>(nrRefill),
+                            refillPos.data(), refillVel.data(), refillScrIndex.data());
+                        double refillTime{ IterationTimer.elapsed() };
+                        for (int k = 0; k < nrRefill; ++k)
+                        {
+                            theBatch->ResetLane(refillLanes[k], refillIndices[k], refillScrIndex[k], refillPos[k], refillVel[k]);
+                            laneStartTime[refillLanes[k]] = refillTime;
+                        }
+                    }
+                } while (theBatch->Update() > 0); // Integrate all lanes that have not finished by one step
 
-                // Set the Geodesic to the current screen index and initial position/velocity
-                theGeod.Reset(scrindex, initpos, initvel);
+                theScheduler->ThreadFinished(IterationTimer.elapsed() - startTime);
+            }
+            else
+            {
+                // Total time this thread has spent integrating geodesics
+                double busyTime{ 0.0 };
 
-                // Loop integrating the geodesic step by step until finished
-                while (theGeod.getTermCondition() == Term::Continue)
+                // distribute for loop iterations over threads (with the schedule set by the Scheduler);
+                // no need to wait at the end of the loop as there is an explicit barrier below
+#pragma omp for schedule(runtime) nowait
+                for (long long loopindex = 0; loopindex < CurNrGeod; ++loopindex)
                 {
-                    theGeod.Update();
-                }
+                    // Output loop progress message if applicable
+                    LoopProgressMessage();
 
-                // The geodesic has finished integrating.
-                // We tell the ViewScreen it is finished and give it the "values" to associate to the geodesic.
-                // We pass the geodesics' output to the Output Handler
-                // Note: both of these calls involve a change of internal state of ViewScreen/Mesh and OutputHandler.
-                // However, they have been set up to be thread-safe, i.e. these calls will modify values in existing
-                // vectors but never reshape the underlying objects!
-                // Since they are thread-safe, no omp critical directive is necessary here.
-                theView->GeodesicFinished(static_cast<largecounter>(index), std::move(theGeod.getDiagnosticFinalValue()));
-                theOutputHandler->NewGeodesicOutput(static_cast<largecounter>(index), std::move(theGeod.getAllOutputStr()));
+                    // The Scheduler may want to integrate geodesics in a different order than the Mesh gave them to us
+                    largecounter index{ theScheduler->getGeodesicIndex(static_cast<largecounter>(loopindex)) };
+                    double geodStartTime{ IterationTimer.elapsed() };
 
-            } // end parallel distributed for loop over all geodesics to integrate
+                    // Set up initial conditions for a geodesic
+                    Point initpos;
+                    OneIndex initvel;
+                    ScreenIndex scrindex;
+                
+                    // Note that SetNewInitialConditions is a const member function, both of ViewScreen
+                    // and (called within) of the underlying Mesh objects; it only accesses ViewScreen/Mesh data without changing
+                    // anything. Therefore this does not need to be called with #pragma omp critical
+                    theView->SetNewInitialConditions(index, initpos, initvel, scrindex);
+
+                    // Set the Geodesic to the current screen index and initial position/velocity
+                    theGeod->Reset(scrindex, initpos, initvel);
+
+                    // Loop integrating the geodesic step by step until finished
+                    while (theGeod->getTermCondition() == Term::Continue)
+                    {
+                        theGeod->Update();
+                    }
+
+                    // The geodesic has finished integrating.
+                    // We tell the ViewScreen it is finished and give it the "values" to associate to the geodesic.
+                    // We pass the geodesics' output to the Output Handler
+                    // Note: both of these calls involve a change of internal state of ViewScreen/Mesh and OutputHandler.
+                    // However, they have been set up to be thread-safe, i.e. these calls will modify values in existing
+                    // vectors but never reshape the underlying objects!
+                    // Since they are thread-safe, no omp critical directive is necessary here.
+                    theGeod->WriteDiagnosticFinalValue(theFinalValues);
+                    theView->GeodesicFinished(index, theFinalValues);
+                    PassGeodesicOutput(index, *theGeod, theOutputRecord);
+                    // (The mirror image, if any, reuses the geodesic; this must come after all other calls that need its output)
+                    PassMirrorOutput(index, *theGeod, theOutputRecord);
+
+                    // Keep track of how long this geodesic took
+                    double geodTime{ IterationTimer.elapsed() - geodStartTime };
+                    theScheduler->GeodesicCost(index, geodTime);
+                    busyTime += geodTime;
+
+                } // end parallel distributed for loop over all geodesics to integrate
+
+                theScheduler->ThreadFinished(busyTime);
+            }
 
             
+            // Note: this is a global barrier between iterations: the Mesh only selects and subdivides pixels
+            // (in EndCurrentLoop() below) when all geodesics of the iteration are done, since which pixels are
+            // subdivided depends on all weights. (SquareSubdivisionMeshV2 can calculate the weights themselves
+            // while the iteration is running, see its PipelinedWeights mode, but refinement does not overlap integration.)
 #pragma omp barrier // To make sure all threads are done before we output that we are done!
-#pragma omp single  // only output time taken in one thread, the rest needs to wait here before exiting!
+#pragma omp single  // only output time taken and set up the next iteration in one thread, the rest needs to wait here!
             {
                 double timetaken = IterationTimer.elapsed();
                 double totaltime = totalTimer.elapsed();
                 ScreenOutput("Integration loop done. Time taken for integration loop: "
                     + std::to_string(timetaken) + "s (" + std::to_string(timetaken / 60) + "m); total time elapsed: "
                     + std::to_string(totaltime) + "s (" + std::to_string(totaltime / 60) + "m).", OutputLevel::Level_1_PROC);
+
+                // Report the load balance of the threads and update the cost estimates (before the Mesh moves on!)
+                theScheduler->EndLoop(theView.get(), timetaken);
+
+                // This triggers the end of the current iteration of geodesics in ViewScreen and its Mesh;
+                // the Mesh will then evaluate if it wants another iteration of geodesics to integrate and
+                // set the next iteration up
+                theView->EndCurrentLoop();
+
+                // Write a checkpoint every so many iterations (unless we are done anyway);
+                // note that this also writes all output so far to file
+                ++IterationsDone;
+                if (theCheckpointOptions.Interval > 0 && IterationsDone % theCheckpointOptions.Interval == 0
+                    && !theView->IsFinished())
+                {
+                    ScreenOutput("Writing checkpoint to " + theCheckpointOptions.FileName + "...", OutputLevel::Level_2_SUBPROC);
+                    if (!Utilities::SaveCheckpoint(theCheckpointOptions.FileName, RunInfo, IterationsDone,
+                        theView.get(), theOutputHandler.get()))
+                    {
+                        ScreenOutput("Writing checkpoint failed; no further checkpoints will be written.", OutputLevel::Level_0_WARNING);
+                        theCheckpointOptions.Interval = 0;
+                    }
+                }
             }
-        } // end parallel (close threads)
-        // This triggers the end of the current iteration of geodesics in ViewScreen and its Mesh;
-        // the Mesh will then evaluate if it wants another iteration of geodesics to integrate and
-        // set the next iteration up
-        theView->EndCurrentLoop();
-    } // end while
+        } // end while
+    } // end parallel (close threads)
     
     // We are completely done integrating!
     double totaltime = totalTimer.elapsed();
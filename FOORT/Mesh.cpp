@@ -3,6 +3,8 @@
 #include "Utilities.h" // we use the Timer in SquareSubdivisionMeshV2
 
 #include <algorithm> // needed for std::find_if, std::sort, std::max_element, std::min, etc
+#include <iterator> // std::back_inserter
+#include <omp.h> // for omp_get_num_threads (SquareSubdivisionMeshV2 works in parallel at the end of every iteration)
 #include <limits> // for std::numeric_limits
 #include <iostream> // for std::cin
 
@@ -16,6 +18,40 @@ std::string Mesh::getFullDescriptionStr() const
 	return "Mesh (no override description specified)";
 }
 
+bool Mesh::SaveCheckpoint(std::ostream&) const
+{
+	// By default, a Mesh does not support checkpointing
+	return false;
+}
+
+bool Mesh::LoadCheckpoint(std::istream&)
+{
+	// By default, a Mesh does not support checkpointing
+	return false;
+}
+
+bool Mesh::getPreviousOutput(std::string&, largecounter&) const
+{
+	// By default, a Mesh does not continue from a previous run
+	return false;
+}
+
+bool Mesh::UseMirrorSymmetry()
+{
+	// By default, a Mesh does not support mirror symmetry
+	return false;
+}
+
+largecounter Mesh::getCurNrMirrorImages() const
+{
+	return 0;
+}
+
+bool Mesh::getMirrorImage(largecounter, largecounter&, ScreenIndex&) const
+{
+	return false;
+}
+
 
 /// <summary>
 /// SimpleSquareMesh functions
@@ -31,18 +67,42 @@ bool SimpleSquareMesh::IsFinished() const
 void SimpleSquareMesh::getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const
 {
 	// We should not be getting new initial conditions if all pixels are done already!
-	if (index >= m_TotalPixels)
+	if (index >= getCurNrGeodesics())
 	{
 		ScreenOutput("Trying to initialize a pixel after all pixels are done!", OutputLevel::Level_0_WARNING);
 	}
 
-	// get (row, column) where each is between 0 and m_RowColumnSize-1 (m_RowColumnSize^2 = m_TotalPixels)
-	// Note: m_CurrentPixel runs between 0 and m_TotalPixels-1
 	pixelcoord row{ 0 };
-	while ((row+1) * m_RowColumnSize <= index)
-		++row;
-
-	pixelcoord column =  index - row * m_RowColumnSize ;
+	pixelcoord column{ 0 };
+	if (m_PreviousRowColumnSize > 0)
+	{
+		// We skip the pixels on the previous grid. The pixels come in blocks of m_PreviousScale rows, starting with a row
+		// of the previous grid (which only has the m_RowColumnSize - m_PreviousRowColumnSize new pixels in between
+		// the previous pixels), followed by m_PreviousScale - 1 completely new rows
+		const largecounter newinprevrow{ m_RowColumnSize - m_PreviousRowColumnSize };
+		const largecounter blocksize{ newinprevrow + (m_PreviousScale - 1) * m_RowColumnSize };
+		row = (index / blocksize) * m_PreviousScale;
+		largecounter inblock{ index % blocksize };
+		if (inblock < newinprevrow)
+		{
+			// The inblock-th pixel in between the previous pixels
+			column = (inblock / (m_PreviousScale - 1)) * m_PreviousScale + inblock % (m_PreviousScale - 1) + 1;
+		}
+		else
+		{
+			inblock -= newinprevrow;
+			row += 1 + inblock / m_RowColumnSize;
+			column = inblock % m_RowColumnSize;
+		}
+	}
+	else
+	{
+		// get (row, column) where each is between 0 and m_RowColumnSize-1 (m_RowColumnSize^2 = m_TotalPixels);
+		// if using mirror symmetry, only the first m_IntegratedColumns columns are handed out
+		// Note: m_CurrentPixel runs between 0 and m_RowColumnSize * m_IntegratedColumns - 1
+		row = index / m_IntegratedColumns;
+		column = index % m_IntegratedColumns;
+	}
 
 	// Return a 2D ScreenPoint (x,y) with both coordinates between 0 and 1, where 0 and 1 represent the edges of the viewscreen
 	newscreenindex = ScreenIndex{ row,column };
@@ -57,11 +117,13 @@ void SimpleSquareMesh::EndCurrentLoop()
 
 largecounter SimpleSquareMesh::getCurNrGeodesics() const
 {
-	// This Mesh only has one loop, so the total pixels is the current number of pixels to be integrated.
-	return m_TotalPixels;
+	// This Mesh only has one loop, so the total pixels is the current number of pixels to be integrated
+	// (except for the pixels that were already integrated on the previous grid).
+	// If using mirror symmetry, only m_IntegratedColumns of every row are integrated.
+	return m_RowColumnSize * m_IntegratedColumns - m_PreviousRowColumnSize * m_PreviousRowColumnSize;
 }
 
-void SimpleSquareMesh::GeodesicFinished([[maybe_unused]] largecounter index, [[maybe_unused]] std::vector<real> finalValues)
+void SimpleSquareMesh::GeodesicFinished([[maybe_unused]] largecounter index, [[maybe_unused]] const std::vector<real>& finalValues)
 {
 	// This Mesh doesn't actually have to do anything with the geodesic (values) when it is done!
 }
@@ -69,7 +131,54 @@ void SimpleSquareMesh::GeodesicFinished([[maybe_unused]] largecounter index, [[m
 std::string SimpleSquareMesh::getFullDescriptionStr() const
 {
 	// Description string
-	return "Mesh: simple square grid (" + std::to_string(m_RowColumnSize) + "^2 pixels)";
+	return "Mesh: simple square grid (" + std::to_string(m_RowColumnSize) + "^2 pixels"
+		+ (m_PreviousRowColumnSize > 0 ? "; refining previous grid of " + std::to_string(m_PreviousRowColumnSize)
+			+ "^2 pixels (output: " + m_PreviousOutput + ")" : "")
+		+ (m_IntegratedColumns < m_RowColumnSize ? "; integrating " + std::to_string(m_IntegratedColumns)
+			+ " columns and mirroring the others" : "")
+		+ ")";
+}
+
+bool SimpleSquareMesh::getPreviousOutput(std::string& previousoutput, largecounter& indexscale) const
+{
+	if (m_PreviousRowColumnSize == 0)
+		return false;
+
+	previousoutput = m_PreviousOutput;
+	indexscale = m_PreviousScale;
+	return true;
+}
+
+bool SimpleSquareMesh::UseMirrorSymmetry()
+{
+	// Mirroring is not combined with refining a previous grid
+	if (m_PreviousRowColumnSize > 0)
+		return false;
+
+	// The first half of the columns (including the middle column if there is an odd number of them) is integrated
+	m_IntegratedColumns = (m_RowColumnSize + 1) / 2;
+	return true;
+}
+
+largecounter SimpleSquareMesh::getCurNrMirrorImages() const
+{
+	return m_RowColumnSize * (m_RowColumnSize - m_IntegratedColumns);
+}
+
+bool SimpleSquareMesh::getMirrorImage(largecounter index, largecounter& mirrorindex, ScreenIndex& mirrorscreenindex) const
+{
+	// Note that the (integrated) pixel index runs over the first m_IntegratedColumns columns of every row,
+	// and the mirror index over the last m_RowColumnSize - m_IntegratedColumns columns
+	const pixelcoord mirrorcolumns{ m_RowColumnSize - m_IntegratedColumns };
+	pixelcoord row{ index / m_IntegratedColumns };
+	pixelcoord column{ index % m_IntegratedColumns };
+	// The middle column (if any) is its own mirror image
+	if (column >= mirrorcolumns)
+		return false;
+
+	mirrorindex = row * mirrorcolumns + column;
+	mirrorscreenindex = ScreenIndex{ row, m_RowColumnSize - 1 - column };
+	return true;
 }
 
 
@@ -153,7 +262,7 @@ void InputCertainPixelsMesh::EndCurrentLoop()
 	m_Finished = true;
 }
 
-void InputCertainPixelsMesh::GeodesicFinished([[maybe_unused]] largecounter index, [[maybe_unused]] std::vector<real> finalValues)
+void InputCertainPixelsMesh::GeodesicFinished([[maybe_unused]] largecounter index, [[maybe_unused]] const std::vector<real>& finalValues)
 {
 	// This Mesh doesn't actually have to do anything with the geodesic (values) when it's done!
 }
@@ -205,7 +314,7 @@ void SquareSubdivisionMesh::getNewInitConds(largecounter index, ScreenPoint& new
 		newscreenindex[1] * 1.0 / static_cast<real>(m_RowColumnSize - 1) };
 }
 
-void SquareSubdivisionMesh::GeodesicFinished(largecounter index, std::vector<real> finalValues)
+void SquareSubdivisionMesh::GeodesicFinished(largecounter index, const std::vector<real>& finalValues)
 {
 	// NOTE: this function must be thread-safe!
 	// This means all the changes it makes are to values in a vector, never re-shaping the vector!
@@ -250,6 +359,32 @@ pixelcoord SquareSubdivisionMesh::ExpInt(int base, int exp)
 	return ret;
 }
 
+// Helper (private) member function
+largecounter SquareSubdivisionMesh::PixelKey(pixelcoord row, pixelcoord col) const
+{
+	// Every pixel on the (fully subdivided) grid has a unique key
+	return row * m_RowColumnSize + col;
+}
+
+// Helper (private) member function
+largecounter SquareSubdivisionMesh::FindPixel(pixelcoord row, pixelcoord col) const
+{
+	// Pixels outside the grid can never exist (and could collide with the key of a pixel inside the grid)
+	if (row >= m_RowColumnSize || col >= m_RowColumnSize)
+		return LARGECOUNTER_MAX;
+
+	auto loc = m_PixelLocations.find(PixelKey(row, col));
+	return loc == m_PixelLocations.end() ? LARGECOUNTER_MAX : loc->second;
+}
+
+// Helper (private) member function
+void SquareSubdivisionMesh::QueuePixel(ScreenIndex index, int subdiv)
+{
+	// Once the queue is integrated, it is appended to m_AllPixels; this is the pixel's position there
+	m_PixelLocations[PixelKey(index[0], index[1])] = m_AllPixels.size() + m_CurrentPixelQueue.size();
+	m_CurrentPixelQueue.push_back(PixelInfo(index, subdiv));
+}
+
 //////////////////////////////////////////////////////////////
 //// Important SquareSubdivisionMesh functions start here ////
 
@@ -260,6 +395,7 @@ void SquareSubdivisionMesh::InitializeFirstGrid()
 	// initial square grid of m_InitialPixels
 	pixelcoord initRowColSize = static_cast<pixelcoord>(sqrt(m_InitialPixels));
 	m_CurrentPixelQueue.reserve(m_InitialPixels);
+	m_PixelLocations.reserve(m_InitialPixels);
 
 	for (largecounter i = 0; i < m_InitialPixels; ++i)
 	{
@@ -278,7 +414,7 @@ void SquareSubdivisionMesh::InitializeFirstGrid()
 		// Note that the actual ScreenIndex that the pixel gets put at depends on the max
 		// level of subdivision: we are keeping room for all of the potential future pixels 
 		// that can come in between the initial grid!
-		m_CurrentPixelQueue.push_back(PixelInfo(ExpInt(2, m_MaxSubdivide - 1) * ScreenIndex { row, column }, subdiv));
+		QueuePixel(ExpInt(2, m_MaxSubdivide - 1) * ScreenIndex { row, column }, subdiv);
 	}
 
 	// Subtract the number of pixels we are integrating from the pixels we are allowed to integrate
@@ -305,26 +441,28 @@ void SquareSubdivisionMesh::UpdateAllNeighbors()
 			// Find right neighbor
 			row = pixel.Index[0];
 			col = pixel.Index[1] + ExpInt(2, m_MaxSubdivide - pixel.SubdivideLevel);
-			auto rightloc = std::find_if(m_AllPixels.begin(), m_AllPixels.end(),
-				[row, col](const PixelInfo& p)
-				{ return p.Index[0] == row && p.Index[1] == col; });
+			largecounter rightloc = FindPixel(row, col);
 			// The neighbor should always exist if everything proceeded correctly!
-			if (rightloc == m_AllPixels.end())
+			if (rightloc == LARGECOUNTER_MAX)
+			{
 				ScreenOutput("Something went wrong. Pixel "
 					+ toString(pixel.Index) + " does not have a right neighbor!", OutputLevel::Level_0_WARNING);
-			pixel.RightNbrIndex = static_cast<largecounter>( rightloc - m_AllPixels.begin() );
+				rightloc = static_cast<largecounter>(m_AllPixels.size());
+			}
+			pixel.RightNbrIndex = rightloc;
 
 			// Find lower neighbor
 			row = pixel.Index[0] + ExpInt(2, m_MaxSubdivide - pixel.SubdivideLevel);
 			col = pixel.Index[1];
-			auto lowloc = std::find_if(m_AllPixels.begin(), m_AllPixels.end(),
-				[row, col](const PixelInfo& p)
-				{ return p.Index[0] == row && p.Index[1] == col; });
+			largecounter lowloc = FindPixel(row, col);
 			// The neighbor should always exist if everything proceeded correctly!
-			if (lowloc == m_AllPixels.end())
+			if (lowloc == LARGECOUNTER_MAX)
+			{
 				ScreenOutput("Something went wrong. Pixel "
 					+ toString(pixel.Index) + " does not have a lower neighbor!", OutputLevel::Level_0_WARNING);
-			pixel.LowerNbrIndex = static_cast<largecounter>( lowloc - m_AllPixels.begin() );
+				lowloc = static_cast<largecounter>(m_AllPixels.size());
+			}
+			pixel.LowerNbrIndex = lowloc;
 		}
 	}
 
@@ -386,19 +524,17 @@ void SquareSubdivisionMesh::UpdateAllWeights()
 // and add (up to) 5 new pixels in the integration queue accordingly
 void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 {
-	// Helper function to find a pixel in m_AllPixels
-	auto FindPosBefore = [this](pixelcoord row, pixelcoord col)
+	// Helper function to find a pixel in m_AllPixels (returns nullptr if it is not there)
+	auto FindPosBefore = [this](pixelcoord row, pixelcoord col) -> PixelInfo*
 	{
-		return std::find_if(m_AllPixels.begin(), m_AllPixels.end(),
-			[row, col](const PixelInfo& pixel)
-			{ return pixel.Index[0] == row && pixel.Index[1] == col; });
+		largecounter loc = FindPixel(row, col);
+		return loc < m_AllPixels.size() ? &m_AllPixels[loc] : nullptr;
 	};
-	// Helper function to find a pixel in m_CurrentPixelQueue
-	auto FindPosCurrent = [this](pixelcoord row, pixelcoord col)
+	// Helper function to find a pixel in m_CurrentPixelQueue (returns nullptr if it is not there)
+	auto FindPosCurrent = [this](pixelcoord row, pixelcoord col) -> PixelInfo*
 	{
-		return std::find_if(m_CurrentPixelQueue.begin(), m_CurrentPixelQueue.end(),
-			[row, col](const PixelInfo& pixel)
-			{ return pixel.Index[0] == row && pixel.Index[1] == col; });
+		largecounter loc = FindPixel(row, col);
+		return (loc != LARGECOUNTER_MAX && loc >= m_AllPixels.size()) ? &m_CurrentPixelQueue[loc - m_AllPixels.size()] : nullptr;
 	};
 
 	// We are subdividing this pixel, so we increase the subdivision level
@@ -418,13 +554,13 @@ void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 	row = m_AllPixels[ind].Index[0];
 	col = m_AllPixels[ind].Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	auto newpos = FindPosBefore(row, col);
-	if (newpos == m_AllPixels.end())
+	if (newpos == nullptr)
 	{
 		// New pixel to integrate; weight is automatically 0
 		// Only add to queue if not already in queue! If already in queue, check to make sure subdivision is set correctly
 		auto curpos = FindPosCurrent(row, col);
-		if (curpos == m_CurrentPixelQueue.end())
-			m_CurrentPixelQueue.push_back(PixelInfo(ScreenIndex{ row, col }, newsubdiv));
+		if (curpos == nullptr)
+			QueuePixel(ScreenIndex{ row, col }, newsubdiv);
 		else
 		{
 			curpos->SubdivideLevel = std::max(curpos->SubdivideLevel, newsubdiv);
@@ -443,13 +579,13 @@ void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 	row = m_AllPixels[ind].Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	col = m_AllPixels[ind].Index[1];
 	newpos = FindPosBefore(row, col);
-	if (newpos == m_AllPixels.end())
+	if (newpos == nullptr)
 	{
 		// New pixel to integrate; weight is automatically 0
 		// Only add to queue if not already in queue! If already in queue, check to make sure subdivision is set correctly
 		auto curpos = FindPosCurrent(row, col);
-		if (curpos == m_CurrentPixelQueue.end())
-			m_CurrentPixelQueue.push_back(PixelInfo(ScreenIndex{ row, col }, newsubdiv));
+		if (curpos == nullptr)
+			QueuePixel(ScreenIndex{ row, col }, newsubdiv);
 		else
 		{
 			curpos->SubdivideLevel = std::max(curpos->SubdivideLevel, newsubdiv);
@@ -468,13 +604,13 @@ void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 	row = m_AllPixels[ind].Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	col = m_AllPixels[ind].Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	newpos = FindPosBefore(row, col);
-	if (newpos == m_AllPixels.end())
+	if (newpos == nullptr)
 	{
 		// New pixel to integrate; weight is automatically -1
 		// Only add to queue if not already in queue! If already in queue, check to make sure subdivision is set correctly
 		auto curpos = FindPosCurrent(row, col);
-		if (curpos == m_CurrentPixelQueue.end())
-			m_CurrentPixelQueue.push_back(PixelInfo(ScreenIndex{ row, col }, newsubdiv));
+		if (curpos == nullptr)
+			QueuePixel(ScreenIndex{ row, col }, newsubdiv);
 		else
 		{
 			curpos->SubdivideLevel = std::max(curpos->SubdivideLevel, newsubdiv);
@@ -493,13 +629,13 @@ void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 	row = m_AllPixels[ind].Index[0] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
 	col = m_AllPixels[ind].Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	newpos = FindPosBefore(row, col);
-	if (newpos == m_AllPixels.end())
+	if (newpos == nullptr)
 	{
 		// New pixel to integrate; weight is automatically 0;
 		// subdivision = 0 because no neighbors!
 		// Only add to queue if not already in queue!
-		if (FindPosCurrent(row, col) == m_CurrentPixelQueue.end())
-			m_CurrentPixelQueue.push_back(PixelInfo(ScreenIndex{ row, col }, 0));
+		if (FindPosCurrent(row, col) == nullptr)
+			QueuePixel(ScreenIndex{ row, col }, 0);
 	}
 	// no else: no new neighbors for this pixel!
 
@@ -507,13 +643,13 @@ void SquareSubdivisionMesh::SubdivideAndQueue(largecounter ind)
 	row = m_AllPixels[ind].Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
 	col = m_AllPixels[ind].Index[1] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
 	newpos = FindPosBefore(row, col);
-	if (newpos == m_AllPixels.end())
+	if (newpos == nullptr)
 	{
 		// New pixel to integrate; weight is automatically -1
 		// subdivision = 0 because no neighbor!
 		// Only add to queue if not already in queue!
-		if (FindPosCurrent(row, col) == m_CurrentPixelQueue.end())
-			m_CurrentPixelQueue.push_back(PixelInfo(ScreenIndex{ row, col }, 0));
+		if (FindPosCurrent(row, col) == nullptr)
+			QueuePixel(ScreenIndex{ row, col }, 0);
 	}
 	// no else: no new neighbor for this pixel!
 
@@ -621,6 +757,7 @@ void SquareSubdivisionMesh::EndCurrentLoop()
 		ScreenOutput("Setting up subdivided pixels for integration...", OutputLevel::Level_3_ALLDETAIL);
 		// At most, we will be creating 5x this number of new pixels to integrate
 		m_CurrentPixelQueue.reserve(5 * DivideVertexIndices.size());
+		m_PixelLocations.reserve(m_AllPixels.size() + 5 * DivideVertexIndices.size());
 		// Populate the queue with <=5*m_IterationPixels to integrate
 		for (largecounter ind : DivideVertexIndices)
 		{
@@ -630,7 +767,12 @@ void SquareSubdivisionMesh::EndCurrentLoop()
 		// If the total queue we have created is too large, truncate it
 		// We choose to delete the last elements. These should be the least important in the queue due to the ordering process above.
 		if (!m_InfinitePixels && m_CurrentPixelQueue.size() > m_PixelsLeft)
+		{
+			// (these pixels also need to be removed from the pixel index)
+			for (auto it = m_CurrentPixelQueue.begin() + m_PixelsLeft; it != m_CurrentPixelQueue.end(); ++it)
+				m_PixelLocations.erase(PixelKey(it->Index[0], it->Index[1]));
 			m_CurrentPixelQueue.erase(m_CurrentPixelQueue.begin() + m_PixelsLeft, m_CurrentPixelQueue.end());
+		}
 
 		// Queue is constructed now, make sure to subtract the pixels in the queue from the total we have left
 		if (!m_InfinitePixels)
@@ -666,22 +808,51 @@ largecounter SquareSubdivisionMeshV2::getCurNrGeodesics() const
 void SquareSubdivisionMeshV2::getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const
 {
 	// Returning the geodesic with the appropriate index in the current queue
-	newscreenindex = m_CurrentPixelQueue[index]->Index;
+	newscreenindex = Pixel(m_CurrentPixelQueue[index]).Index;
 	// Return a 2D ScreenPoint (x,y) with both coordinates between 0 and 1, where 0 and 1 represent the edges of the viewscreen
 	newunitpoint = ScreenPoint{ newscreenindex[0] * 1.0 / static_cast<real>(m_RowColumnSize - 1),
 		newscreenindex[1] * 1.0 / static_cast<real>(m_RowColumnSize - 1) };
 }
 
-void SquareSubdivisionMeshV2::GeodesicFinished(largecounter index, std::vector<real> finalValues)
+void SquareSubdivisionMeshV2::GeodesicFinished(largecounter index, const std::vector<real>& finalValues)
 {
 	// NOTE: this function must be thread-safe!
 	// This means all the changes it makes are to values in a vector, never re-shaping the vector!
 	// "Concurrently accessing or modifying different elements is safe." (from cplusplus.com std::vector::operator[])
-	
+
+	// The first geodesic to finish tells us how many values the value Diagnostic returns, so that we can allocate
+	// the value store now (any other thread arriving here waits until this is done)
+	std::call_once(m_ValueStrideSet, [this, &finalValues]()
+		{
+			m_ValueStride = finalValues.size();
+			for (std::size_t blocknr = 0; blocknr < m_PixelBlocks.size(); ++blocknr)
+				AllocateValueBlock(blocknr);
+		});
 	// Set this pixel's values to the returned values
-	m_CurrentPixelQueue[index]->DiagValue = std::move(finalValues);
+	// (if there are too few, the remaining ones are set to zero; if there are too many, the extra ones are ignored)
+	real* pixelvalues{ PixelValues(m_CurrentPixelQueue[index]) };
+	if (finalValues.size() != m_ValueStride)
+	{
+		ScreenOutput("Value Diagnostic returned " + std::to_string(finalValues.size()) + " values instead of "
+			+ std::to_string(m_ValueStride) + "!", OutputLevel::Level_0_WARNING);
+		std::fill(pixelvalues, pixelvalues + m_ValueStride, 0.0);
+	}
+	std::copy_n(finalValues.begin(), std::min<std::size_t>(finalValues.size(), m_ValueStride), pixelvalues);
 	// This pixels is now done
 	m_CurrentPixelQueueDone[index] = true;
+
+	// If we are pipelining weights, all pixels whose weight depended on this pixel now have one less value to wait for;
+	// the thread that delivers the last value calculates the weight.
+	// Note: the decrement of the atomic counter makes sure the values set by other threads are visible
+	// to the thread that calculates the weight
+	if (m_PipelinedWeights && !m_CurrentPixelDependents.empty())
+	{
+		for (PixelId pixel : m_CurrentPixelDependents[index])
+		{
+			if (--(Pixel(pixel).PendingValues) == 0)
+				UpdateWeight(pixel);
+		}
+	}
 }
 
 
@@ -703,9 +874,150 @@ std::string SquareSubdivisionMeshV2::getFullDescriptionStr() const
 		+ "; max total pixels: " + (m_InfinitePixels ? "infinite" : std::to_string(m_MaxPixels))
 		+ "; if pixel is initially subdivided, will continue to max: " + std::to_string(m_InitialSubDividideToFinal)
 		+ "; row/column size: " + std::to_string(m_RowColumnSize)
+		+ (m_PipelinedWeights ? "; pipelined weights" : "")
 		+ ")";
 }
 
+// The information about a single pixel as it is stored in a checkpoint
+// (PixelInfo itself cannot be written directly, as it contains an atomic)
+struct SquareSubdivisionMeshV2CheckpointPixel
+{
+	std::uint64_t Index[2];
+	std::int32_t SubdivideLevel;
+	std::uint32_t Neighbors[5];
+	real Weight;
+};
+
+bool SquareSubdivisionMeshV2::SaveCheckpoint(std::ostream& out) const
+{
+	// NOTE: this is called between iterations: the current queue has been set up, but nothing has been integrated yet
+
+	// Some of the options, to make sure the checkpoint is loaded into a compatible Mesh
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_RowColumnSize));
+	Checkpoint::Write(out, static_cast<std::int32_t>(m_MaxSubdivide));
+
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_PixelsLeft));
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_PixelsIntegrated));
+	Checkpoint::Write(out, m_NrPixels);
+	Checkpoint::Write(out, static_cast<std::uint64_t>(m_ValueStride));
+
+	// All pixels and their values, block by block
+	std::vector<SquareSubdivisionMeshV2CheckpointPixel> savedpixels{};
+	std::vector<real> savedvalues{};
+	for (PixelId blockstart = 0; blockstart < m_NrPixels; blockstart += std::min(PixelBlockSize, m_NrPixels - blockstart))
+	{
+		const PixelId blockend{ blockstart + std::min(PixelBlockSize, m_NrPixels - blockstart) };
+		savedpixels.clear();
+		for (PixelId id = blockstart; id < blockend; ++id)
+		{
+			const PixelInfo& thePixel{ Pixel(id) };
+			savedpixels.push_back(SquareSubdivisionMeshV2CheckpointPixel{ { thePixel.Index[0], thePixel.Index[1] },
+				thePixel.SubdivideLevel,
+				{ thePixel.LeftNbr, thePixel.RightNbr, thePixel.UpNbr, thePixel.DownNbr, thePixel.SEdiagNbr },
+				thePixel.Weight });
+		}
+		Checkpoint::WriteVector(out, savedpixels);
+
+		if (m_ValueStride > 0)
+		{
+			savedvalues.assign(PixelValues(blockstart), PixelValues(blockstart) + (blockend - blockstart) * m_ValueStride);
+			Checkpoint::WriteVector(out, savedvalues);
+		}
+	}
+
+	Checkpoint::WriteVector(out, m_ActivePixels);
+	Checkpoint::WriteVector(out, m_CurrentPixelQueue);
+	Checkpoint::WriteVector(out, m_CurrentPixelUpdating);
+
+	return static_cast<bool>(out);
+}
+
+bool SquareSubdivisionMeshV2::LoadCheckpoint(std::istream& in)
+{
+	std::uint64_t rowcolumnsize{}, pixelsleft{}, pixelsintegrated{}, valuestride{};
+	std::int32_t maxsubdivide{};
+	PixelId nrpixels{};
+	if (!Checkpoint::Read(in, rowcolumnsize) || !Checkpoint::Read(in, maxsubdivide)
+		|| !Checkpoint::Read(in, pixelsleft) || !Checkpoint::Read(in, pixelsintegrated)
+		|| !Checkpoint::Read(in, nrpixels) || !Checkpoint::Read(in, valuestride))
+		return false;
+
+	if (rowcolumnsize != m_RowColumnSize || maxsubdivide != m_MaxSubdivide)
+	{
+		ScreenOutput("Checkpoint was made with a Mesh with different options!", OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	// Throw away the initial grid that was set up by the constructor
+	m_PixelBlocks.clear();
+	m_ValueBlocks.clear();
+	m_NrPixels = 0;
+	m_ActivePixels.clear();
+	m_CurrentPixelUpdating.clear();
+	m_CurrentPixelDependents.clear();
+
+	// The number of values per pixel is known already (the value store is allocated along with the pixel blocks)
+	if (valuestride > 0)
+	{
+		if (m_ValueStride > 0 && m_ValueStride != valuestride)
+			return false;
+		std::call_once(m_ValueStrideSet, [this, valuestride]() { m_ValueStride = static_cast<std::size_t>(valuestride); });
+	}
+
+	m_PixelsLeft = static_cast<largecounter>(pixelsleft);
+	m_PixelsIntegrated = static_cast<largecounter>(pixelsintegrated);
+
+	// All pixels and their values, block by block
+	ReservePixels(nrpixels);
+	m_NrPixels = nrpixels;
+	std::vector<SquareSubdivisionMeshV2CheckpointPixel> savedpixels{};
+	std::vector<real> savedvalues{};
+	for (PixelId blockstart = 0; blockstart < m_NrPixels; blockstart += std::min(PixelBlockSize, m_NrPixels - blockstart))
+	{
+		const PixelId blockend{ blockstart + std::min(PixelBlockSize, m_NrPixels - blockstart) };
+		if (!Checkpoint::ReadVector(in, savedpixels) || savedpixels.size() != blockend - blockstart)
+			return false;
+		for (PixelId id = blockstart; id < blockend; ++id)
+		{
+			const SquareSubdivisionMeshV2CheckpointPixel& saved{ savedpixels[id - blockstart] };
+			PixelInfo& thePixel{ Pixel(id) };
+			thePixel.Index = ScreenIndex{ static_cast<largecounter>(saved.Index[0]), static_cast<largecounter>(saved.Index[1]) };
+			thePixel.SubdivideLevel = saved.SubdivideLevel;
+			thePixel.LeftNbr = saved.Neighbors[0];
+			thePixel.RightNbr = saved.Neighbors[1];
+			thePixel.UpNbr = saved.Neighbors[2];
+			thePixel.DownNbr = saved.Neighbors[3];
+			thePixel.SEdiagNbr = saved.Neighbors[4];
+			thePixel.Weight = saved.Weight;
+		}
+
+		if (m_ValueStride > 0)
+		{
+			if (!Checkpoint::ReadVector(in, savedvalues) || savedvalues.size() != (blockend - blockstart) * m_ValueStride)
+				return false;
+			std::copy(savedvalues.begin(), savedvalues.end(), PixelValues(blockstart));
+		}
+	}
+
+	if (!Checkpoint::ReadVector(in, m_ActivePixels) || !Checkpoint::ReadVector(in, m_CurrentPixelQueue)
+		|| !Checkpoint::ReadVector(in, m_CurrentPixelUpdating))
+		return false;
+
+	// Every pixel that we refer to must exist
+	for (const std::vector<PixelId>* list : { &m_ActivePixels, &m_CurrentPixelQueue, &m_CurrentPixelUpdating })
+	{
+		if (std::any_of(list->begin(), list->end(), [this](PixelId pixel) { return pixel >= m_NrPixels; }))
+			return false;
+	}
+
+	// The current queue is ready for integration (exactly as it was when the checkpoint was made)
+	m_CurrentPixelQueueDone = std::vector<char>(m_CurrentPixelQueue.size(), false);
+	if (m_PipelinedWeights)
+		SetUpWeightDependencies();
+
+	return true;
+}
+
 // Helper (private) member function
 pixelcoord SquareSubdivisionMeshV2::ExpInt(int base, int exp) const
 {
@@ -720,6 +1032,41 @@ pixelcoord SquareSubdivisionMeshV2::ExpInt(int base, int exp) const
 	return ret;
 }
 
+// Helper (private) member function
+void SquareSubdivisionMeshV2::ReservePixels(largecounter nrpixels)
+{
+	// Add blocks to the pixel store until there is room
+	while (static_cast<largecounter>(m_PixelBlocks.size()) * PixelBlockSize < m_NrPixels + nrpixels)
+	{
+		m_PixelBlocks.push_back(std::make_unique<PixelInfo[]>(PixelBlockSize));
+		m_ValueBlocks.emplace_back();
+		// (if we do not know the number of values per pixel yet, this is allocated when the first geodesic is finished)
+		if (m_ValueStride > 0)
+			AllocateValueBlock(m_PixelBlocks.size() - 1);
+	}
+}
+
+// Helper (private) member function
+SquareSubdivisionMeshV2::PixelId SquareSubdivisionMeshV2::NewPixel(ScreenIndex ind, int subdiv)
+{
+	// The new pixel is the next one in the store (weight is automatically initialized to -1 and it has no neighbors)
+	PixelId id{};
+#pragma omp atomic capture
+	id = m_NrPixels++;
+
+	PixelInfo& pixel{ Pixel(id) };
+	pixel.Index = ind;
+	pixel.SubdivideLevel = subdiv;
+	return id;
+}
+
+// Helper (private) member function
+void SquareSubdivisionMeshV2::AllocateValueBlock(std::size_t blocknr)
+{
+	if (!m_ValueBlocks[blocknr])
+		m_ValueBlocks[blocknr] = std::make_unique<real[]>(PixelBlockSize * m_ValueStride);
+}
+
 //////////////////////////////////////////////////////////////
 //// Important SquareSubdivisionMeshV2 functions start here ////
 
@@ -731,12 +1078,9 @@ void SquareSubdivisionMeshV2::InitializeFirstGrid()
 	pixelcoord initRowColSize = static_cast<pixelcoord>(sqrt(m_InitialPixels));
 	m_CurrentPixelQueue.reserve(m_InitialPixels);
 
-	// Initialize grid of empty pixels, to be filled
-	std::vector<std::vector<std::unique_ptr<PixelInfo>>> m_InitialGrid(initRowColSize);
-	for (largecounter i = 0; i < initRowColSize; ++i)
-		m_InitialGrid[i] = std::vector<std::unique_ptr<PixelInfo>>(initRowColSize);
-
-	// Fill grid with pixels
+	// Create the grid of pixels (row by row)
+	ReservePixels(m_InitialPixels);
+	std::vector<PixelId> initialGrid(m_InitialPixels);
 	for (pixelcoord row = 0; row < initRowColSize; ++row)
 	{
 		for (pixelcoord column = 0; column < initRowColSize; ++column)
@@ -751,9 +1095,11 @@ void SquareSubdivisionMeshV2::InitializeFirstGrid()
 			// Note that the actual ScreenIndex that the pixel gets put at depends on the max
 			// level of subdivision: we are keeping room for all of the potential future pixels 
 			// that can come in between the initial grid!
-			m_InitialGrid[row][column] = std::make_unique<PixelInfo>(ExpInt(2, m_MaxSubdivide - 1) * ScreenIndex { row, column }, subdiv);
+			initialGrid[row * initRowColSize + column] = NewPixel(ExpInt(2, m_MaxSubdivide - 1) * ScreenIndex{ row, column }, subdiv);
 		}
 	}
+	auto GridPixel = [this, &initialGrid, initRowColSize](pixelcoord row, pixelcoord column) -> PixelInfo&
+		{ return Pixel(initialGrid[row * initRowColSize + column]); };
 
 	// Now, we need to update everybody's neighbors accordingly
 	// Note that right/down/SEdiag neighbors are ONLY defined if the pixel is a pixel that can be subdivided;
@@ -765,32 +1111,25 @@ void SquareSubdivisionMeshV2::InitializeFirstGrid()
 		{
 			// Pixel has right/down neighbors, set them and the reciprocals
 
-			m_InitialGrid[row][column]->RightNbr = m_InitialGrid[row][column + 1].get();
-			m_InitialGrid[row][column + 1]->LeftNbr = m_InitialGrid[row][column].get();
+			GridPixel(row, column).RightNbr = initialGrid[row * initRowColSize + column + 1];
+			GridPixel(row, column + 1).LeftNbr = initialGrid[row * initRowColSize + column];
 
-			m_InitialGrid[row][column]->DownNbr = m_InitialGrid[row + 1][column].get();
-			m_InitialGrid[row + 1][column]->UpNbr = m_InitialGrid[row][column].get();
+			GridPixel(row, column).DownNbr = initialGrid[(row + 1) * initRowColSize + column];
+			GridPixel(row + 1, column).UpNbr = initialGrid[row * initRowColSize + column];
 
-			m_InitialGrid[row][column]->SEdiagNbr = m_InitialGrid[row + 1][column + 1].get();
+			GridPixel(row, column).SEdiagNbr = initialGrid[(row + 1) * initRowColSize + column + 1];
 		}
 	}
 
-	// Finally, we move the ownership of all pixels to the master pixel collection
-	// and we add all pixels to the integration list and weight-updating list (if applicable)
-	for (pixelcoord row = 0; row < initRowColSize; ++row)
+	// Finally, we add all pixels to the integration list and weight-updating list (if applicable)
+	for (PixelId pixel : initialGrid)
 	{
-		for (pixelcoord column = 0; column < initRowColSize; ++column)
-		{
-			// This pixel must be integrated
-			m_CurrentPixelQueue.push_back(m_InitialGrid[row][column].get());
-
-			// If this pixel can be subdivided, it needs weight updating after integration
-			if (m_InitialGrid[row][column]->SubdivideLevel < m_MaxSubdivide)
-				m_CurrentPixelUpdating.push_back(m_InitialGrid[row][column].get());
+		// This pixel must be integrated
+		m_CurrentPixelQueue.push_back(pixel);
 
-			// Transfer ownership to master pixel collection
-			m_AllPixels.push_front(std::move(m_InitialGrid[row][column]));
-		}
+		// If this pixel can be subdivided, it needs weight updating after integration
+		if (Pixel(pixel).SubdivideLevel < m_MaxSubdivide)
+			m_CurrentPixelUpdating.push_back(pixel);
 	}
 
 	// Subtract the number of pixels we are integrating from the pixels we are allowed to integrate
@@ -798,7 +1137,11 @@ void SquareSubdivisionMeshV2::InitializeFirstGrid()
 		m_PixelsLeft -= static_cast<largecounter>(m_CurrentPixelQueue.size());
 
 	// All pixels have not been integrated yet
-	m_CurrentPixelQueueDone = std::vector<bool>(m_CurrentPixelQueue.size(), false);
+	m_CurrentPixelQueueDone = std::vector<char>(m_CurrentPixelQueue.size(), false);
+
+	// Figure out which weights can be calculated when each pixel is done
+	if (m_PipelinedWeights)
+		SetUpWeightDependencies();
 }
 
 
@@ -812,25 +1155,30 @@ void SquareSubdivisionMeshV2::UpdateAllWeights()
 	ScreenOutput("Updating pixel weights for " + std::to_string(m_CurrentPixelUpdating.size()) + " pixels...",
 		OutputLevel::Level_3_ALLDETAIL);
 
-	for (PixelInfo* pixel : m_CurrentPixelUpdating) // loop through all pixels that need weight updating
+	// First, calculate all weights in parallel.
+	// Note: this is called from within a single thread in the parallel region of main(), so the other threads
+	// (waiting at the end of the single region) will pick up these tasks.
+	// (A pixel can appear more than once in m_CurrentPixelUpdating, so we do not write the weights to the pixels yet.)
+	const largecounter nrpixels{ static_cast<largecounter>(m_CurrentPixelUpdating.size()) };
+	std::vector<real> weights(nrpixels);
+#pragma omp taskloop shared(weights)
+	for (largecounter i = 0; i < nrpixels; ++i) // loop through all pixels that need weight updating
 	{
-		std::array<real, 3> distances{};
-
-		// distance: (up-left) - (up-right)
-		distances[0] = m_DistanceDiagnostic->FinalDataValDistance(pixel->DiagValue, pixel->RightNbr->DiagValue);
-
-		// distance: (up-left) - (down-left)
-		distances[1] = m_DistanceDiagnostic->FinalDataValDistance(pixel->DiagValue, pixel->DownNbr->DiagValue);
-
-		// distance: (up-left) - (down-right)
-			// The pixel's right neighbor is not on the rightmost border
-		distances[2] = m_DistanceDiagnostic->FinalDataValDistance(pixel->DiagValue, pixel->SEdiagNbr->DiagValue);
+		const PixelId pixel{ m_CurrentPixelUpdating[i] };
+		// If we are pipelining weights, the weight has already been calculated when its last value came in,
+		// except for pixels that were waiting on pixels that were never integrated
+		if (!m_PipelinedWeights || Pixel(pixel).PendingValues != 0)
+			weights[i] = CalculateWeight(pixel);
+		else
+			weights[i] = Pixel(pixel).Weight;
+	}
 
-		// Assign as weight the max of these three different distances
-		pixel->Weight = *std::max_element(distances.begin(), distances.end());
-		if (pixel->Weight > 0.0)
+	for (largecounter i = 0; i < nrpixels; ++i)
+	{
+		Pixel(m_CurrentPixelUpdating[i]).Weight = weights[i];
+		if (weights[i] > 0.0)
 		{
-			m_ActivePixels.push_back(pixel);
+			m_ActivePixels.push_back(m_CurrentPixelUpdating[i]);
 		}
 	}
 
@@ -841,24 +1189,175 @@ void SquareSubdivisionMeshV2::UpdateAllWeights()
 }
 
 
-SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetUp(PixelInfo* p, int subdiv) const
+// Helper function: calculates the weight of a single pixel
+// Note: this must be thread-safe, as it is called from GeodesicFinished() when pipelining weights
+real SquareSubdivisionMeshV2::CalculateWeight(PixelId pixel) const
+{
+	const PixelInfo& thePixel{ Pixel(pixel) };
+
+	// The distance Diagnostic compares values given as vectors; we copy the values from the value store into these
+	// (they are kept for every thread, so that this does not allocate memory for every weight that is calculated)
+	thread_local std::vector<real> values{};
+	thread_local std::vector<real> nbrvalues{};
+	auto LoadValues = [this](std::vector<real>& vals, PixelId id)
+	{
+		const real* firstval{ PixelValues(id) };
+		vals.assign(firstval, firstval + m_ValueStride);
+	};
+	LoadValues(values, pixel);
+
+	std::array<real, 3> distances{};
+
+	// distance: (up-left) - (up-right)
+	LoadValues(nbrvalues, thePixel.RightNbr);
+	distances[0] = m_DistanceDiagnostic->FinalDataValDistance(values, nbrvalues);
+
+	// distance: (up-left) - (down-left)
+	LoadValues(nbrvalues, thePixel.DownNbr);
+	distances[1] = m_DistanceDiagnostic->FinalDataValDistance(values, nbrvalues);
+
+	// distance: (up-left) - (down-right)
+	LoadValues(nbrvalues, thePixel.SEdiagNbr);
+	distances[2] = m_DistanceDiagnostic->FinalDataValDistance(values, nbrvalues);
+
+	// The weight is the max of these three different distances
+	return *std::max_element(distances.begin(), distances.end());
+}
+
+void SquareSubdivisionMeshV2::UpdateWeight(PixelId pixel)
+{
+	Pixel(pixel).Weight = CalculateWeight(pixel);
+}
+
+
+// Helper function: the order in which we want to subdivide pixels
+bool SquareSubdivisionMeshV2::MoreImportant(PixelId id1, PixelId id2) const
+{
+	const PixelInfo& p1{ Pixel(id1) };
+	const PixelInfo& p2{ Pixel(id2) };
+	if (p1.Weight != p2.Weight)
+		return p1.Weight > p2.Weight;
+	// In the case of equal weight, give precedence to less-subdivided pixels
+	if (p1.SubdivideLevel != p2.SubdivideLevel)
+		return p1.SubdivideLevel < p2.SubdivideLevel;
+	// Finally, order pixels with equal weight and subdivision level by their screen index.
+	// Note: this is a deliberate change in which pixels are subdivided compared to sorting the full list of active pixels
+	// with only the two criteria above. The selection below splits m_ActivePixels over the threads, so without a total order
+	// the pixels chosen among equally important ones (and their order in the queue) would depend on the number of threads.
+	return p1.Index < p2.Index;
+}
+
+
+// Helper function: puts the nrpixels most important pixels in m_ActivePixels at the front, in order of importance
+// (if some pixels appear more than once in m_ActivePixels, this can be more than nrpixels pixels)
+void SquareSubdivisionMeshV2::SelectPixelsToSubdivide(largecounter nrpixels)
+{
+	auto Comp = [this](PixelId id1, PixelId id2) { return MoreImportant(id1, id2); };
+
+	const largecounter nractive{ static_cast<largecounter>(m_ActivePixels.size()) };
+	if (nrpixels == 0)
+		return;
+	if (nrpixels >= nractive)
+	{
+		std::sort(m_ActivePixels.begin(), m_ActivePixels.end(), Comp);
+		return;
+	}
+
+	// We only need the first nrpixels pixels, so there is no need to sort all of m_ActivePixels.
+	// First, every thread finds the nrpixels most important pixels in its own part of m_ActivePixels;
+	// the nrpixels most important pixels overall are among these candidates.
+	// Note: this is called from within a single thread in the parallel region of main(), so the other threads
+	// (waiting at the end of the single region) will pick up these tasks.
+	const largecounter nrparts{ std::min(static_cast<largecounter>(omp_get_num_threads()), nractive / nrpixels) };
+	const largecounter partsize{ (nractive + nrparts - 1) / nrparts };
+	std::vector<PixelId> candidates(nrparts * nrpixels, NoPixel);
+#pragma omp taskloop shared(candidates)
+	for (largecounter part = 0; part < nrparts; ++part)
+	{
+		auto partbegin{ m_ActivePixels.begin() + std::min(part * partsize, nractive) };
+		auto partend{ m_ActivePixels.begin() + std::min((part + 1) * partsize, nractive) };
+		largecounter nrbest{ std::min(nrpixels, static_cast<largecounter>(partend - partbegin)) };
+		if (nrbest == 0)
+			continue;
+		std::nth_element(partbegin, partbegin + (nrbest - 1), partend, Comp);
+		std::copy(partbegin, partbegin + nrbest, candidates.begin() + part * nrpixels);
+	}
+	candidates.erase(std::remove(candidates.begin(), candidates.end(), NoPixel), candidates.end());
+
+	// The least important of the nrpixels pixels we want
+	std::nth_element(candidates.begin(), candidates.begin() + (nrpixels - 1), candidates.end(), Comp);
+	const PixelId lastpixel{ candidates[nrpixels - 1] };
+
+	// Move all pixels that are at least as important as this one to the front, and put those in order
+	auto selectedend = std::partition(m_ActivePixels.begin(), m_ActivePixels.end(),
+		[this, lastpixel](PixelId id) { return !MoreImportant(lastpixel, id); });
+	std::sort(m_ActivePixels.begin(), selectedend, Comp);
+}
+
+
+// Helper function: for pipelined weights, figures out for every pixel in the current queue which weights
+// depend on it, and how many values each pixel in m_CurrentPixelUpdating still has to wait for
+void SquareSubdivisionMeshV2::SetUpWeightDependencies()
+{
+	m_CurrentPixelDependents.clear();
+
+	// If no pixels are left to integrate after the current queue, the weights will never be needed
+	// (and some of the neighbors might never be integrated at all, if the queue has been truncated)
+	if (!m_InfinitePixels && m_PixelsLeft == 0)
+		return;
+
+	for (largecounter i = 0; i < m_CurrentPixelQueue.size(); ++i)
+		Pixel(m_CurrentPixelQueue[i]).QueueIndex = static_cast<PixelId>(i);
+
+	m_CurrentPixelDependents = std::vector<std::vector<PixelId>>(m_CurrentPixelQueue.size());
+
+	// Mark all pixels as not set up yet (this makes sure that we set up pixels only once,
+	// even if they appear more than once in m_CurrentPixelUpdating)
+	for (PixelId pixel : m_CurrentPixelUpdating)
+		Pixel(pixel).PendingValues = -1;
+
+	for (PixelId pixel : m_CurrentPixelUpdating)
+	{
+		PixelInfo& thePixel{ Pixel(pixel) };
+		if (thePixel.PendingValues != -1)
+			continue;
+
+		int pending{ 0 };
+		for (PixelId valuepixel : { pixel, thePixel.RightNbr, thePixel.DownNbr, thePixel.SEdiagNbr })
+		{
+			if (Pixel(valuepixel).QueueIndex != NoPixel)
+			{
+				m_CurrentPixelDependents[Pixel(valuepixel).QueueIndex].push_back(pixel);
+				++pending;
+			}
+		}
+		thePixel.PendingValues = pending;
+
+		// All values are known already, so we can calculate the weight right away
+		if (pending == 0)
+			UpdateWeight(pixel);
+	}
+}
+
+
+SquareSubdivisionMeshV2::PixelId SquareSubdivisionMeshV2::GetUp(PixelId p, int subdiv) const
 {
 	// p does not exist, it does not have the necessary neighbor,
 	// or the neighbor lives at a subdivision level that is too low
 	// Note that the up-neighbors are defined to be reciprocal with the down-neighbor,
 	// therefore we must check the NEIGHBOR's subdivide level (and not p's)!
-	if (!p || !p->UpNbr || p->UpNbr->SubdivideLevel < subdiv)
-		return nullptr;
+	if (p == NoPixel || Pixel(p).UpNbr == NoPixel || Pixel(Pixel(p).UpNbr).SubdivideLevel < subdiv)
+		return NoPixel;
 	else
 	{
-		if (p->UpNbr->SubdivideLevel == subdiv)
+		if (Pixel(Pixel(p).UpNbr).SubdivideLevel == subdiv)
 		{
 			// The sought-after neighbor is precisely one step away
-			return p->UpNbr;
+			return Pixel(p).UpNbr;
 		}
 		else
 		{
-			// Here, necessarily p->UpNbr->SubdivideLevel > subdiv
+			// Here, necessarily the neighbor's SubdivideLevel > subdiv
 			// This means p is subdivided to a higher level than we want
 			// In this case, we must travel over this finer grid to find the pixel we are looking for
 			return GetUp(GetUp(p, subdiv + 1), subdiv + 1);
@@ -866,22 +1365,22 @@ SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetUp(PixelInfo* p,
 	}	
 }
 
-SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetDown(PixelInfo* p, int subdiv) const
+SquareSubdivisionMeshV2::PixelId SquareSubdivisionMeshV2::GetDown(PixelId p, int subdiv) const
 {
 	// p does not exist, it does not have the necessary neighbor,
 	// or the neighbor lives at a subdivision level that is too low
-	if (!p || !p->DownNbr || p->SubdivideLevel < subdiv)
-		return nullptr;
+	if (p == NoPixel || Pixel(p).DownNbr == NoPixel || Pixel(p).SubdivideLevel < subdiv)
+		return NoPixel;
 	else
 	{
-		if (p->SubdivideLevel == subdiv)
+		if (Pixel(p).SubdivideLevel == subdiv)
 		{
 			// The sought-after neighbor is precisely one step away
-			return p->DownNbr;
+			return Pixel(p).DownNbr;
 		}
 		else
 		{
-			// Here, necessarily p->SubdivideLevel > subdiv
+			// Here, necessarily p's SubdivideLevel > subdiv
 			// This means p is subdivided to a higher level than we want
 			// In this case, we must travel over this finer grid to find the pixel we are looking for
 			return GetDown(GetDown(p, subdiv + 1), subdiv + 1);
@@ -889,24 +1388,24 @@ SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetDown(PixelInfo*
 	}
 }
 
-SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetLeft(PixelInfo* p, int subdiv) const
+SquareSubdivisionMeshV2::PixelId SquareSubdivisionMeshV2::GetLeft(PixelId p, int subdiv) const
 {
 	// p does not exist, it does not have the necessary neighbor,
 	// or the neighbor lives at a subdivision level that is too low
 	// Note that the left-neighbors are defined to be reciprocal with the right-neighbor,
 	// therefore we must check the NEIGHBOR's subdivide level (and not p's)!
-	if (!p || !p->LeftNbr || p->LeftNbr->SubdivideLevel < subdiv)
-		return nullptr;
+	if (p == NoPixel || Pixel(p).LeftNbr == NoPixel || Pixel(Pixel(p).LeftNbr).SubdivideLevel < subdiv)
+		return NoPixel;
 	else
 	{
-		if (p->LeftNbr->SubdivideLevel == subdiv)
+		if (Pixel(Pixel(p).LeftNbr).SubdivideLevel == subdiv)
 		{
 			// The sought-after neighbor is precisely one step away
-			return p->LeftNbr;
+			return Pixel(p).LeftNbr;
 		}
 		else
 		{
-			// Here, necessarily p->LeftNbr->SubdivideLevel > subdiv
+			// Here, necessarily the neighbor's SubdivideLevel > subdiv
 			// This means p is subdivided to a higher level than we want
 			// In this case, we must travel over this finer grid to find the pixel we are looking for
 			return GetLeft(GetLeft(p, subdiv + 1), subdiv + 1);
@@ -914,22 +1413,22 @@ SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetLeft(PixelInfo*
 	}
 }
 
-SquareSubdivisionMeshV2::PixelInfo* SquareSubdivisionMeshV2::GetRight(PixelInfo* p, int subdiv) const
+SquareSubdivisionMeshV2::PixelId SquareSubdivisionMeshV2::GetRight(PixelId p, int subdiv) const
 {
 	// p does not exist, it does not have the necessary neighbor,
 	// or the neighbor lives at a subdivision level that is too low
-	if (!p || !p->RightNbr || p->SubdivideLevel < subdiv)
-		return nullptr;
+	if (p == NoPixel || Pixel(p).RightNbr == NoPixel || Pixel(p).SubdivideLevel < subdiv)
+		return NoPixel;
 	else
 	{
-		if (p->SubdivideLevel == subdiv)
+		if (Pixel(p).SubdivideLevel == subdiv)
 		{
 			// The sought-after neighbor is precisely one step away
-			return p->RightNbr;
+			return Pixel(p).RightNbr;
 		}	
 		else
 		{
-			// Here, necessarily p->SubdivideLevel > subdiv
+			// Here, necessarily p's SubdivideLevel > subdiv
 			// This means p is subdivided to a higher level than we want
 			// In this case, we must travel over this finer grid to find the pixel we are looking for
 			return GetRight(GetRight(p, subdiv + 1), subdiv + 1);
@@ -948,79 +1447,86 @@ void SquareSubdivisionMeshV2::SubdivideAndQueue(largecounter ind)
 	// 4 5 6
 	// 7 8 9
 	// i.e. the initial square is given by (1, 3, 7, 9), and the new pixels are (2, 4, 5, 6, 8).
-	PixelInfo* pixel1 = m_ActivePixels[ind];
-	PixelInfo* pixel3 = pixel1->RightNbr;
-	PixelInfo* pixel7 = pixel1->DownNbr;
-	PixelInfo* pixel9 = pixel1->SEdiagNbr;
+	// Note: references to pixels stay valid when new pixels are created, since pixels never move in the pixel store
+	const PixelId pixel1 = m_ActivePixels[ind];
+	PixelInfo& thePixel1{ Pixel(pixel1) };
+	const PixelId pixel3 = thePixel1.RightNbr;
+	const PixelId pixel7 = thePixel1.DownNbr;
+	const PixelId pixel9 = thePixel1.SEdiagNbr;
 
 	// We are subdividing this pixel, so we increase the subdivision level
-	int newsubdiv = pixel1->SubdivideLevel + 1;
+	int newsubdiv = thePixel1.SubdivideLevel + 1;
 	pixelcoord row{}, col{};
 
+	// Helper function: the pixel (if it is new in this iteration) needs to be put in the queue,
+	// at the latest in the place where this subdivision would put it (slot 0-4 for pixels 2, 4, 5, 6, 8)
+	auto QueueAt = [this, ind](PixelId pixel, largecounter slot)
+	{
+		if (pixel >= m_SubdivisionFirstNewPixel)
+		{
+			largecounter& queueslot{ m_SubdivisionQueueSlots[pixel - m_SubdivisionFirstNewPixel] };
+			queueslot = std::min(queueslot, 5 * ind + slot);
+		}
+	};
+
 
 	//// PIXELS 1, 2, 4, 5: these are pixels who can subdivide again,
 	// so we need to set their current subdivision level to newsubdiv
 
 	// PIXEL 1
 	// The pixel itself now has the new subdivision level
-	pixel1->SubdivideLevel = newsubdiv;
+	thePixel1.SubdivideLevel = newsubdiv;
 	if (newsubdiv < m_MaxSubdivide)
-		m_CurrentPixelUpdating.push_back(pixel1);
+		m_SubdivisionUpdating[4 * ind] = pixel1;
 
 	// PIXEL 2
 	// Does pixel 2 already exist? This could only be if it was created as part of a subdivided pixel
 	// at subdivision level newsubdiv immediately above the current pixel
-	PixelInfo* pixel2 = GetDown(GetRight(GetUp(pixel1, newsubdiv), newsubdiv), newsubdiv);
-	if (!pixel2) // pixel does not exist yet, so we need to create it and integrate it
+	PixelId pixel2 = GetDown(GetRight(GetUp(pixel1, newsubdiv), newsubdiv), newsubdiv);
+	if (pixel2 == NoPixel) // pixel does not exist yet, so we need to create it and integrate it
 	{
-		row = pixel1->Index[0];
-		col = pixel1->Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
-		m_AllPixels.push_front(std::make_unique<PixelInfo>(ScreenIndex{ row, col }, newsubdiv));
-		pixel2 = m_AllPixels.front().get();
-		m_CurrentPixelQueue.push_back(pixel2);
+		row = thePixel1.Index[0];
+		col = thePixel1.Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
+		pixel2 = NewPixel(ScreenIndex{ row, col }, newsubdiv);
 	}
 	else 
 	{
 		// pixel already exists, so just set its subdivision level now
 		// Note: pixel 2's correct subdivision level is always the one given by THIS subdivision (even if it had been created
 		// by a subdivision of a different pixel)
-		pixel2->SubdivideLevel = newsubdiv;
+		Pixel(pixel2).SubdivideLevel = newsubdiv;
 	}
 	if (newsubdiv < m_MaxSubdivide)
-		m_CurrentPixelUpdating.push_back(pixel2);
+		m_SubdivisionUpdating[4 * ind + 1] = pixel2;
 
 
 	// PIXEL 4
 	// Does pixel 4 already exist?
-	PixelInfo* pixel4 = GetRight(GetDown(GetLeft(pixel1, newsubdiv), newsubdiv), newsubdiv);
-	if (!pixel4) // pixel does not exist yet, so we need to create it and integrate it
+	PixelId pixel4 = GetRight(GetDown(GetLeft(pixel1, newsubdiv), newsubdiv), newsubdiv);
+	if (pixel4 == NoPixel) // pixel does not exist yet, so we need to create it and integrate it
 	{
-		row = pixel1->Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
-		col = pixel1->Index[1];
-		m_AllPixels.push_front(std::make_unique<PixelInfo>(ScreenIndex{ row, col }, newsubdiv));
-		pixel4 = m_AllPixels.front().get();
-		m_CurrentPixelQueue.push_back(pixel4);
+		row = thePixel1.Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
+		col = thePixel1.Index[1];
+		pixel4 = NewPixel(ScreenIndex{ row, col }, newsubdiv);
 	}
 	else
 	{
 		// pixel already exists, so just set its subdivision level now
 		// Note: pixel 4's correct subdivision level is always the one given by THIS subdivision (even if it had been created
 		// by a subdivision of a different pixel)
-		pixel4->SubdivideLevel = newsubdiv;
+		Pixel(pixel4).SubdivideLevel = newsubdiv;
 	}
 	if (newsubdiv < m_MaxSubdivide)
-		m_CurrentPixelUpdating.push_back(pixel4);
+		m_SubdivisionUpdating[4 * ind + 2] = pixel4;
 
 	
 	// PIXEL 5
 	// Pixel 5 will never exist already!
-	row = pixel1->Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
-	col = pixel1->Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
-	m_AllPixels.push_front(std::make_unique<PixelInfo>(ScreenIndex{ row, col }, newsubdiv));
-	PixelInfo* pixel5 = m_AllPixels.front().get();
-	m_CurrentPixelQueue.push_back(pixel5);
+	row = thePixel1.Index[0] + ExpInt(2, m_MaxSubdivide - newsubdiv);
+	col = thePixel1.Index[1] + ExpInt(2, m_MaxSubdivide - newsubdiv);
+	const PixelId pixel5 = NewPixel(ScreenIndex{ row, col }, newsubdiv);
 	if (newsubdiv < m_MaxSubdivide)
-		m_CurrentPixelUpdating.push_back(pixel5);
+		m_SubdivisionUpdating[4 * ind + 3] = pixel5;
 
 
 	//// PIXELS 3, 7, 9: these pixels exist already and do NOT need new updating of subdivision level or right/down nbrs
@@ -1029,60 +1535,63 @@ void SquareSubdivisionMeshV2::SubdivideAndQueue(largecounter ind)
 
 	// PIXEL 6
 	// Does pixel 6 already exist?
-	PixelInfo* pixel6 = GetDown(pixel3, newsubdiv);
-	if (!pixel6) // pixel does not exist yet, so we need to create it and integrate it
+	PixelId pixel6 = GetDown(pixel3, newsubdiv);
+	if (pixel6 == NoPixel) // pixel does not exist yet, so we need to create it and integrate it
 	{
-		row = pixel1->Index[0] +  ExpInt(2, m_MaxSubdivide - newsubdiv);
-		col = pixel1->Index[1] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
-		m_AllPixels.push_front(std::make_unique<PixelInfo>(ScreenIndex{ row, col }, 0));
-		pixel6 = m_AllPixels.front().get();
-		m_CurrentPixelQueue.push_back(pixel6);
+		row = thePixel1.Index[0] +  ExpInt(2, m_MaxSubdivide - newsubdiv);
+		col = thePixel1.Index[1] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
+		pixel6 = NewPixel(ScreenIndex{ row, col }, 0);
 	}
-	// no else to update subdivision level and no putting pixel 6 in m_CurrentPixelUpdating!
+	// no else to update subdivision level and no putting pixel 6 in m_SubdivisionUpdating!
 
 	// PIXEL 8
 	// Does pixel 8 already exist?
-	PixelInfo* pixel8 = GetRight(pixel7, newsubdiv);
-	if (!pixel8) // pixel does not exist yet, so we need to create it and integrate it
+	PixelId pixel8 = GetRight(pixel7, newsubdiv);
+	if (pixel8 == NoPixel) // pixel does not exist yet, so we need to create it and integrate it
 	{
-		row = pixel1->Index[0] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
-		col = pixel1->Index[1] +  ExpInt(2, m_MaxSubdivide - newsubdiv);
-		m_AllPixels.push_front(std::make_unique<PixelInfo>(ScreenIndex{ row, col }, 0));
-		pixel8 = m_AllPixels.front().get();
-		m_CurrentPixelQueue.push_back(pixel8);
+		row = thePixel1.Index[0] + 2 * ExpInt(2, m_MaxSubdivide - newsubdiv);
+		col = thePixel1.Index[1] +  ExpInt(2, m_MaxSubdivide - newsubdiv);
+		pixel8 = NewPixel(ScreenIndex{ row, col }, 0);
 	}
-	// no else to update subdivision level and no putting pixel 8 in m_CurrentPixelUpdating!
+	// no else to update subdivision level and no putting pixel 8 in m_SubdivisionUpdating!
+
 
+	// Now all 9 pixels exist; the new pixels (2, 4, 5, 6, 8) need to be integrated (if they were created in this iteration)
+	QueueAt(pixel2, 0);
+	QueueAt(pixel4, 1);
+	QueueAt(pixel5, 2);
+	QueueAt(pixel6, 3);
+	QueueAt(pixel8, 4);
 
-	// Now all 9 pixels exist and have been put in the appropriate vectors (m_CurrentPixelQueue and/or m_CurrentPixelUpdating)
+	// Pixels 1, 2, 4, 5 have been put in m_SubdivisionUpdating (if applicable)
 	// We only need to create the new neighbor relations between these pixels;
 	// Remember: right/down/SEdiag neighbors are ONLY defined if the pixel is a pixel that can be subdivided;
 	// and left/up neighbors are defined to be correct reciprocally with right/down relations
 	// This means we only (re)define right/down/SEdiag neighbors for pixels 1, 2, 4, 5
 	// Pixel 1
-	pixel1->RightNbr = pixel2;
-	pixel2->LeftNbr = pixel1;
-	pixel1->DownNbr = pixel4;
-	pixel4->UpNbr = pixel1;
-	pixel1->SEdiagNbr = pixel5;
+	thePixel1.RightNbr = pixel2;
+	Pixel(pixel2).LeftNbr = pixel1;
+	thePixel1.DownNbr = pixel4;
+	Pixel(pixel4).UpNbr = pixel1;
+	thePixel1.SEdiagNbr = pixel5;
 	// Pixel 2
-	pixel2->RightNbr = pixel3;
-	pixel3->LeftNbr = pixel2;
-	pixel2->DownNbr = pixel5;
-	pixel5->UpNbr = pixel2;
-	pixel2->SEdiagNbr = pixel6;
+	Pixel(pixel2).RightNbr = pixel3;
+	Pixel(pixel3).LeftNbr = pixel2;
+	Pixel(pixel2).DownNbr = pixel5;
+	Pixel(pixel5).UpNbr = pixel2;
+	Pixel(pixel2).SEdiagNbr = pixel6;
 	// Pixel 4
-	pixel4->RightNbr = pixel5;
-	pixel5->LeftNbr = pixel4;
-	pixel4->DownNbr = pixel7;
-	pixel7->UpNbr = pixel4;
-	pixel4->SEdiagNbr = pixel8;
+	Pixel(pixel4).RightNbr = pixel5;
+	Pixel(pixel5).LeftNbr = pixel4;
+	Pixel(pixel4).DownNbr = pixel7;
+	Pixel(pixel7).UpNbr = pixel4;
+	Pixel(pixel4).SEdiagNbr = pixel8;
 	// Pixel 5
-	pixel5->RightNbr = pixel6;
-	pixel6->LeftNbr = pixel5;
-	pixel5->DownNbr = pixel8;
-	pixel8->UpNbr = pixel5;
-	pixel5->SEdiagNbr = pixel9;
+	Pixel(pixel5).RightNbr = pixel6;
+	Pixel(pixel6).LeftNbr = pixel5;
+	Pixel(pixel5).DownNbr = pixel8;
+	Pixel(pixel8).UpNbr = pixel5;
+	Pixel(pixel5).SEdiagNbr = pixel9;
 }
 
 
@@ -1111,8 +1620,11 @@ void SquareSubdivisionMeshV2::EndCurrentLoop()
 	m_PixelsIntegrated += static_cast<largecounter>(m_CurrentPixelQueue.size());
 
 	// All pixels in CurrentPixelQueue have been integrated, so pixel queue is now empty
+	for (PixelId pixel : m_CurrentPixelQueue)
+		Pixel(pixel).QueueIndex = NoPixel;
 	m_CurrentPixelQueue.clear();
 	m_CurrentPixelQueueDone.clear();
+	m_CurrentPixelDependents.clear();
 
 	ScreenOutput("Total integrated geodesic so far: " + std::to_string(m_PixelsIntegrated) + ".", OutputLevel::Level_2_SUBPROC);
 
@@ -1134,29 +1646,94 @@ void SquareSubdivisionMeshV2::EndCurrentLoop()
 
 		// UpdateWeights() has updated m_ActivePixels with the pixels that have weight > 0,
 		// so this vector contains all possible candidates to subdivide. We only need to select the best candidates now.
-		// Order the candidates according to how much we want to subdivide them (front is most important)
-		auto Comp = [this](PixelInfo* p1, PixelInfo* p2) -> bool // returns true if ind1 is more important than ind2
+		largecounter subdivlim = std::min(static_cast<largecounter>(m_ActivePixels.size()), m_IterationPixels);
+		// Every subdivision creates at most 5 new pixels; make sure we do not run out of (32-bit) pixel indices
+		const largecounter maxsubdivisions{ (static_cast<largecounter>(NoPixel) - m_NrPixels) / 5 };
+		if (subdivlim > maxsubdivisions)
 		{
-			if (p1->Weight > p2->Weight)
-				return true;
-			else if (p1->Weight == p2->Weight
-				&& p1->SubdivideLevel < p2->SubdivideLevel)
-				return true; // In the case of equal weight, give precedence to less-subdivided pixels
-			else
-				return false;
-		};
-		std::sort(m_ActivePixels.begin(), m_ActivePixels.end(), Comp);
+			ScreenOutput("Maximum number of pixels that the Mesh can store reached!", OutputLevel::Level_0_WARNING);
+			subdivlim = maxsubdivisions;
+		}
+		// Put the subdivlim most important candidates at the front of m_ActivePixels, in order
+		SelectPixelsToSubdivide(subdivlim);
 
 		// Now we can actually subdivide the first m pixels
 		ScreenOutput("Setting up subdivided pixels for integration...", OutputLevel::Level_3_ALLDETAIL);
 		// At most, we will be creating 5x this number of new pixels to integrate
-		m_CurrentPixelQueue.reserve(5 * m_IterationPixels);
-		// Populate the queue with <=5*m_IterationPixels to integrate
-		largecounter subdivlim = std::min(static_cast<largecounter>(m_ActivePixels.size()), m_IterationPixels);
+		ReservePixels(5 * subdivlim);
+		m_SubdivisionFirstNewPixel = m_NrPixels;
+		m_SubdivisionQueueSlots = std::vector<largecounter>(5 * subdivlim, LARGECOUNTER_MAX);
+		m_SubdivisionUpdating = std::vector<PixelId>(4 * subdivlim, NoPixel);
+
+		// Subdividing a pixel only involves pixels in the same square of the initial grid (including its edges and corners).
+		// Therefore, we can subdivide pixels in different initial squares in parallel, as long as these squares do not touch:
+		// we do this in four rounds, one for every position in a 2x2 checkerboard of initial squares.
+		// In every initial square, its pixels are subdivided in order.
+		const pixelcoord squaresize{ ExpInt(2, m_MaxSubdivide - 1) };
+		const pixelcoord nrsquares{ static_cast<pixelcoord>(sqrt(m_InitialPixels)) - 1 }; // (in a row or column)
+		auto InitialSquare = [this, squaresize, nrsquares](largecounter ind) -> pixelcoord
+		{
+			const ScreenIndex& index{ Pixel(m_ActivePixels[ind]).Index };
+			return (index[0] / squaresize) * nrsquares + index[1] / squaresize;
+		};
+		auto CheckerboardRound = [nrsquares](pixelcoord square) -> int
+			{ return static_cast<int>(2 * ((square / nrsquares) % 2) + (square % nrsquares) % 2); };
+
+		// The pixels to subdivide, sorted by round, then by initial square (and then still in order);
+		// we do this with a counting sort, as the initial squares are numbered 0, ..., nrsquares^2-1
+		// squarestart: where the pixels of every initial square start in subdivorder (in the order of the rounds),
+		// roundstart: where the initial squares of every round start in squarestart
+		std::vector<largecounter> squarecount(nrsquares * nrsquares, 0);
 		for (largecounter ind = 0; ind < subdivlim; ++ind)
+			++squarecount[InitialSquare(ind)];
+		std::vector<largecounter> squareposition(nrsquares * nrsquares);
+		std::vector<largecounter> squarestart{};
+		std::array<largecounter, 5> roundstart{};
+		largecounter nrsorted{ 0 };
+		for (int round = 0; round < 4; ++round)
 		{
-			SubdivideAndQueue(ind);
+			roundstart[round] = squarestart.size();
+			for (pixelcoord square = 0; square < nrsquares * nrsquares; ++square)
+			{
+				if (CheckerboardRound(square) == round && squarecount[square] > 0)
+				{
+					squarestart.push_back(nrsorted);
+					squareposition[square] = nrsorted;
+					nrsorted += squarecount[square];
+				}
+			}
+		}
+		roundstart[4] = squarestart.size();
+		squarestart.push_back(subdivlim);
+		std::vector<largecounter> subdivorder(subdivlim);
+		for (largecounter ind = 0; ind < subdivlim; ++ind)
+			subdivorder[squareposition[InitialSquare(ind)]++] = ind;
+
+		// Note: this is called from within a single thread in the parallel region of main(), so the other threads
+		// (waiting at the end of the single region) will pick up these tasks
+		for (int round = 0; round < 4; ++round)
+		{
+#pragma omp taskloop shared(squarestart, subdivorder)
+			for (largecounter square = roundstart[round]; square < roundstart[round + 1]; ++square)
+			{
+				for (largecounter i = squarestart[square]; i < squarestart[square + 1]; ++i)
+					SubdivideAndQueue(subdivorder[i]);
+			}
 		}
+
+		// Now put all new pixels in the queue, and all pixels that need weight updating in m_CurrentPixelUpdating,
+		// in the order of the subdivisions that first needed them
+		std::vector<PixelId> queueorder(5 * subdivlim, NoPixel);
+		for (PixelId pixel = m_SubdivisionFirstNewPixel; pixel < m_NrPixels; ++pixel)
+			queueorder[m_SubdivisionQueueSlots[pixel - m_SubdivisionFirstNewPixel]] = pixel;
+		m_CurrentPixelQueue.reserve(m_NrPixels - m_SubdivisionFirstNewPixel);
+		std::copy_if(queueorder.begin(), queueorder.end(), std::back_inserter(m_CurrentPixelQueue),
+			[](PixelId pixel) { return pixel != NoPixel; });
+		std::copy_if(m_SubdivisionUpdating.begin(), m_SubdivisionUpdating.end(), std::back_inserter(m_CurrentPixelUpdating),
+			[](PixelId pixel) { return pixel != NoPixel; });
+		m_SubdivisionQueueSlots.clear();
+		m_SubdivisionUpdating.clear();
+
 		// Erase the elements that we have subdivided from the active pixels
 		m_ActivePixels.erase(m_ActivePixels.begin(), m_ActivePixels.begin() + subdivlim);
 
@@ -1176,7 +1753,11 @@ void SquareSubdivisionMeshV2::EndCurrentLoop()
 				OutputLevel::Level_2_SUBPROC);
 		}
 		// Initialize m_CurrentPixelQueueDone
-		m_CurrentPixelQueueDone = std::vector<bool>(m_CurrentPixelQueue.size(), false);
+		m_CurrentPixelQueueDone = std::vector<char>(m_CurrentPixelQueue.size(), false);
+
+		// Figure out which weights can be calculated when each pixel is done
+		if (m_PipelinedWeights)
+			SetUpWeightDependencies();
 	}
 
 	ScreenOutput("Done calculating next iteration of pixels (time taken: " + std::to_string(meshTimer.elapsed()) + "s).",
@@ -13,11 +13,15 @@
 
 #include <cmath> // needed for sqrt (only on Linux)
 #include <utility> // std::move
-#include <forward_list> // std::forward_list
 #include <memory> // std::unique_ptr
 #include <vector> // std::vector
 #include <array> // std::array
 #include <string> // for strings
+#include <atomic> // std::atomic (for pipelined weight calculations in SquareSubdivisionMeshV2)
+#include <unordered_map> // std::unordered_map (pixel lookup in SquareSubdivisionMesh)
+#include <mutex> // std::once_flag (pixel value store in SquareSubdivisionMeshV2)
+#include <cstdint> // std::uint32_t (pixel indices in SquareSubdivisionMeshV2)
+#include <limits> // std::numeric_limits
 
 
 // Abstract Mesh base class
@@ -43,7 +47,7 @@ public:
 
 	// When a geodesic is finished integrating, it tells the Mesh and passes on its final "value"
 	// NOTE: despite being a non-const member function, this must be designed to be thread-safe!
-	virtual void GeodesicFinished(largecounter index, std::vector<real> finalValues) = 0;
+	virtual void GeodesicFinished(largecounter index, const std::vector<real>& finalValues) = 0;
 
 	// This is called when the current iteration is finished. The Mesh can now evaluate whether to continue or not
 	virtual void EndCurrentLoop() = 0;
@@ -54,6 +58,29 @@ public:
 	// Returns a string description of the Mesh (spaces allowed), describing its options
 	virtual std::string getFullDescriptionStr() const;
 
+	// Checkpointing: write the complete state of the Mesh to a (binary) stream between iterations,
+	// and read it back in (into a Mesh constructed with the same options) to continue the run later.
+	// Both return false if the Mesh does not support this (the default), LoadCheckpoint() also if the checkpoint is invalid
+	virtual bool SaveCheckpoint(std::ostream& out) const;
+	virtual bool LoadCheckpoint(std::istream& in);
+
+	// A Mesh can continue from the output of a previous run (e.g. refining the grid of an earlier run), in which case
+	// that output must be included in the output of this run. If so, this returns the output of the previous run
+	// (its file names up to the Diagnostic name, see GeodesicOutputHandler::IncludePreviousOutput()) and the factor
+	// by which its screen indices must be multiplied to land on the current grid. Returns false otherwise (the default)
+	virtual bool getPreviousOutput(std::string& previousoutput, largecounter& indexscale) const;
+
+	// Mirror symmetry: if the image is symmetric under reflection of the second screen coordinate (around the middle
+	// of the screen), the ViewScreen can ask the Mesh to only hand out the pixels of (slightly more than) half the screen.
+	// The other pixels are then the mirror images of integrated pixels, and are not integrated themselves.
+	// UseMirrorSymmetry() returns false if the Mesh does not support this (the default), and must be called before
+	// the first iteration. Each iteration, there are then getCurNrMirrorImages() mirror pixels (on top of the
+	// getCurNrGeodesics() integrated pixels); getMirrorImage() returns true if the integrated pixel index has a mirror image,
+	// and if so sets its index (between 0 and getCurNrMirrorImages()-1) and screen index
+	virtual bool UseMirrorSymmetry();
+	virtual largecounter getCurNrMirrorImages() const;
+	virtual bool getMirrorImage(largecounter index, largecounter& mirrorindex, ScreenIndex& mirrorscreenindex) const;
+
 protected:
 	// The Diagnostic (a const pointer to a const Diagnostic object) that is used to calculate
 	// distances (using FinalDataValDistance()) between the "values" that are assigned to Geodesics
@@ -70,15 +97,36 @@ public:
 	SimpleSquareMesh() = delete;
 	// Constructor initializes total number of pixels and passes valdiag to base constructor
 	// Note that we static_cast the sqrt() to round off the row/column size to an integer number
-	SimpleSquareMesh(largecounter totalPixels, DiagBitflag valdiag)
-		: m_TotalPixels{ static_cast<pixelcoord>(sqrt(totalPixels))
+	// Optionally, the Mesh refines the grid of a previous run with previousPixels pixels (whose output is previousOutput):
+	// the previous grid must fit exactly on the new grid, i.e. (new row size - 1) must be a multiple of
+	// (previous row size - 1), e.g. 1000^2 -> 1999^2. Only the pixels that are not on the previous grid are then integrated.
+	SimpleSquareMesh(largecounter totalPixels, DiagBitflag valdiag, largecounter previousPixels = 0, std::string previousOutput = "")
+		: Mesh(valdiag),
+		  m_TotalPixels{ static_cast<pixelcoord>(sqrt(totalPixels))
 			* static_cast<pixelcoord>(sqrt(totalPixels)) },
 		  m_RowColumnSize{ static_cast<pixelcoord>(sqrt(totalPixels)) },
-		  Mesh(valdiag)
+		  m_PreviousRowColumnSize{ static_cast<pixelcoord>(sqrt(previousPixels)) },
+		  m_PreviousOutput{ previousOutput },
+		  m_IntegratedColumns{ static_cast<pixelcoord>(sqrt(totalPixels)) }
 	{
 		if constexpr (dimension != 4)
 			ScreenOutput("SimpleSquareMesh only defined in 4D!", OutputLevel::Level_0_WARNING);
-		
+
+		// Check that the previous grid fits on the new grid (with at least one new pixel in between the previous pixels)
+		if (m_PreviousRowColumnSize > 0)
+		{
+			if (m_PreviousRowColumnSize < 2 || m_RowColumnSize < 2
+				|| (m_RowColumnSize - 1) % (m_PreviousRowColumnSize - 1) != 0
+				|| (m_RowColumnSize - 1) / (m_PreviousRowColumnSize - 1) < 2)
+			{
+				ScreenOutput("SimpleSquareMesh: previous grid (" + std::to_string(m_PreviousRowColumnSize)
+					+ "^2 pixels) does not fit on the grid (" + std::to_string(m_RowColumnSize)
+					+ "^2 pixels)! Will integrate all pixels.", OutputLevel::Level_0_WARNING);
+				m_PreviousRowColumnSize = 0;
+			}
+			else
+				m_PreviousScale = (m_RowColumnSize - 1) / (m_PreviousRowColumnSize - 1);
+		}
 	}
 
 	// Declarations of overriding virtual functions
@@ -87,12 +135,19 @@ public:
 
 	void getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const final;
 	
-	void GeodesicFinished(largecounter index, std::vector<real> finalValues) final;
+	void GeodesicFinished(largecounter index, const std::vector<real>& finalValues) final;
 
 	void EndCurrentLoop() final;
 
 	bool IsFinished() const final;
 
+	bool getPreviousOutput(std::string& previousoutput, largecounter& indexscale) const final;
+
+	// Mirror symmetry: only the first (m_RowColumnSize + 1) / 2 columns are integrated
+	bool UseMirrorSymmetry() final;
+	largecounter getCurNrMirrorImages() const final;
+	bool getMirrorImage(largecounter index, largecounter& mirrorindex, ScreenIndex& mirrorscreenindex) const final;
+
 	// Description string getter
 	std::string getFullDescriptionStr() const final;
 
@@ -103,6 +158,17 @@ private:
 	const pixelcoord m_RowColumnSize;
 	// Are we done integrating or not?
 	bool m_Finished{ false };
+
+	// The grid of the previous run (0 if there is none): its amount of pixels per row or column,
+	// and the distance between its pixels on the current grid (pixel (i,j) of the previous grid is (scale*i,scale*j) now)
+	pixelcoord m_PreviousRowColumnSize;
+	pixelcoord m_PreviousScale{ 1 };
+	// The output of the previous run
+	const std::string m_PreviousOutput;
+
+	// The amount of columns that are integrated: m_RowColumnSize, or (m_RowColumnSize + 1) / 2 if using mirror symmetry
+	// (the remaining columns are the mirror images of the first ones)
+	pixelcoord m_IntegratedColumns;
 };
 
 
@@ -123,7 +189,7 @@ public:
 
 	void getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const final;
 
-	void GeodesicFinished(largecounter index, std::vector<real> finalValues) final;
+	void GeodesicFinished(largecounter index, const std::vector<real>& finalValues) final;
 
 	void EndCurrentLoop() final;
 
@@ -193,7 +259,7 @@ public:
 
 	void getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const final;
 
-	void GeodesicFinished(largecounter index, std::vector<real> finalValues) final;
+	void GeodesicFinished(largecounter index, const std::vector<real>& finalValues) final;
 
 	void EndCurrentLoop() final;
 
@@ -255,6 +321,20 @@ private:
 	// All pixels that have been integrated already (so does not include the pixels in the current queue) 
 	std::vector<PixelInfo> m_AllPixels{};
 
+	// Index of all pixels (both in m_AllPixels and in m_CurrentPixelQueue), keyed by their (packed) ScreenIndex.
+	// The value is the position of the pixel in m_AllPixels; for a pixel in the current queue, this is the position it will
+	// have once the queue is appended to m_AllPixels, i.e. m_AllPixels.size() + (its position in m_CurrentPixelQueue).
+	// This makes finding a pixel (neighbors, checking whether a pixel already exists) O(1) instead of a linear search.
+	std::unordered_map<largecounter, largecounter> m_PixelLocations{};
+
+	// Helper function: the key of the pixel at (row, col) in m_PixelLocations
+	largecounter PixelKey(pixelcoord row, pixelcoord col) const;
+	// Helper function: position (as in m_PixelLocations) of the pixel at (row, col),
+	// or LARGECOUNTER_MAX if there is no such pixel (yet)
+	largecounter FindPixel(pixelcoord row, pixelcoord col) const;
+	// Helper function: add the pixel to the end of m_CurrentPixelQueue (and to m_PixelLocations)
+	void QueuePixel(ScreenIndex index, int subdiv);
+
 	// Initializes the first nxn screen in m_CurrentPixelQueue
 	void InitializeFirstGrid();
 
@@ -298,14 +378,18 @@ public:
 	// - initialSubToFinal: once we decide to subdivide a square, do we automatically keep subdividing it
 	// until we reach maxSubdivision?
 	// - valdiag: the "value" and "distance" Diagnostic to use
+	// - pipelinedWeights: calculate the weight of a pixel as soon as it and its neighbors have finished integrating,
+	// (i.e. while other geodesics are still being integrated), instead of all at once at the end of the iteration
+	// (only the weights are pipelined: selecting and subdividing pixels still waits until the whole iteration is done)
 	SquareSubdivisionMeshV2(largecounter maxPixels, largecounter initialPixels, int maxSubdivide, largecounter iterationPixels, bool initialSubToFinal,
-		DiagBitflag valdiag)
-		: m_InitialPixels{ static_cast<pixelcoord>(sqrt(initialPixels))
+		DiagBitflag valdiag, bool pipelinedWeights = false)
+		: Mesh(valdiag),
+		m_InitialPixels{ static_cast<pixelcoord>(sqrt(initialPixels))
 			* static_cast<pixelcoord>(sqrt(initialPixels)) },
 		m_MaxSubdivide{ maxSubdivide },
 		m_RowColumnSize{ static_cast<pixelcoord>((sqrt(initialPixels) - 1) * ExpInt(2,maxSubdivide - 1) + 1) },
-		m_PixelsLeft{ maxPixels }, m_MaxPixels{ maxPixels }, m_InfinitePixels{ maxPixels == 0 }, m_IterationPixels{ iterationPixels },
-		m_InitialSubDividideToFinal{ initialSubToFinal }, Mesh(valdiag)
+		m_IterationPixels{ iterationPixels }, m_MaxPixels{ maxPixels }, m_InitialSubDividideToFinal{ initialSubToFinal },
+		m_InfinitePixels{ maxPixels == 0 }, m_PipelinedWeights{ pipelinedWeights }, m_PixelsLeft{ maxPixels }
 	{
 		if constexpr (dimension != 4)
 			ScreenOutput("SquareSubdivisionMeshV2 only defined in 4D!", OutputLevel::Level_0_WARNING);
@@ -320,12 +404,15 @@ public:
 
 	void getNewInitConds(largecounter index, ScreenPoint& newunitpoint, ScreenIndex& newscreenindex) const final;
 
-	void GeodesicFinished(largecounter index, std::vector<real> finalValues) final;
+	void GeodesicFinished(largecounter index, const std::vector<real>& finalValues) final;
 
 	void EndCurrentLoop() final;
 
 	bool IsFinished() const final;
 
+	bool SaveCheckpoint(std::ostream& out) const final;
+	bool LoadCheckpoint(std::istream& in) final;
+
 	// Description string getter
 	std::string getFullDescriptionStr() const final;
 
@@ -344,6 +431,8 @@ private:
 	const bool m_InitialSubDividideToFinal;
 	// Are we allowed to integrate as many pixels as we want? (m_MaxPixels == 0)
 	const bool m_InfinitePixels;
+	// Do we calculate weights of pixels as soon as they (and their neighbors) are integrated?
+	const bool m_PipelinedWeights;
 
 	// How many pixels are we still allowed to integrate (if !m_InfinitePixels)?
 	largecounter m_PixelsLeft;
@@ -351,50 +440,84 @@ private:
 	// How many pixels we have integrated so far
 	largecounter m_PixelsIntegrated{ 0 };
 
+	// Pixels are referred to by their (32-bit) index in the pixel store; NoPixel signifies "no pixel"
+	using PixelId = std::uint32_t;
+	static constexpr PixelId NoPixel{ std::numeric_limits<PixelId>::max() };
+
 	// A struct the Mesh uses to keep all information about a given pixel
+	// (the pixel's values are not stored here, but in the flat value store; see PixelValues())
 	struct PixelInfo
 	{
-		// Constructor with its ScreenIndex and current subdivision level
-		PixelInfo(ScreenIndex ind, int subdiv) : Index{ ind }, SubdivideLevel{ subdiv } {}
-
-		// The pixel's screenindex: this gets set by the constructor and cannot change anymore
-		const ScreenIndex Index{};
+		// The pixel's screenindex: this gets set when the pixel is created and does not change anymore
+		ScreenIndex Index{};
 
 		// The level at which the pixel has been subdivided
 		// Note: initial grid pixels are at 1; pixels at 0 are pixels that cannot be subdivided
 		// (for example, at the right or lower edges)
 		int SubdivideLevel{};
 
+		// Only used for pipelined weights:
+		// the number of pixels (itself and its right, lower, and right-lower neighbors) that have not finished
+		// integrating yet, that are needed to calculate its weight
+		std::atomic<int> PendingValues{ 0 };
+
 		// Weight of the pixel: if negative, this signifies that it needs to be updated/calculated!
 		// The weight is determined as the max of the distance (as calculated by the value Diagnostic)
 		// between its values and those of its right, lower, and right-lower neighbors.
 		real Weight{ -1 };
 
-		// The values associated to this pixel (as calculated by the value Diagnostic)
-		std::vector<real> DiagValue{};
+		// Indices of its neighbors
+		PixelId LeftNbr{ NoPixel };
+		PixelId RightNbr{ NoPixel };
+		PixelId UpNbr{ NoPixel };
+		PixelId DownNbr{ NoPixel };
+		PixelId SEdiagNbr{ NoPixel };
 
-		// Pointers to its neighbors
-		PixelInfo* LeftNbr{ nullptr };
-		PixelInfo* RightNbr{ nullptr };
-		PixelInfo* UpNbr{ nullptr };
-		PixelInfo* DownNbr{ nullptr };
-		PixelInfo* SEdiagNbr{ nullptr };
+		// Only used for pipelined weights:
+		// the index of the pixel in the current queue (NoPixel if it is not being integrated in the current iteration)
+		PixelId QueueIndex{ NoPixel };
 	};
 
-	// Master list of all pixels
-	// std::forward_list is more space-efficient than std::list, bidirectional iteration is not needed, no random access supported
-	// This list is only used to store the owner pointers (and thus the objects) of all pixels.
-	// The other pixel vectors are used to iterate through (and need random access)
-	std::forward_list<std::unique_ptr<PixelInfo>> m_AllPixels{};
+	// Pixel store: all pixels live in blocks of PixelBlockSize pixels that are allocated once and never move,
+	// so that pixels can refer to each other by index, and pixels created together are close together in memory.
+	// The values of all pixels (as calculated by the value Diagnostic) live in a flat array per block,
+	// with a fixed number of values m_ValueStride per pixel.
+	static constexpr int PixelBlockBits{ 16 };
+	static constexpr PixelId PixelBlockSize{ PixelId{ 1 } << PixelBlockBits };
+	std::vector<std::unique_ptr<PixelInfo[]>> m_PixelBlocks{};
+	std::vector<std::unique_ptr<real[]>> m_ValueBlocks{};
+	// The total number of pixels created so far
+	PixelId m_NrPixels{ 0 };
+	// The number of values per pixel; this is 0 until the first geodesic has finished integrating
+	// (as we do not know how many values the value Diagnostic returns before that)
+	std::size_t m_ValueStride{ 0 };
+	std::once_flag m_ValueStrideSet{};
+
+	// Access to a pixel and its values in the pixel store
+	PixelInfo& Pixel(PixelId id) { return m_PixelBlocks[id >> PixelBlockBits][id & (PixelBlockSize - 1)]; }
+	const PixelInfo& Pixel(PixelId id) const { return m_PixelBlocks[id >> PixelBlockBits][id & (PixelBlockSize - 1)]; }
+	real* PixelValues(PixelId id) const { return m_ValueBlocks[id >> PixelBlockBits].get() + (id & (PixelBlockSize - 1)) * m_ValueStride; }
+
+	// Makes sure the pixel store has room for nrpixels more pixels (this must be called before creating these pixels)
+	void ReservePixels(largecounter nrpixels);
+	// Creates a new pixel in the pixel store and returns its index
+	// (this is thread-safe, as long as ReservePixels() has been called beforehand)
+	PixelId NewPixel(ScreenIndex ind, int subdiv);
+	// Allocates the value block for pixel block nr blocknr (only possible once m_ValueStride is known)
+	void AllocateValueBlock(std::size_t blocknr);
 
 	// List of active pixels, i.e. those that can be subdivided and have non-zero weight
-	std::vector<PixelInfo*> m_ActivePixels{};
+	std::vector<PixelId> m_ActivePixels{};
 	// List of current queue of pixels to be sent to be integrated
-	std::vector<PixelInfo*> m_CurrentPixelQueue{};
+	std::vector<PixelId> m_CurrentPixelQueue{};
 	// A bool for every pixel in the current queue: gets set to true when the pixel is done integrating and gets its values returned
-	std::vector<bool> m_CurrentPixelQueueDone{};
+	// (note: not std::vector<bool>, as different elements of that cannot safely be written to by different threads!)
+	std::vector<char> m_CurrentPixelQueueDone{};
 	// List of pixels that are already integrated but need updating weights after current queue is all integrated
-	std::vector<PixelInfo*> m_CurrentPixelUpdating{};
+	std::vector<PixelId> m_CurrentPixelUpdating{};
+	// Only used for pipelined weights: for every pixel in the current queue, the pixels in m_CurrentPixelUpdating
+	// whose weight depends on its values
+	std::vector<std::vector<PixelId>> m_CurrentPixelDependents{};
 
 	// Initializes the first nxn screen and puts them in m_CurrentPixelQueue
 	void InitializeFirstGrid();
@@ -404,17 +527,40 @@ private:
 	// All pixels with weight > 0 will be added to m_ActivePixels
 	void UpdateAllWeights();
 
-	// Helper functions that return the appropriate neighbor of p, ONLY if this neighbor exists at the subdivision level specified
-	// Returns nullptr otherwise; also return nullptr if p==nullptr
-	PixelInfo* GetUp(PixelInfo* p, int subdiv) const;
-	PixelInfo* GetDown(PixelInfo* p, int subdiv) const;
-	PixelInfo* GetRight(PixelInfo* p, int subdiv) const;
-	PixelInfo* GetLeft(PixelInfo* p, int subdiv) const;
+	// Calculates the weight of a single pixel (its values and those of its neighbors must be assigned);
+	// UpdateWeight() also sets the pixel's weight to this
+	real CalculateWeight(PixelId pixel) const;
+	void UpdateWeight(PixelId pixel);
 
+	// Returns true if pixel id1 should be subdivided before pixel id2
+	// (by weight, then subdivision level, then screen index, so that this is a total order on distinct pixels)
+	bool MoreImportant(PixelId id1, PixelId id2) const;
 
-	// This will take the pixel m_AllPixels[ind] and subdivide it,
-	// adding up to <=5 pixels to the CurrentPixelQueue
+	// Puts the (at least) nrpixels most important pixels in m_ActivePixels at the front of m_ActivePixels, in order of importance
+	void SelectPixelsToSubdivide(largecounter nrpixels);
+
+	// Only used for pipelined weights: called when the current queue is set up, sets up m_CurrentPixelDependents
+	// and the PendingValues of all pixels in m_CurrentPixelUpdating
+	void SetUpWeightDependencies();
+
+	// Helper functions that return the appropriate neighbor of p, ONLY if this neighbor exists at the subdivision level specified
+	// Returns NoPixel otherwise; also return NoPixel if p==NoPixel
+	PixelId GetUp(PixelId p, int subdiv) const;
+	PixelId GetDown(PixelId p, int subdiv) const;
+	PixelId GetRight(PixelId p, int subdiv) const;
+	PixelId GetLeft(PixelId p, int subdiv) const;
+
+
+	// This will take the pixel m_ActivePixels[ind] and subdivide it, creating up to 5 new pixels
+	// Note: this can be called in parallel for pixels in initial grid squares that do not touch.
+	// The new pixels are put in the queue afterwards, in the order they would have been created in if
+	// the pixels had been subdivided one by one in order; for this, m_SubdivisionFirstNewPixel and m_SubdivisionQueueSlots
+	// keep track of the first (in this order) subdivision that needs every new pixel.
+	// Pixels that need weight updating are put in m_SubdivisionUpdating (up to 4 places for every subdivision)
 	void SubdivideAndQueue(largecounter ind);
+	PixelId m_SubdivisionFirstNewPixel{ 0 };
+	std::vector<largecounter> m_SubdivisionQueueSlots{};
+	std::vector<PixelId> m_SubdivisionUpdating{};
 
 	// Helper function to exponentiate an int to an int
 	// Note: the result can be larger than fits in an int, but the base is always 2 and the exp is always
@@ -5,18 +5,20 @@
 
 #include <cmath> // needed for sqrt() and sin() etc (only on Linux)
 #include <algorithm> // needed for std::find
+#include <type_traits> // std::is_final_v
 
 /// <summary>
 /// Metric (abstract base class) functions
 /// </summary>
 
-// Christoffel symbols of the metric (indices up, down, down)
-ThreeIndex Metric::getChristoffel_udd(const Point& p) const
+// Metric (indices down and up) and the metric derivatives (indices down) at the same point,
+// with metric_dd_der[coord][i][j] = \partial_{coord} g_{ij}
+void Metric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
 {
 	// Populate metric derivatives with index down. Only evaluates numerical derivative of metric for a given coordinate
 	// if the metric does not have a symmetry in that coordinate (otherwise derivative vanishes)
 	// (exploiting symmetries this way speeds up computations considerably!)
-	ThreeIndex metric_dd_der{};
+	metric_dd_der = ThreeIndex{};
 	// Helper function that returns a bool true/false if the coordinate is a symmetry yes/no
 	auto HasSym = [this](int theCoord) { return std::find(m_Symmetries.begin(), m_Symmetries.end(), theCoord) != m_Symmetries.end(); };
 	for (int coord = 0; coord < dimension; ++coord)
@@ -31,21 +33,124 @@ ThreeIndex Metric::getChristoffel_udd(const Point& p) const
 		}
 	}
 
-	// Metric with index up
-	TwoIndex metric_uu{ getMetric_uu(p) };
+	// Metric with index down and up
+	metric_dd = getMetric_dd(p);
+	metric_uu = getMetric_uu(p);
+}
+
+// Christoffel symbols of the metric (indices up, down, down)
+ThreeIndex Metric::getChristoffel_udd(const Point& p) const
+{
+	// Get the metric and its derivatives (the metric with indices down is not needed here)
+	TwoIndex metric_dd{}, metric_uu{};
+	ThreeIndex metric_dd_der{};
+	getMetricAndDerivatives(p, metric_dd, metric_uu, metric_dd_der);
+
+	// Construct Christoffel symbol from these (only calculating the nonzero components if we know the structure)
+	if (m_Structure == MetricStructure::CircularStationaryAxisymmetric)
+		return ChristoffelFromDerivatives<MetricStructure::CircularStationaryAxisymmetric>(metric_uu, metric_dd_der);
+	else
+		return ChristoffelFromDerivatives<MetricStructure::General>(metric_uu, metric_dd_der);
+}
+
+// Christoffel symbol contracted twice with v: Gamma^a_{bc} v^b v^c
+OneIndex Metric::getChristoffelContraction(const Point& p, const OneIndex& v) const
+{
+	ThreeIndex christ{ getChristoffel_udd(p) };
+
+	// Only sum over the nonzero components if we know the structure
+	if (m_Structure == MetricStructure::CircularStationaryAxisymmetric)
+		return ContractChristoffel<MetricStructure::CircularStationaryAxisymmetric>(christ, v);
+	else
+		return ContractChristoffel<MetricStructure::General>(christ, v);
+}
+
+// Christoffel symbol contracted twice with v, for a Metric of known type (see getChristoffelContraction() above)
+template<typename MetricType>
+OneIndex Metric::getChristoffelContractionStatic(const MetricType& theMetric, const Point& p, const OneIndex& v)
+{
+	static_assert(std::is_final_v<MetricType>, "getChristoffelContractionStatic() needs a final Metric class!");
+
+	// Since MetricType is final, this call is resolved at compile time
+	TwoIndex metric_dd{}, metric_uu{};
+	ThreeIndex metric_dd_der{};
+	theMetric.getMetricAndDerivatives(p, metric_dd, metric_uu, metric_dd_der);
+
+	if (theMetric.getStructure() == MetricStructure::CircularStationaryAxisymmetric)
+		return ContractChristoffel<MetricStructure::CircularStationaryAxisymmetric>(
+			ChristoffelFromDerivatives<MetricStructure::CircularStationaryAxisymmetric>(metric_uu, metric_dd_der), v);
+	else
+		return ContractChristoffel<MetricStructure::General>(
+			ChristoffelFromDerivatives<MetricStructure::General>(metric_uu, metric_dd_der), v);
+}
+
+// Batched Christoffel contraction: simply contract for every member of the batch separately
+BatchOneIndex Metric::getChristoffelContractionBatch(const BatchPoint& p, const BatchOneIndex& v) const
+{
+	BatchOneIndex ret{};
+	for (int i = 0; i < BatchSize; ++i)
+	{
+		OneIndex contraction{ getChristoffelContraction(Point{ p[0][i], p[1][i], p[2][i], p[3][i] },
+			OneIndex{ v[0][i], v[1][i], v[2][i], v[3][i] }) };
+		for (int mu = 0; mu < dimension; ++mu)
+			ret[mu][i] = contraction[mu];
+	}
+	return ret;
+}
 
-	// Construct Christoffel symbol Gamma^{\mu}_{\nu\rho}
+// Helper function to construct the Christoffel symbol Gamma^{\mu}_{\nu\rho} from the inverse metric
+// and the metric derivatives metric_dd_der[coord][i][j] = \partial_{coord} g_{ij}
+template<MetricStructure Structure>
+ThreeIndex Metric::ChristoffelFromDerivatives(const TwoIndex& metric_uu, const ThreeIndex& metric_dd_der)
+{
 	ThreeIndex theChristoffel{};
-	for (int mu = 0; mu < dimension; ++mu)
+	if constexpr (Structure == MetricStructure::CircularStationaryAxisymmetric)
+	{
+		// Only the r and theta derivatives of g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi} are nonzero,
+		// so only the following Christoffel symbols can be nonzero (A,B are r,theta indices; a,b,c are t,phi indices):
+		// Gamma^a_{bA} = 1/2 g^{ac} \partial_A g_{bc}
+		for (int a : {0, 3})
+		{
+			for (int b : {0, 3})
+			{
+				for (int A : {1, 2})
+				{
+					theChristoffel[a][b][A] = 1.0 / 2 * (metric_uu[a][0] * metric_dd_der[A][b][0] + metric_uu[a][3] * metric_dd_der[A][b][3]);
+					theChristoffel[a][A][b] = theChristoffel[a][b][A];
+				}
+			}
+		}
+		// Gamma^A_{ab} = -1/2 g^{AA} \partial_A g_{ab}
+		for (int A : {1, 2})
+		{
+			theChristoffel[A][0][0] = -1.0 / 2 * metric_uu[A][A] * metric_dd_der[A][0][0];
+			theChristoffel[A][0][3] = -1.0 / 2 * metric_uu[A][A] * metric_dd_der[A][0][3];
+			theChristoffel[A][3][0] = theChristoffel[A][0][3];
+			theChristoffel[A][3][3] = -1.0 / 2 * metric_uu[A][A] * metric_dd_der[A][3][3];
+		}
+		// Gamma^A_{BC}
+		theChristoffel[1][1][1] = 1.0 / 2 * metric_uu[1][1] * metric_dd_der[1][1][1];
+		theChristoffel[1][1][2] = 1.0 / 2 * metric_uu[1][1] * metric_dd_der[2][1][1];
+		theChristoffel[1][2][1] = theChristoffel[1][1][2];
+		theChristoffel[1][2][2] = -1.0 / 2 * metric_uu[1][1] * metric_dd_der[1][2][2];
+		theChristoffel[2][2][2] = 1.0 / 2 * metric_uu[2][2] * metric_dd_der[2][2][2];
+		theChristoffel[2][1][2] = 1.0 / 2 * metric_uu[2][2] * metric_dd_der[1][2][2];
+		theChristoffel[2][2][1] = theChristoffel[2][1][2];
+		theChristoffel[2][1][1] = -1.0 / 2 * metric_uu[2][2] * metric_dd_der[2][1][1];
+	}
+	else
 	{
-		for (int nu = 0; nu < dimension; ++nu)
+		for (int mu = 0; mu < dimension; ++mu)
 		{
-			for (int rho = 0; rho < dimension; ++rho)
+			for (int nu = 0; nu < dimension; ++nu)
 			{
-				for (int sigma = 0; sigma < dimension; ++sigma)
+				for (int rho = 0; rho < dimension; ++rho)
 				{
-					theChristoffel[mu][nu][rho] += 1.0/2 * metric_uu[mu][sigma] *
-						(metric_dd_der[nu][rho][sigma] + metric_dd_der[rho][nu][sigma] - metric_dd_der[sigma][nu][rho]);
+					for (int sigma = 0; sigma < dimension; ++sigma)
+					{
+						theChristoffel[mu][nu][rho] += 1.0 / 2 * metric_uu[mu][sigma] *
+							(metric_dd_der[nu][rho][sigma] + metric_dd_der[rho][nu][sigma] - metric_dd_der[sigma][nu][rho]);
+					}
 				}
 			}
 		}
@@ -54,6 +159,42 @@ ThreeIndex Metric::getChristoffel_udd(const Point& p) const
 	return theChristoffel;
 }
 
+// Helper function to contract the Christoffel symbol twice with v: Gamma^a_{bc} v^b v^c
+template<MetricStructure Structure>
+OneIndex Metric::ContractChristoffel(const ThreeIndex& christoffel, const OneIndex& v)
+{
+	OneIndex ret{};
+	if constexpr (Structure == MetricStructure::CircularStationaryAxisymmetric)
+	{
+		// See ChristoffelFromDerivatives() for the nonzero components
+		for (int a : {0, 3})
+		{
+			ret[a] = 2. * (christoffel[a][0][1] * v[0] * v[1] + christoffel[a][0][2] * v[0] * v[2]
+				+ christoffel[a][3][1] * v[3] * v[1] + christoffel[a][3][2] * v[3] * v[2]);
+		}
+		for (int A : {1, 2})
+		{
+			ret[A] = christoffel[A][0][0] * v[0] * v[0] + 2. * christoffel[A][0][3] * v[0] * v[3] + christoffel[A][3][3] * v[3] * v[3]
+				+ christoffel[A][1][1] * v[1] * v[1] + 2. * christoffel[A][1][2] * v[1] * v[2] + christoffel[A][2][2] * v[2] * v[2];
+		}
+	}
+	else
+	{
+		for (int i = 0; i < dimension; ++i)
+			for (int j = 0; j < dimension; ++j)
+				for (int k = 0; k < dimension; ++k)
+					ret[i] += christoffel[i][j][k] * v[j] * v[k];
+	}
+
+	return ret;
+}
+
+// Explicit instantiations of the helper functions for all MetricStructures
+template ThreeIndex Metric::ChristoffelFromDerivatives<MetricStructure::General>(const TwoIndex&, const ThreeIndex&);
+template ThreeIndex Metric::ChristoffelFromDerivatives<MetricStructure::CircularStationaryAxisymmetric>(const TwoIndex&, const ThreeIndex&);
+template OneIndex Metric::ContractChristoffel<MetricStructure::General>(const ThreeIndex&, const OneIndex&);
+template OneIndex Metric::ContractChristoffel<MetricStructure::CircularStationaryAxisymmetric>(const ThreeIndex&, const OneIndex&);
+
 // Riemann tensor (indices up, down, down, down)
 FourIndex Metric::getRiemann_uddd(const Point& p) const
 {
@@ -78,6 +219,18 @@ std::string Metric::getFullDescriptionStr() const
 	return "Metric (no override description specified)";
 }
 
+// Getter for the metric structure
+MetricStructure Metric::getStructure() const
+{
+	return m_Structure;
+}
+
+// Getter for the equatorial reflection symmetry of the metric
+bool Metric::IsEquatoriallySymmetric() const
+{
+	return m_EquatoriallySymmetric;
+}
+
 
 
 
@@ -102,6 +255,42 @@ bool SphericalHorizonMetric::getrLogScale() const
 	return m_rLogScale;
 }
 
+// Converts the metric (indices down and up) and the metric derivatives, calculated in the normal r coordinate,
+// to the logarithmic coordinate u = log(r) if we are using the log scale.
+// Then g_{uu} = r^2 g_{rr} and \partial_u = r \partial_r.
+void SphericalHorizonMetric::ConvertTorLogScale(real r, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	if (m_rLogScale)
+	{
+		// g_{rr} picks up the factor r^2, so its r derivative gets an extra term
+		metric_dd_der[1][1][1] = r * r * metric_dd_der[1][1][1] + 2. * r * metric_dd[1][1];
+		metric_dd_der[2][1][1] *= r * r;
+		// All r derivatives are now u derivatives
+		for (int i = 0; i < dimension; ++i)
+		{
+			for (int j = 0; j < dimension; ++j)
+			{
+				metric_dd_der[1][i][j] *= r;
+			}
+		}
+
+		metric_dd[1][1] *= r * r;
+		metric_uu[1][1] *= 1.0 / (r * r);
+	}
+}
+
+// Regularizes sint = sin(theta) and cost = cos(theta) near the polar axis: if |sin(theta)| < PolarAxisThreshold,
+// they are replaced by their values at |sin(theta)| = PolarAxisThreshold (keeping their signs, so that the
+// metric derivatives still change sign when the ray passes through the axis)
+void SphericalHorizonMetric::RegularizeAtPolarAxis(real& sint, real& cost)
+{
+	if (fabs(sint) < PolarAxisThreshold)
+	{
+		sint = copysign(PolarAxisThreshold, sint);
+		cost = copysign(PolarAxisCosine, cost);
+	}
+}
+
 
 /// <summary>
 /// KerrMetric functions
@@ -120,11 +309,15 @@ KerrMetric::KerrMetric(real aParam, bool rLogScale)
 
 	// Check on parameters
 	if (m_aParam * m_aParam > 1.0)
-		ScreenOutput("Kerr metric a parameter given (" + std::to_string(m_aParam) + ") is not within the allowed range -1 < a < 1!",
+		ScreenOutput("Kerr metric a parameter given (" + RealToString(m_aParam) + ") is not within the allowed range -1 < a < 1!",
 			OutputLevel::Level_0_WARNING);
 
 	// Kerr has a Killing vector along t and phi, so we initialize the symmetries accordingly
 	m_Symmetries = { 0,3 };
+	// The only nonzero components are g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi}
+	m_Structure = MetricStructure::CircularStationaryAxisymmetric;
+	// Kerr only depends on theta through cos^2(theta) and sin^2(theta)
+	m_EquatoriallySymmetric = true;
 }
 
 // Kerr metric getter, indices down
@@ -190,10 +383,150 @@ TwoIndex KerrMetric::getMetric_uu(const Point& p) const
 	return TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
 }
 
+// Kerr metric (indices down and up) and its analytic derivatives, all calculated in one go
+void KerrMetric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	// If logscale is turned on, then the first coordinate is actually u = log(r), so r = e^u
+	real r = m_rLogScale ? exp(p[1]) : p[1];
+
+	// Shorthands (and their r and theta derivatives)
+	real a2 = m_aParam * m_aParam;
+	real theta = p[2];
+	real sint = sin(theta);
+	real cost = cos(theta);
+
+	// Regularize sin(theta) near the polar axis (see SphericalHorizonMetric::PolarAxisThreshold)
+	RegularizeAtPolarAxis(sint, cost);
+
+	real sint2 = sint * sint;
+	real sigma = r * r + a2 * cost * cost;
+	real dr_sigma = 2. * r;
+	real dth_sigma = -2. * a2 * sint * cost;
+	real delta = r * r + a2 - 2. * r;
+	real dr_delta = 2. * r - 2.;
+	real A_ = (r * r + a2) * (r * r + a2) - delta * a2 * sint2;
+	real dr_A_ = 4. * r * (r * r + a2) - dr_delta * a2 * sint2;
+	real dth_A_ = -2. * delta * a2 * sint * cost;
+
+	// Covariant metric elements
+	real g00 = -(1. - 2. * r / sigma);
+	real g11 = sigma / delta;
+	real g22 = sigma;
+	real g33 = A_ / sigma * sint2;
+	real g03 = -2. * m_aParam * r * sint2 / sigma;
+
+	// Contravariant metric elements
+	real g00_uu = -A_ / (sigma * delta);
+	real g11_uu = delta / sigma;
+	real g22_uu = 1. / sigma;
+	real g33_uu = (delta - a2 * sint2) / (sigma * delta * sint2);
+	real g03_uu = -2. * m_aParam * r / (sigma * delta);
+	metric_uu = TwoIndex{ {{g00_uu, 0,0, g03_uu }, {0,g11_uu,0,0}, {0,0,g22_uu,0},{g03_uu,0,0,g33_uu}} };
+
+	// Derivatives of the covariant metric elements; only r and theta derivatives are nonzero
+	real sigma2 = sigma * sigma;
+	real dr_g00 = 2. * (sigma - r * dr_sigma) / sigma2;
+	real dth_g00 = -2. * r * dth_sigma / sigma2;
+	real dr_g11 = (dr_sigma * delta - sigma * dr_delta) / (delta * delta);
+	real dth_g11 = dth_sigma / delta;
+	real dr_g22 = dr_sigma;
+	real dth_g22 = dth_sigma;
+	real dr_g33 = sint2 * (dr_A_ * sigma - A_ * dr_sigma) / sigma2;
+	real dth_g33 = ((dth_A_ * sint2 + 2. * A_ * sint * cost) * sigma - A_ * sint2 * dth_sigma) / sigma2;
+	real dr_g03 = -2. * m_aParam * sint2 * (sigma - r * dr_sigma) / sigma2;
+	real dth_g03 = -2. * m_aParam * r * (2. * sint * cost * sigma - sint2 * dth_sigma) / sigma2;
+
+	metric_dd = TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
+	metric_dd_der = ThreeIndex{};
+	metric_dd_der[1] = TwoIndex{ {{dr_g00, 0,0, dr_g03 }, {0,dr_g11,0,0}, {0,0,dr_g22,0},{dr_g03,0,0,dr_g33}} };
+	metric_dd_der[2] = TwoIndex{ {{dth_g00, 0,0, dth_g03 }, {0,dth_g11,0,0}, {0,0,dth_g22,0},{dth_g03,0,0,dth_g33}} };
+
+	// Convert to logarithmic r coordinate if necessary
+	ConvertTorLogScale(r, metric_dd, metric_uu, metric_dd_der);
+}
+
+// Kerr batched Christoffel contraction Gamma^a_{bc} v^b v^c.
+// This is written out explicitly (using the sparse structure of the Christoffel symbols, see
+// Metric::ChristoffelFromDerivatives()) without any function calls or branches in the loop body,
+// so that the compiler can vectorize the loop over the batch.
+BatchOneIndex KerrMetric::getChristoffelContractionBatch(const BatchPoint& p, const BatchOneIndex& v) const
+{
+	BatchOneIndex ret;
+	const real a = m_aParam;
+	const real a2 = m_aParam * m_aParam;
+	const bool logscale = m_rLogScale;
+
+#pragma omp simd
+	for (int i = 0; i < BatchSize; ++i)
+	{
+		// We calculate everything in the normal r coordinate; if logscale is turned on, then the coordinate is u = log(r),
+		// so r = e^u and v^r = r v^u
+		real r = logscale ? exp(p[1][i]) : p[1][i];
+		real v0 = v[0][i];
+		real vr = logscale ? r * v[1][i] : v[1][i];
+		real vth = v[2][i];
+		real vph = v[3][i];
+
+		// Shorthands (and their r and theta derivatives)
+		real sint = sin(p[2][i]);
+		real cost = cos(p[2][i]);
+		// Regularize sin(theta) near the polar axis (as in RegularizeAtPolarAxis(), but without a branch)
+		const bool nearaxis = fabs(sint) < PolarAxisThreshold;
+		sint = nearaxis ? copysign(PolarAxisThreshold, sint) : sint;
+		cost = nearaxis ? copysign(PolarAxisCosine, cost) : cost;
+		real sint2 = sint * sint;
+		real sigma = r * r + a2 * cost * cost;
+		real dr_sigma = 2. * r;
+		real dth_sigma = -2. * a2 * sint * cost;
+		real delta = r * r + a2 - 2. * r;
+		real dr_delta = 2. * r - 2.;
+		real A_ = (r * r + a2) * (r * r + a2) - delta * a2 * sint2;
+		real dr_A_ = 4. * r * (r * r + a2) - dr_delta * a2 * sint2;
+		real dth_A_ = -2. * delta * a2 * sint * cost;
+		real sigma2 = sigma * sigma;
+
+		// Contravariant metric elements
+		real g00_uu = -A_ / (sigma * delta);
+		real g11_uu = delta / sigma;
+		real g22_uu = 1. / sigma;
+		real g33_uu = (delta - a2 * sint2) / (sigma * delta * sint2);
+		real g03_uu = -2. * a * r / (sigma * delta);
+
+		// Derivatives of the covariant metric elements
+		real dr_g00 = 2. * (sigma - r * dr_sigma) / sigma2;
+		real dth_g00 = -2. * r * dth_sigma / sigma2;
+		real dr_g11 = (dr_sigma * delta - sigma * dr_delta) / (delta * delta);
+		real dth_g11 = dth_sigma / delta;
+		real dr_g22 = dr_sigma;
+		real dth_g22 = dth_sigma;
+		real dr_g33 = sint2 * (dr_A_ * sigma - A_ * dr_sigma) / sigma2;
+		real dth_g33 = ((dth_A_ * sint2 + 2. * A_ * sint * cost) * sigma - A_ * sint2 * dth_sigma) / sigma2;
+		real dr_g03 = -2. * a * sint2 * (sigma - r * dr_sigma) / sigma2;
+		real dth_g03 = -2. * a * r * (2. * sint * cost * sigma - sint2 * dth_sigma) / sigma2;
+
+		// t and phi components: 2 Gamma^a_{bA} v^b v^A = g^{ac} (\partial_A g_{bc}) v^b v^A
+		real Wr0 = vr * (v0 * dr_g00 + vph * dr_g03) + vth * (v0 * dth_g00 + vph * dth_g03);
+		real Wr3 = vr * (v0 * dr_g03 + vph * dr_g33) + vth * (v0 * dth_g03 + vph * dth_g33);
+		ret[0][i] = g00_uu * Wr0 + g03_uu * Wr3;
+		ret[3][i] = g03_uu * Wr0 + g33_uu * Wr3;
+
+		// r and theta components
+		real cr = g11_uu * (-0.5 * (v0 * v0 * dr_g00 + 2. * v0 * vph * dr_g03 + vph * vph * dr_g33)
+			+ 0.5 * dr_g11 * vr * vr + dth_g11 * vr * vth - 0.5 * dr_g22 * vth * vth);
+		ret[2][i] = g22_uu * (-0.5 * (v0 * v0 * dth_g00 + 2. * v0 * vph * dth_g03 + vph * vph * dth_g33)
+			- 0.5 * dth_g11 * vr * vr + dr_g22 * vr * vth + 0.5 * dth_g22 * vth * vth);
+
+		// In the logarithmic coordinate u = log(r), d^2u/dlambda^2 = (d^2r/dlambda^2)/r - (v^u)^2
+		ret[1][i] = logscale ? cr / r + v[1][i] * v[1][i] : cr;
+	}
+
+	return ret;
+}
+
 // Kerr description string; also gives a parameter value and whether we are using logarithmic radial coordinate
 std::string KerrMetric::getFullDescriptionStr() const
 {
-	return "Kerr (a = " + std::to_string(m_aParam) + ", " + (m_rLogScale ? "using logarithmic r coord" : "using normal r coord") + ")";
+	return "Kerr (a = " + RealToString(m_aParam) + ", " + (m_rLogScale ? "using logarithmic r coord" : "using normal r coord") + ")";
 }
 
 
@@ -212,6 +545,10 @@ FlatSpaceMetric::FlatSpaceMetric()
 
 	// Killing vectors along t and phi (other Killing vectors of flat space not explicit in spherical coords)
 	m_Symmetries = { 0,3 };
+	// The only nonzero components are g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi}
+	m_Structure = MetricStructure::CircularStationaryAxisymmetric;
+	// Flat space is reflection symmetric
+	m_EquatoriallySymmetric = true;
 }
 
 // Flat metric getter, indices down
@@ -228,6 +565,23 @@ TwoIndex FlatSpaceMetric::getMetric_uu(const Point& p) const
 	return TwoIndex{ {{-1, 0,0,0}, {0,1,0,0}, {0,0,1/(p[1] * p[1]),0},{0,0,0,1/(p[1] * p[1] * sin(p[2]) * sin(p[2]))}} };
 }
 
+// Flat metric and its (analytic) derivatives
+void FlatSpaceMetric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	real r = p[1];
+	real sint = sin(p[2]);
+	real cost = cos(p[2]);
+
+	metric_dd = TwoIndex{ {{-1, 0,0,0}, {0,1,0,0}, {0,0,r * r,0},{0,0,0,r * r * sint * sint}} };
+	metric_uu = TwoIndex{ {{-1, 0,0,0}, {0,1,0,0}, {0,0,1 / (r * r),0},{0,0,0,1 / (r * r * sint * sint)}} };
+
+	// Only g_{\theta\theta} and g_{\phi\phi} have nonzero derivatives
+	metric_dd_der = ThreeIndex{};
+	metric_dd_der[1][2][2] = 2. * r;
+	metric_dd_der[1][3][3] = 2. * r * sint * sint;
+	metric_dd_der[2][3][3] = 2. * r * r * sint * cost;
+}
+
 // Description string for flat space
 std::string FlatSpaceMetric::getFullDescriptionStr() const
 {
@@ -261,13 +615,17 @@ RasheedLarsenMetric::RasheedLarsenMetric(real mParam, real aParam, real pParam,
 		|| m_aParam*m_aParam > m_mParam*m_mParam
 		|| m_mParam < 0.0)
 	{
-		ScreenOutput("Rasheed-Larsen parameters outside of allowed range! Parameters given: m = " + std::to_string(m_mParam)
-			+ ", a = " + std::to_string(m_aParam) + ", p = " + std::to_string(m_pParam) + ", q = " + std::to_string(m_qParam) + ".",
+		ScreenOutput("Rasheed-Larsen parameters outside of allowed range! Parameters given: m = " + RealToString(m_mParam)
+			+ ", a = " + RealToString(m_aParam) + ", p = " + RealToString(m_pParam) + ", q = " + RealToString(m_qParam) + ".",
 			OutputLevel::Level_0_WARNING);
 	}
 
 	// Rasheed-Larsen has a Killing vector along t and phi, so we initialize the symmetries accordingly
 	m_Symmetries = { 0,3 };
+	// The only nonzero components are g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi}
+	m_Structure = MetricStructure::CircularStationaryAxisymmetric;
+	// The terms linear in cos(theta) in H1, H2 vanish when a = 0 or p = 2m or q = 2m
+	m_EquatoriallySymmetric = (m_aParam == 0.0 || m_pParam == 2.0 * m_mParam || m_qParam == 2.0 * m_mParam);
 }
 
 TwoIndex RasheedLarsenMetric::getMetric_dd(const Point& p) const
@@ -360,11 +718,100 @@ TwoIndex RasheedLarsenMetric::getMetric_uu(const Point& p) const
 	return TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
 }
 
+// Rasheed-Larsen metric (indices down and up) and its analytic derivatives, all calculated in one go
+void RasheedLarsenMetric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	// If logscale is turned on, then the first coordinate is actually u = log(r), so r = e^u
+	real r = m_rLogScale ? exp(p[1]) : p[1];
+
+	real r2 = r * r;
+
+	real theta = p[2];
+	real sint = sin(theta);
+	real cost = cos(theta);
+
+	// Regularize sin(theta) near the polar axis (see SphericalHorizonMetric::PolarAxisThreshold)
+	RegularizeAtPolarAxis(sint, cost);
+
+	real sint2 = sint * sint;
+	real cost2 = cost * cost;
+
+	// Constant combinations of the parameters appearing in Bp, H1, H2
+	real a2 = m_aParam * m_aParam;
+	real BpPrefactor = sqrt(m_pParam * m_qParam) * m_aParam / (2. * m_mParam * (m_pParam + m_qParam));
+	real BpSlope = m_pParam * m_qParam + 4. * m_mParam * m_mParam;
+	real BpOffset = m_mParam * (m_pParam - 2. * m_mParam) * (m_qParam - 2. * m_mParam);
+	real sqrtpq = sqrt((m_pParam * m_pParam - 4. * m_mParam * m_mParam) * (m_qParam * m_qParam - 4. * m_mParam * m_mParam));
+	real H1cos = (m_pParam / (2. * m_mParam * (m_pParam + m_qParam))) * sqrtpq * m_aParam;
+	real H2cos = (m_qParam / (2. * m_mParam * (m_pParam + m_qParam))) * sqrtpq * m_aParam;
+
+	// Shorthands (and their r and theta derivatives)
+	real delta = r2 + a2 - 2. * r * m_mParam;
+	real dr_delta = 2. * r - 2. * m_mParam;
+	real H3 = r2 - 2. * r * m_mParam + a2 * cost2;
+	real dr_H3 = 2. * r - 2. * m_mParam;
+	real dth_H3 = -2. * a2 * sint * cost;
+	real Bp = BpPrefactor * sint2 * (BpSlope * r - BpOffset) / H3;
+	real dr_Bp = BpPrefactor * sint2 * (BpSlope * H3 - (BpSlope * r - BpOffset) * dr_H3) / (H3 * H3);
+	real dth_Bp = BpPrefactor * (BpSlope * r - BpOffset) * (2. * sint * cost * H3 - sint2 * dth_H3) / (H3 * H3);
+
+	real H1 = r2 + a2 * cost2 + r * (m_pParam - 2. * m_mParam)
+		+ (m_pParam / (m_pParam + m_qParam)) * ((m_pParam - 2. * m_mParam) * (m_qParam - 2. * m_mParam) / 2.) - H1cos * cost;
+	real dr_H1 = 2. * r + (m_pParam - 2. * m_mParam);
+	real dth_H1 = -2. * a2 * sint * cost + H1cos * sint;
+	real H2 = r2 + a2 * cost2 + r * (m_qParam - 2. * m_mParam)
+		+ (m_qParam / (m_pParam + m_qParam)) * ((m_pParam - 2. * m_mParam) * (m_qParam - 2. * m_mParam) / 2.) + H2cos * cost;
+	real dr_H2 = 2. * r + (m_qParam - 2. * m_mParam);
+	real dth_H2 = -2. * a2 * sint * cost - H2cos * sint;
+
+	real sqH1H2 = sqrt(H1 * H2);
+	real dr_sqH1H2 = (dr_H1 * H2 + H1 * dr_H2) / (2. * sqH1H2);
+	real dth_sqH1H2 = (dth_H1 * H2 + H1 * dth_H2) / (2. * sqH1H2);
+
+	// Covariant metric elements
+	real g00 = -H3 / sqH1H2;
+	real g11 = sqH1H2 / delta;
+	real g22 = sqH1H2;
+	real g33 = -(H3 * Bp * Bp) / sqH1H2 + (sqH1H2 * delta * sint2) / H3;
+	real g03 = -(H3 * Bp) / sqH1H2;
+
+	// Contravariant metric elements
+	real g00_uu = ((H3 * H3 * Bp * Bp) / sint2 - H1 * H2 * delta) / (sqH1H2 * H3 * delta);
+	real g11_uu = delta / sqH1H2;
+	real g22_uu = 1. / sqH1H2;
+	real g33_uu = H3 / (sqH1H2 * delta * sint2);
+	real g03_uu = -(H3 * Bp) / (sqH1H2 * delta * sint2);
+	metric_uu = TwoIndex{ {{g00_uu, 0,0, g03_uu }, {0,g11_uu,0,0}, {0,0,g22_uu,0},{g03_uu,0,0,g33_uu}} };
+
+	// Derivatives of the covariant metric elements; only r and theta derivatives are nonzero
+	real sqH1H2sq = sqH1H2 * sqH1H2;
+	real dr_g00 = -(dr_H3 * sqH1H2 - H3 * dr_sqH1H2) / sqH1H2sq;
+	real dth_g00 = -(dth_H3 * sqH1H2 - H3 * dth_sqH1H2) / sqH1H2sq;
+	real dr_g11 = (dr_sqH1H2 * delta - sqH1H2 * dr_delta) / (delta * delta);
+	real dth_g11 = dth_sqH1H2 / delta;
+	real dr_g22 = dr_sqH1H2;
+	real dth_g22 = dth_sqH1H2;
+	real dr_g33 = -(dr_H3 * Bp * Bp + 2. * H3 * Bp * dr_Bp) / sqH1H2 + H3 * Bp * Bp * dr_sqH1H2 / sqH1H2sq
+		+ (dr_sqH1H2 * delta + sqH1H2 * dr_delta) * sint2 / H3 - sqH1H2 * delta * sint2 * dr_H3 / (H3 * H3);
+	real dth_g33 = -(dth_H3 * Bp * Bp + 2. * H3 * Bp * dth_Bp) / sqH1H2 + H3 * Bp * Bp * dth_sqH1H2 / sqH1H2sq
+		+ delta * (dth_sqH1H2 * sint2 + sqH1H2 * 2. * sint * cost) / H3 - sqH1H2 * delta * sint2 * dth_H3 / (H3 * H3);
+	real dr_g03 = -(dr_H3 * Bp + H3 * dr_Bp) / sqH1H2 + H3 * Bp * dr_sqH1H2 / sqH1H2sq;
+	real dth_g03 = -(dth_H3 * Bp + H3 * dth_Bp) / sqH1H2 + H3 * Bp * dth_sqH1H2 / sqH1H2sq;
+
+	metric_dd = TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
+	metric_dd_der = ThreeIndex{};
+	metric_dd_der[1] = TwoIndex{ {{dr_g00, 0,0, dr_g03 }, {0,dr_g11,0,0}, {0,0,dr_g22,0},{dr_g03,0,0,dr_g33}} };
+	metric_dd_der[2] = TwoIndex{ {{dth_g00, 0,0, dth_g03 }, {0,dth_g11,0,0}, {0,0,dth_g22,0},{dth_g03,0,0,dth_g33}} };
+
+	// Convert to logarithmic r coordinate if necessary
+	ConvertTorLogScale(r, metric_dd, metric_uu, metric_dd_der);
+}
+
 // Rasheed-Larsen description string; also gives a parameter value and whether we are using logarithmic radial coordinate
 std::string RasheedLarsenMetric::getFullDescriptionStr() const
 {
-	return "Rasheed-Larsen (m = " + std::to_string(m_mParam) + ", a = " + std::to_string(m_aParam) 
-		+ ", p = " + std::to_string(m_pParam) + ", q = " + std::to_string(m_qParam) + ", "
+	return "Rasheed-Larsen (m = " + RealToString(m_mParam) + ", a = " + RealToString(m_aParam) 
+		+ ", p = " + RealToString(m_pParam) + ", q = " + RealToString(m_qParam) + ", "
 		+ (m_rLogScale ? "using logarithmic r coord" : "using normal r coord") + ")";
 }
 
@@ -397,13 +844,17 @@ JohannsenMetric::JohannsenMetric(real aParam, real alpha13Param, real alpha22Par
 		|| m_eps3Param <= -horizon_radius * horizon_radius * horizon_radius
 		|| m_alpha13Param <= -horizon_radius * horizon_radius * horizon_radius)
 	{
-		ScreenOutput("Johannsen metric parameters outside of allowed range! Parameters given: a = " + std::to_string(m_aParam) + ", alpha13 = " + std::to_string(m_alpha13Param)
-			+ ", alpha22 = " + std::to_string(m_alpha22Param) + ", alpha52 = " + std::to_string(m_alpha52Param) + ", epsilon3 = " + std::to_string(m_eps3Param) + ".",
+		ScreenOutput("Johannsen metric parameters outside of allowed range! Parameters given: a = " + RealToString(m_aParam) + ", alpha13 = " + RealToString(m_alpha13Param)
+			+ ", alpha22 = " + RealToString(m_alpha22Param) + ", alpha52 = " + RealToString(m_alpha52Param) + ", epsilon3 = " + RealToString(m_eps3Param) + ".",
 			OutputLevel::Level_0_WARNING);
 	}
 
 	// Johannsen has a Killing vector along t and phi, so we initialize the symmetries accordingly
 	m_Symmetries = { 0,3 };
+	// The only nonzero components are g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi}
+	m_Structure = MetricStructure::CircularStationaryAxisymmetric;
+	// Johannsen only depends on theta through cos^2(theta) and sin^2(theta)
+	m_EquatoriallySymmetric = true;
 }
 
 TwoIndex JohannsenMetric::getMetric_dd(const Point& p) const
@@ -472,11 +923,98 @@ TwoIndex JohannsenMetric::getMetric_uu(const Point& p) const
 	return TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
 }
 
+// Johannsen metric (indices down and up) and its analytic derivatives, all calculated in one go
+void JohannsenMetric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	// If logscale is turned on, then the first coordinate is actually u = log(r), so r = e^u
+	real r = m_rLogScale ? exp(p[1]) : p[1];
+
+	real theta = p[2];
+	real sint = sin(theta);
+	real cost = cos(theta);
+
+	// Regularize sin(theta) near the polar axis (see SphericalHorizonMetric::PolarAxisThreshold)
+	RegularizeAtPolarAxis(sint, cost);
+
+	real sint2 = sint * sint;
+	real a2 = m_aParam * m_aParam;
+
+	// Shorthands (and their r and theta derivatives)
+	real A1 = 1. + m_alpha13Param / (r * r * r);
+	real dr_A1 = -3. * m_alpha13Param / (r * r * r * r);
+	real A2 = 1. + m_alpha22Param / (r * r);
+	real dr_A2 = -2. * m_alpha22Param / (r * r * r);
+	real A5 = 1. + m_alpha52Param / (r * r);
+	real dr_A5 = -2. * m_alpha52Param / (r * r * r);
+	real eps_f = m_eps3Param / r;
+
+	real rho2 = r * r + a2 * cost * cost + eps_f; // Sigma tilde in paper
+	real dr_rho2 = 2. * r - m_eps3Param / (r * r);
+	real dth_rho2 = -2. * a2 * sint * cost;
+	real delta = r * r + a2 - 2. * r;
+	real dr_delta = 2. * r - 2.;
+
+	// The common denominator of g00, g03, g33 is denom^2
+	real ra2 = r * r + a2;
+	real denom = ra2 * A1 - a2 * A2 * sint2;
+	real dr_denom = 2. * r * A1 + ra2 * dr_A1 - a2 * dr_A2 * sint2;
+	real dth_denom = -2. * a2 * A2 * sint * cost;
+	real denom2 = denom * denom;
+
+	// The numerators of g00, g03, g33 (without the common factor rho2 (sin theta)^2 for the latter two)
+	real N00 = delta - a2 * A2 * A2 * sint2;
+	real dr_N00 = dr_delta - 2. * a2 * A2 * dr_A2 * sint2;
+	real dth_N00 = -2. * a2 * A2 * A2 * sint * cost;
+	real N03 = ra2 * A1 * A2 - delta;
+	real dr_N03 = 2. * r * A1 * A2 + ra2 * (dr_A1 * A2 + A1 * dr_A2) - dr_delta;
+	real N33 = ra2 * A1 * ra2 * A1 - a2 * delta * sint2;
+	real dr_N33 = 2. * ra2 * A1 * (2. * r * A1 + ra2 * dr_A1) - a2 * dr_delta * sint2;
+	real dth_N33 = -2. * a2 * delta * sint * cost;
+	real S = rho2 * sint2;
+	real dr_S = dr_rho2 * sint2;
+	real dth_S = dth_rho2 * sint2 + 2. * rho2 * sint * cost;
+
+	// Covariant metric elements
+	real g00 = -rho2 * N00 / denom2;
+	real g11 = rho2 / (delta * A5);
+	real g22 = rho2;
+	real g33 = S * N33 / denom2;
+	real g03 = -m_aParam * N03 * S / denom2;
+
+	// Contravariant metric elements
+	real g00_uu = (-1. * ra2 * A1 * ra2 * A1 + a2 * delta * sint2) / (delta * rho2);
+	real g11_uu = delta * A5 / rho2;
+	real g22_uu = 1. / rho2;
+	real g33_uu = (-a2 * A2 * A2 * sint2 + delta) / (delta * rho2 * sint2);
+	real g03_uu = -m_aParam * (A2 * A1 * ra2 - delta) / (delta * rho2);
+	metric_uu = TwoIndex{ {{g00_uu, 0,0, g03_uu }, {0,g11_uu,0,0}, {0,0,g22_uu,0},{g03_uu,0,0,g33_uu}} };
+
+	// Derivatives of the covariant metric elements; only r and theta derivatives are nonzero
+	real dr_g00 = -(dr_rho2 * N00 + rho2 * dr_N00 - 2. * rho2 * N00 * dr_denom / denom) / denom2;
+	real dth_g00 = -(dth_rho2 * N00 + rho2 * dth_N00 - 2. * rho2 * N00 * dth_denom / denom) / denom2;
+	real dr_g11 = (dr_rho2 - g11 * (dr_delta * A5 + delta * dr_A5)) / (delta * A5);
+	real dth_g11 = dth_rho2 / (delta * A5);
+	real dr_g22 = dr_rho2;
+	real dth_g22 = dth_rho2;
+	real dr_g33 = (dr_S * N33 + S * dr_N33 - 2. * S * N33 * dr_denom / denom) / denom2;
+	real dth_g33 = (dth_S * N33 + S * dth_N33 - 2. * S * N33 * dth_denom / denom) / denom2;
+	real dr_g03 = -m_aParam * (dr_N03 * S + N03 * dr_S - 2. * N03 * S * dr_denom / denom) / denom2;
+	real dth_g03 = -m_aParam * (N03 * dth_S - 2. * N03 * S * dth_denom / denom) / denom2;
+
+	metric_dd = TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
+	metric_dd_der = ThreeIndex{};
+	metric_dd_der[1] = TwoIndex{ {{dr_g00, 0,0, dr_g03 }, {0,dr_g11,0,0}, {0,0,dr_g22,0},{dr_g03,0,0,dr_g33}} };
+	metric_dd_der[2] = TwoIndex{ {{dth_g00, 0,0, dth_g03 }, {0,dth_g11,0,0}, {0,0,dth_g22,0},{dth_g03,0,0,dth_g33}} };
+
+	// Convert to logarithmic r coordinate if necessary
+	ConvertTorLogScale(r, metric_dd, metric_uu, metric_dd_der);
+}
+
 // Johannsen description string; also gives a parameter value and whether we are using logarithmic radial coordinate
 std::string JohannsenMetric::getFullDescriptionStr() const
 {
-	return "Johannsen (a = " + std::to_string(m_aParam) + ", alpha13 = " + std::to_string(m_alpha13Param)
-		+ ", alpha22 = " + std::to_string(m_alpha22Param) + ", alpha52 = " + std::to_string(m_alpha52Param) + ", epsilon3 = " + std::to_string(m_eps3Param) + ", "
+	return "Johannsen (a = " + RealToString(m_aParam) + ", alpha13 = " + RealToString(m_alpha13Param)
+		+ ", alpha22 = " + RealToString(m_alpha22Param) + ", alpha52 = " + RealToString(m_alpha52Param) + ", epsilon3 = " + RealToString(m_eps3Param) + ", "
 		+ (m_rLogScale ? "using logarithmic r coord" : "using normal r coord") + ")";
 }
 
@@ -506,6 +1044,10 @@ MankoNovikovMetric::MankoNovikovMetric(real aParam, real alpha3Param, bool rLogS
 
 	// Manko-Novikov BH has a Killing vector along t and phi, so we initialize the symmetries accordingly
 	m_Symmetries = { 0,3 };
+	// The only nonzero components are g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi}
+	m_Structure = MetricStructure::CircularStationaryAxisymmetric;
+	// The octupole deformation alpha3 breaks the reflection symmetry
+	m_EquatoriallySymmetric = (m_alpha3Param == 0.0);
 }
 
 TwoIndex MankoNovikovMetric::getMetric_dd(const Point& p) const
@@ -625,12 +1167,191 @@ TwoIndex MankoNovikovMetric::getMetric_uu(const Point& p) const
 	return TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
 }
 
+// Manko-Novikov metric (indices down and up) and its analytic derivatives, all calculated in one go.
+// All auxiliary functions depend on r and theta only through xx and yy, so we first calculate their derivatives
+// with respect to xx and yy (index 0 resp. 1 of the d_... arrays) and convert these to r and theta derivatives at the end.
+void MankoNovikovMetric::getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const
+{
+	// spherical coordinates
+	// If logscale is turned on, then the first coordinate is actually u = log(r), so r = e^u
+	real r = m_rLogScale ? exp(p[1]) : p[1];
+
+	real theta = p[2];
+	real sint = sin(theta);
+	real cost = cos(theta);
+
+	// Regularize sin(theta) near the polar axis (see SphericalHorizonMetric::PolarAxisThreshold)
+	RegularizeAtPolarAxis(sint, cost);
+
+	// auxiliary functions
+	real xx = (r - 1.) / m_kParam;
+	real yy = cost;
+	constexpr real d_xx[2]{ 1., 0. };
+	constexpr real d_yy[2]{ 0., 1. };
+
+	real R = sqrt(xx * xx + yy * yy - 1.);
+	real iR = 1. / R;
+	real iR2 = iR * iR;
+	real iR3 = iR2 * iR;
+	real iR4 = iR2 * iR2;
+
+	// Legendre polynomials in xx * yy / R (and their derivatives wrt this argument)
+	real u = xx * yy * iR;
+	real P1 = u;
+	real P2 = 0.5 * (3. * u * u - 1.);
+	real P3 = 0.5 * (5. * u * u * u - 3. * u);
+	real P4 = 0.125 * (35. * u * u * u * u - 30. * u * u + 3.);
+	real du_P2 = 3. * u;
+	real du_P3 = 0.5 * (15. * u * u - 3.);
+	real du_P4 = 0.5 * (35. * u * u * u - 15. * u);
+
+	real Sa = iR + P1 * iR2 + P2 * iR3 + P3 * iR4;
+	real Sb = iR - P1 * iR2 + P2 * iR3 - P3 * iR4;
+	real aa = -m_alphaParam * exp(2. * m_alpha3Param * (1. - (xx - yy) * Sa));
+	real bb = m_alphaParam * exp(2. * m_alpha3Param * (-1. + (xx + yy) * Sb));
+	real ab = aa * bb;
+
+	real AA = (xx * xx - 1.) * (1. + ab) * (1. + ab) - (1. - yy * yy) * (bb - aa) * (bb - aa);
+	real B1 = xx + 1. + (xx - 1.) * ab;
+	real B2 = (1. + yy) * aa + (1. - yy) * bb;
+	real BB = B1 * B1 + B2 * B2;
+	real C3 = bb - aa - yy * (aa + bb);
+	real C6 = 1. + ab + xx * (1. - ab);
+	real CC = (xx * xx - 1.) * (1. + ab) * C3 + (1. - yy * yy) * (bb - aa) * C6;
+
+	real psi = m_alpha3Param * P3 * iR4;
+	real G = -yy + xx * P1 * iR - yy * P2 * iR2 + xx * P3 * iR3;
+	real gamma_prime = 2. * m_alpha3Param * m_alpha3Param * (P4 * P4 - P3 * P3) * iR4 * iR4 + 2. * m_alpha3Param * G * iR;
+
+	real exp_2psi = exp(2. * psi);
+	real exp_2gamma_prime = exp(2. * gamma_prime);
+	real xxyy = xx * xx - yy * yy;
+	real alphafactor = (1. - m_alphaParam * m_alphaParam) * (1. - m_alphaParam * m_alphaParam);
+
+	real f = exp_2psi * AA / BB;
+	real exp_2gamma = exp_2gamma_prime * AA / (xxyy * alphafactor);
+	real omega = 2. * m_kParam * CC / (exp_2psi * AA) - 4. * m_kParam * m_alphaParam / (1. - m_alphaParam * m_alphaParam);
+
+	// Derivatives of f, exp_2gamma and omega wrt xx (i = 0) and yy (i = 1)
+	real d_f[2]{};
+	real d_exp_2gamma[2]{};
+	real d_omega[2]{};
+	for (int i = 0; i < 2; ++i)
+	{
+		real d_iR = -(xx * d_xx[i] + yy * d_yy[i]) * iR3;
+		real d_u = (d_xx[i] * yy + xx * d_yy[i]) * iR + xx * yy * d_iR;
+		real d_P1 = d_u;
+		real d_P2 = du_P2 * d_u;
+		real d_P3 = du_P3 * d_u;
+		real d_P4 = du_P4 * d_u;
+
+		real d_Sa = d_iR * (1. + 2. * P1 * iR + 3. * P2 * iR2 + 4. * P3 * iR3) + d_P1 * iR2 + d_P2 * iR3 + d_P3 * iR4;
+		real d_Sb = d_iR * (1. - 2. * P1 * iR + 3. * P2 * iR2 - 4. * P3 * iR3) - d_P1 * iR2 + d_P2 * iR3 - d_P3 * iR4;
+		real d_aa = -2. * m_alpha3Param * aa * ((d_xx[i] - d_yy[i]) * Sa + (xx - yy) * d_Sa);
+		real d_bb = 2. * m_alpha3Param * bb * ((d_xx[i] + d_yy[i]) * Sb + (xx + yy) * d_Sb);
+		real d_ab = d_aa * bb + aa * d_bb;
+
+		real d_AA = 2. * xx * d_xx[i] * (1. + ab) * (1. + ab) + 2. * (xx * xx - 1.) * (1. + ab) * d_ab
+			+ 2. * yy * d_yy[i] * (bb - aa) * (bb - aa) - 2. * (1. - yy * yy) * (bb - aa) * (d_bb - d_aa);
+		real d_B1 = d_xx[i] * (1. + ab) + (xx - 1.) * d_ab;
+		real d_B2 = d_yy[i] * (aa - bb) + (1. + yy) * d_aa + (1. - yy) * d_bb;
+		real d_BB = 2. * B1 * d_B1 + 2. * B2 * d_B2;
+		real d_C3 = d_bb - d_aa - d_yy[i] * (aa + bb) - yy * (d_aa + d_bb);
+		real d_C6 = d_ab + d_xx[i] * (1. - ab) - xx * d_ab;
+		real d_CC = 2. * xx * d_xx[i] * (1. + ab) * C3 + (xx * xx - 1.) * (d_ab * C3 + (1. + ab) * d_C3)
+			- 2. * yy * d_yy[i] * (bb - aa) * C6 + (1. - yy * yy) * ((d_bb - d_aa) * C6 + (bb - aa) * d_C6);
+
+		real d_psi = m_alpha3Param * (d_P3 * iR4 + 4. * P3 * iR3 * d_iR);
+		real d_G = -d_yy[i] + (d_xx[i] * P1 + xx * d_P1) * iR + xx * P1 * d_iR
+			- (d_yy[i] * P2 + yy * d_P2) * iR2 - 2. * yy * P2 * iR * d_iR
+			+ (d_xx[i] * P3 + xx * d_P3) * iR3 + 3. * xx * P3 * iR2 * d_iR;
+		real d_gamma_prime = 4. * m_alpha3Param * m_alpha3Param * (P4 * d_P4 - P3 * d_P3) * iR4 * iR4
+			+ 16. * m_alpha3Param * m_alpha3Param * (P4 * P4 - P3 * P3) * iR4 * iR3 * d_iR
+			+ 2. * m_alpha3Param * (d_G * iR + G * d_iR);
+
+		d_f[i] = exp_2psi * (2. * d_psi * AA + d_AA - AA * d_BB / BB) / BB;
+		d_exp_2gamma[i] = exp_2gamma_prime * (2. * d_gamma_prime * AA + d_AA - 2. * AA * (xx * d_xx[i] - yy * d_yy[i]) / xxyy)
+			/ (xxyy * alphafactor);
+		d_omega[i] = 2. * m_kParam * ((d_CC - 2. * d_psi * CC) / AA - CC * d_AA / (AA * AA)) / exp_2psi;
+	}
+
+	// Convert to r and theta derivatives: dxx/dr = 1/k, dyy/dtheta = -sin(theta)
+	real dr_f = d_f[0] / m_kParam;
+	real dth_f = -sint * d_f[1];
+	real dr_exp_2gamma = d_exp_2gamma[0] / m_kParam;
+	real dth_exp_2gamma = -sint * d_exp_2gamma[1];
+	real dr_omega = d_omega[0] / m_kParam;
+	real dth_omega = -sint * d_omega[1];
+
+	real rho_sq = (r - 1.) * (r - 1.) - m_kParam * m_kParam * cost * cost;
+	real dr_rho_sq = 2. * (r - 1.);
+	real dth_rho_sq = 2. * m_kParam * m_kParam * cost * sint;
+	real delta = (r - 1.) * (r - 1.) - m_kParam * m_kParam;
+	real dr_delta = 2. * (r - 1.);
+
+	// covariant metric components
+	real g00 = -f;
+	real g22 = exp_2gamma * rho_sq / f;
+	real g11 = g22 / delta;
+	real g33 = -f * omega * omega + delta * sint * sint / f;
+	real g03 = omega * f;
+
+	// metric functions
+	real beta_d = g03;
+	real beta_u = beta_d / g33;
+	real alpha_sq = beta_u * beta_d + f;
+
+	// contravariant metric components
+	real g00_uu = -1. / alpha_sq;
+	real g22_uu = 1. / g22;
+	real g11_uu = delta * g22_uu;
+	real g33_uu = 1. / g33 - beta_u * beta_u / alpha_sq;
+	real g03_uu = beta_u / alpha_sq;
+	metric_uu = TwoIndex{ {{g00_uu, 0,0, g03_uu }, {0,g11_uu,0,0}, {0,0,g22_uu,0},{g03_uu,0,0,g33_uu}} };
+
+	// Derivatives of the covariant metric elements; only r and theta derivatives are nonzero
+	real dr_g00 = -dr_f;
+	real dth_g00 = -dth_f;
+	real dr_g22 = (dr_exp_2gamma * rho_sq + exp_2gamma * dr_rho_sq - g22 * dr_f) / f;
+	real dth_g22 = (dth_exp_2gamma * rho_sq + exp_2gamma * dth_rho_sq - g22 * dth_f) / f;
+	real dr_g11 = (dr_g22 - g11 * dr_delta) / delta;
+	real dth_g11 = dth_g22 / delta;
+	real dr_g33 = -dr_f * omega * omega - 2. * f * omega * dr_omega
+		+ dr_delta * sint * sint / f - delta * sint * sint * dr_f / (f * f);
+	real dth_g33 = -dth_f * omega * omega - 2. * f * omega * dth_omega
+		+ 2. * delta * sint * cost / f - delta * sint * sint * dth_f / (f * f);
+	real dr_g03 = dr_omega * f + omega * dr_f;
+	real dth_g03 = dth_omega * f + omega * dth_f;
+
+	metric_dd = TwoIndex{ {{g00, 0,0, g03 }, {0,g11,0,0}, {0,0,g22,0},{g03,0,0,g33}} };
+	metric_dd_der = ThreeIndex{};
+	metric_dd_der[1] = TwoIndex{ {{dr_g00, 0,0, dr_g03 }, {0,dr_g11,0,0}, {0,0,dr_g22,0},{dr_g03,0,0,dr_g33}} };
+	metric_dd_der[2] = TwoIndex{ {{dth_g00, 0,0, dth_g03 }, {0,dth_g11,0,0}, {0,0,dth_g22,0},{dth_g03,0,0,dth_g33}} };
+
+	// Convert to logarithmic r coordinate if necessary
+	ConvertTorLogScale(r, metric_dd, metric_uu, metric_dd_der);
+}
+
 // Manko-Novikov description string; also gives a parameter value and whether we are using logarithmic radial coordinate
 std::string MankoNovikovMetric::getFullDescriptionStr() const
 {
-	return "Manko-Novikov (a = " + std::to_string(m_aParam) + ", alpha3 = " + std::to_string(m_alpha3Param)
+	return "Manko-Novikov (a = " + RealToString(m_aParam) + ", alpha3 = " + RealToString(m_alpha3Param)
 		+ ", " + (m_rLogScale ? "using logarithmic r coord" : "using normal r coord") + ")";
 }
 
 
-//// (New Metric classes can define their member functions here)
\ No newline at end of file
+//// (New Metric classes can define their member functions here)
+
+
+
+/// <summary>
+/// Explicit instantiations of the Christoffel contraction for Metrics of known type
+/// (instantiated here, at the end of the file, so that the Metric member functions can be inlined;
+/// every Metric listed in Integrators::SpecializedMetrics must be instantiated here)
+/// </summary>
+
+template OneIndex Metric::getChristoffelContractionStatic<KerrMetric>(const KerrMetric&, const Point&, const OneIndex&);
+template OneIndex Metric::getChristoffelContractionStatic<FlatSpaceMetric>(const FlatSpaceMetric&, const Point&, const OneIndex&);
+template OneIndex Metric::getChristoffelContractionStatic<RasheedLarsenMetric>(const RasheedLarsenMetric&, const Point&, const OneIndex&);
+template OneIndex Metric::getChristoffelContractionStatic<JohannsenMetric>(const JohannsenMetric&, const Point&, const OneIndex&);
+template OneIndex Metric::getChristoffelContractionStatic<MankoNovikovMetric>(const MankoNovikovMetric&, const Point&, const OneIndex&);
\ No newline at end of file
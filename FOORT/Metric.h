@@ -14,6 +14,17 @@
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
+// The (structural) sparsity of the metric, which can be exploited when constructing and contracting
+// the Christoffel symbols. Should be set by descendant constructor (in m_Structure) if applicable.
+enum class MetricStructure
+{
+	// No assumptions on the metric
+	General,
+	// Only g_{tt}, g_{t\phi}, g_{rr}, g_{\theta\theta}, g_{\phi\phi} are nonzero, and they only depend on r and theta
+	// (symmetries {0,3}); then only 20 independent Christoffel symbols are nonzero
+	CircularStationaryAxisymmetric
+};
+
 // The abstract base class for all Metrics.
 class Metric
 {
@@ -29,6 +40,17 @@ public:
 	// Get the metric at Point p, indices up
 	virtual TwoIndex getMetric_uu(const Point& p) const = 0;	
 
+	// Get the metric with indices down and up, and the derivatives of the metric (indices down) at Point p all at once;
+	// metric_dd_der[coord][i][j] = \partial_{coord} g_{ij}.
+	// The base class implementation calls getMetric_dd() and getMetric_uu() and uses finite differences for the derivatives,
+	// BUT it is left as a virtual function so that metrics can calculate all three in a single pass
+	// (sharing all intermediate quantities between them).
+	// All other derivative quantities (Christoffel symbols etc.) are calculated from this function.
+	// Note: the returned metric is the same as getMetric_dd() and getMetric_uu(), EXCEPT very close to the polar axis
+	// for the metrics that regularize it there (see SphericalHorizonMetric::PolarAxisThreshold): for those, the metric
+	// (as well as its derivatives) is evaluated at the regularized theta, so that metric_uu stays finite on the axis.
+	virtual void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const;
+
 	// The following functions return the Christoffel and other derivative quantities of the metric.
 	// They are implemented for this base class, BUT are left as virtual functions to allow for
 	// other metrics to implement their own (more efficient)
@@ -36,6 +58,17 @@ public:
 	// 
 	// Get the Christoffel symbol, indices up-down-down
 	virtual ThreeIndex getChristoffel_udd(const Point& p) const;
+	// Get the Christoffel symbol contracted twice with the vector v, Gamma^a_{bc} v^b v^c (as in the geodesic equation)
+	virtual OneIndex getChristoffelContraction(const Point& p, const OneIndex& v) const;
+	// The same contraction (as calculated by the base class implementation of getChristoffelContraction()), for a Metric
+	// whose (final) type MetricType is known at compile time: the metric and its derivatives are then evaluated without going
+	// through the vtable, so that the whole calculation can be inlined (used by the metric-specialized integrators,
+	// see Integrators::SpecializeIntegrator()). Explicitly instantiated in Metric.cpp for all Metrics that are specialized
+	template<typename MetricType>
+	static OneIndex getChristoffelContractionStatic(const MetricType& theMetric, const Point& p, const OneIndex& v);
+	// Batched version of getChristoffelContraction(), for BatchSize points and vectors at once (in structure-of-arrays layout).
+	// The base class implementation calls getChristoffelContraction() for every member of the batch.
+	virtual BatchOneIndex getChristoffelContractionBatch(const BatchPoint& p, const BatchOneIndex& v) const;
 	// Get the Riemann tensor, indices up-down-down-down
 	virtual FourIndex getRiemann_uddd(const Point& p) const;
 	// Get the Kretschmann scalar
@@ -46,9 +79,31 @@ public:
 	// There is a base class implementation of this function returning an undescriptive string
 	virtual std::string getFullDescriptionStr() const;
 
+	// Getter for the structure of the metric
+	MetricStructure getStructure() const;
+	// Getter for whether the metric is invariant under the equatorial reflection theta -> pi - theta
+	// (used by the ViewScreen to mirror pixels of a camera sitting on the equator)
+	bool IsEquatoriallySymmetric() const;
+
 protected:
 	// The symmetries (coordinate Killing vectors) of the metric. Should be set by descendant constructor.
 	std::vector<int> m_Symmetries{};
+	// The sparsity structure of the metric. Should be set by descendant constructor.
+	MetricStructure m_Structure{ MetricStructure::General };
+	// Is the metric invariant under theta -> pi - theta? Should be set by descendant constructor (if true).
+	bool m_EquatoriallySymmetric{ false };
+
+	// Helper function that constructs the Christoffel symbol from the metric (indices up) and the metric derivatives
+	// (indices down), where metric_dd_der[coord][i][j] = \partial_{coord} g_{ij}.
+	// Used by getChristoffel_udd(), but also available for descendants overriding getChristoffel_udd().
+	// The template parameter determines which components are calculated (all for MetricStructure::General);
+	// explicitly instantiated for all MetricStructures in Metric.cpp
+	template<MetricStructure Structure>
+	static ThreeIndex ChristoffelFromDerivatives(const TwoIndex& metric_uu, const ThreeIndex& metric_dd_der);
+	// Helper function that contracts the Christoffel symbol twice with the vector v,
+	// only summing over those components that can be nonzero for the given MetricStructure
+	template<MetricStructure Structure>
+	static OneIndex ContractChristoffel(const ThreeIndex& christoffel, const OneIndex& v);
 };
 
 
@@ -70,6 +125,25 @@ protected:
 	const real m_HorizonRadius;
 	// Are we using a logarithmic r coordinate?
 	const bool m_rLogScale;
+
+	// Descendants that calculate their metric derivatives analytically regularize sin(theta) near the polar axis:
+	// if |sin(theta)| is below PolarAxisThreshold, sin(theta) and cos(theta) are replaced by their values at
+	// |sin(theta)| = PolarAxisThreshold (with the same signs), see RegularizeAtPolarAxis().
+	// Otherwise, a ray that (nearly) crosses the axis, with u_phi (almost) exactly zero, meets the centrifugal barrier
+	// at theta ~ 1e-14, which no step size can resolve, and blows up. With the regularization, such a ray passes
+	// through the axis instead (and Geodesic::UpdateWithStep() maps it back to 0 <= theta <= pi).
+	// The regularization is applied in getMetricAndDerivatives() (and the quantities calculated from it), to the metric
+	// it returns as well as to the derivatives; getMetric_dd() and getMetric_uu() always return the exact metric.
+	static constexpr real PolarAxisThreshold{ 1e-5 };
+	static constexpr real PolarAxisCosine{ 1. - PolarAxisThreshold * PolarAxisThreshold / 2. }; // sqrt(1 - PolarAxisThreshold^2)
+
+	// Helper function that applies the regularization described above to sint = sin(theta) and cost = cos(theta)
+	static void RegularizeAtPolarAxis(real& sint, real& cost);
+
+	// Helper function for descendants that calculate their metric derivatives analytically in the normal r coordinate:
+	// if m_rLogScale is set, this converts the metric (indices down and up) and the metric derivatives
+	// to the coordinate u = log(r). Must be passed r (not u).
+	void ConvertTorLogScale(real r, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const;
 };
 
 
@@ -93,6 +167,12 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The override of the combined metric and metric derivatives getter, using the analytic metric derivatives
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
+	// The override of the batched Christoffel contraction, written out explicitly so that it can be vectorized over the batch
+	BatchOneIndex getChristoffelContractionBatch(const BatchPoint& p, const BatchOneIndex& v) const final;
+
 	// The override of the description string getter
 	std::string getFullDescriptionStr() const final;
 };
@@ -109,6 +189,9 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The override of the combined metric and metric derivatives getter, using the analytic metric derivatives
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
 	// The override of the description string getter
 	std::string getFullDescriptionStr() const final;
 };
@@ -133,6 +216,9 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The override of the combined metric and metric derivatives getter, using the analytic metric derivatives
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
 	// The override of the description string getter
 	std::string getFullDescriptionStr() const final;
 };
@@ -158,6 +244,9 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The override of the combined metric and metric derivatives getter, using the analytic metric derivatives
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
 	// The override of the description string getter
 	std::string getFullDescriptionStr() const final;
 };
@@ -184,6 +273,9 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The override of the combined metric and metric derivatives getter, using the analytic metric derivatives
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
 	// The override of the description string getter
 	std::string getFullDescriptionStr() const final;
 };
@@ -195,6 +287,8 @@ public:
 // Give definitions (implementation) of these functions in Metric.cpp (or other source code file)
 // Don't forget to set m_Symmetries appropriately (in the constructor),
 // if your metric has any symmetry (e.g. stationarity, axisymmetry)!
+// If your metric only has nonzero tt, tphi, rr, thetatheta, phiphi components (depending only on r and theta),
+// also set m_Structure = MetricStructure::CircularStationaryAxisymmetric (in the constructor) to speed up computations.
 // Sample code:
 /*
 class MyMetric final : public Metric // good practice to make the class final unless descendant classes are possible
@@ -208,6 +302,13 @@ public:
 	TwoIndex getMetric_dd(const Point& p) const final;
 	TwoIndex getMetric_uu(const Point& p) const final;
 
+	// The combined metric and metric derivatives getter
+	// This is optional to implement; if not implemented, the base class Metric::getMetricAndDerivatives()
+	// will call the basic getter functions and calculate the derivatives using finite differences of getMetric_dd().
+	// If the metric derivatives are known analytically, overriding this is much faster (and more accurate),
+	// since all intermediate quantities can then be shared between the metric, its inverse and its derivatives.
+	void getMetricAndDerivatives(const Point& p, TwoIndex& metric_dd, TwoIndex& metric_uu, ThreeIndex& metric_dd_der) const final;
+
 	// The description string getter
 	// This is optional (but recommended) to implement; if not implemented,
 	// the base class Metric::getFullDescriptionStr() will be called instead
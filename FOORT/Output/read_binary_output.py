@@ -0,0 +1,82 @@
+"""
+Reader for FOORT binary output files (Output Format = "Binary" in the configuration file).
+
+File layout (native byte order, i.e. little-endian on all usual platforms; see InputOutput.h):
+    Header:  8 bytes "FOORTBIN"; uint32 version; uint32 number of screen index components k;
+             uint32 length + Diagnostic name; uint32 length + run information string (can be empty)
+    Records: k uint64's (screen index); uint32 n (number of values); n doubles (values)
+
+Usage:
+    from read_binary_output import read_foort_binary
+    info = read_foort_binary("Output/Test_FourColorScreen.dat")
+    info["indices"]  # (N, k) array of screen indices
+    info["values"]   # (N, n) array if all records have n values, otherwise a list of N arrays
+
+Requires numpy.
+"""
+
+import struct
+import sys
+
+import numpy as np
+
+
+def read_foort_binary(filename):
+    with open(filename, "rb") as f:
+        data = f.read()
+
+    if data[:8] != b"FOORTBIN":
+        raise ValueError(filename + " is not a FOORT binary output file")
+    pos = 8
+    version, nrindices = struct.unpack_from("<II", data, pos)
+    pos += 8
+
+    def read_string(pos):
+        (length,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        return data[pos:pos + length].decode(), pos + length
+
+    diagname, pos = read_string(pos)
+    runinfo, pos = read_string(pos)
+
+    indexbytes = 8 * nrindices
+    result = {"version": version, "diagnostic": diagname, "info": runinfo}
+
+    # Fast path: if the first record's number of values n fits all records (true for most Diagnostics),
+    # then all records have the same width and we can read them all at once
+    nrbytes = len(data) - pos
+    if nrbytes == 0:
+        result["indices"] = np.zeros((0, nrindices), dtype=np.uint64)
+        result["values"] = np.zeros((0, 0))
+        return result
+    (n,) = struct.unpack_from("<I", data, pos + indexbytes)
+    recordtype = np.dtype([("index", "<u8", (nrindices,)), ("n", "<u4"), ("values", "<f8", (n,))])
+    if nrbytes % recordtype.itemsize == 0:
+        records = np.frombuffer(data, dtype=recordtype, offset=pos)
+        if np.all(records["n"] == n):
+            result["indices"] = records["index"].copy()
+            result["values"] = records["values"].copy()
+            return result
+
+    # General case: records of different widths
+    indices = []
+    values = []
+    while pos < len(data):
+        indices.append(np.frombuffer(data, dtype="<u8", count=nrindices, offset=pos))
+        pos += indexbytes
+        (n,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        values.append(np.frombuffer(data, dtype="<f8", count=n, offset=pos))
+        pos += 8 * n
+    result["indices"] = np.array(indices, dtype=np.uint64).reshape(-1, nrindices)
+    result["values"] = values
+    return result
+
+
+if __name__ == "__main__":
+    # Print a binary output file in the same form as a text output file
+    for filename in sys.argv[1:]:
+        out = read_foort_binary(filename)
+        print(out["info"])
+        for index, vals in zip(out["indices"], out["values"]):
+            print(" ".join(str(i) for i in index), " ".join(repr(float(v)) for v in vals))
@@ -62,48 +62,24 @@ TerminationUniqueVector CreateTerminationVector(TermBitflag termflags, Geodesic
 
 void Termination::Reset()
 {
-	// Reset to 0 to start integrating new geodesic
-	m_StepsSinceUpdated = 0;
-}
-
-// This helper function returns true if the Termination should update its internal status. Should be called from within
-// CheckTermination() with the appropriate TermOptions::UpdateEveryNSteps
-bool Termination::DecideUpdate(largecounter UpdateNSteps)
-{
-	bool decideupdate = false;
-
-	if (UpdateNSteps == 0) // we always update
-		decideupdate = true;
-	else // we only update every so many steps
-	{
-		// increase step counter and check if it is time to update
-		++m_StepsSinceUpdated;
-		if (m_StepsSinceUpdated >= UpdateNSteps)
-		{
-			// Time to update and reset step counter
-			decideupdate = true;
-			m_StepsSinceUpdated = 0;
-		}
-	}
-
-	return decideupdate;
+	// Nothing to reset in the base class
 }
 
 /// <summary>
 /// HorizonTermination functions
 /// </summary>
 
-Term HorizonTermination::CheckTermination()
+Term HorizonTermination::CheckTermination(const Point& pos, largecounter step)
 {
 	Term ret = Term::Continue;
 
 	// Check if we are allowed to update (i.e. check for termination)
-	if (DecideUpdate(TermOptions->UpdateEveryNSteps))
+	if (DecideUpdate(TermOptions->UpdateEveryNSteps, step))
 	{
 
 		// Check to see if radius is almost at horizon;
 		// if we are using a logarithmic r scale (u=log(r)) then first exponentiate to get true radius
-		real thegeodesicr = (m_OwnerGeodesic->getCurrentPos())[1];
+		real thegeodesicr = pos[1];
 		real r = TermOptions->rLogScale ? exp(thegeodesicr) : thegeodesicr;
 		// Check if we are almost at the horizon; the second check is for horizons which are at r=0
 		if ( (r < TermOptions->HorizonRadius * (1 + TermOptions->AtHorizonEps))
@@ -119,7 +95,7 @@ Term HorizonTermination::CheckTermination()
 std::string HorizonTermination::getFullDescriptionStr() const
 {
 	// Full description string
-	return "Horizon (stop at " + std::to_string(1 + TermOptions->AtHorizonEps) + "x(horizon radius))";
+	return "Horizon (stop at " + RealToString(1 + TermOptions->AtHorizonEps) + "x(horizon radius))";
 }
 
 /// <summary>
@@ -127,16 +103,16 @@ std::string HorizonTermination::getFullDescriptionStr() const
 /// </summary>
 
 // Check to see if Boundary Sphere is reached, if so return Term::BoundarySphere
-Term BoundarySphereTermination::CheckTermination() 
+Term BoundarySphereTermination::CheckTermination(const Point& pos, largecounter step)
 {
 	Term ret = Term::Continue;
 
 	// Check if we are allowed to update (i.e. check for termination)
-	if (DecideUpdate(TermOptions->UpdateEveryNSteps))
+	if (DecideUpdate(TermOptions->UpdateEveryNSteps, step))
 	{
 		// Check to see if we reached (past) the boundary sphere
 		// if we are using a logarithmic r scale (u=log(r)) then first exponentiate to get true radius
-		real thegeodesicr = (m_OwnerGeodesic->getCurrentPos())[1];
+		real thegeodesicr = pos[1];
 		real r = TermOptions->rLogScale ? exp(thegeodesicr) : thegeodesicr;
 		if (r > TermOptions->SphereRadius)
 			ret = Term::BoundarySphere;
@@ -148,7 +124,7 @@ Term BoundarySphereTermination::CheckTermination()
 std::string BoundarySphereTermination::getFullDescriptionStr() const
 {
 	// Full description string
-	return "Boundary sphere (R = " + std::to_string(TermOptions->SphereRadius) + ")";
+	return "Boundary sphere (R = " + RealToString(TermOptions->SphereRadius) + ")";
 }
 
 
@@ -165,11 +141,11 @@ void TimeOutTermination::Reset()
 }
 
 // Check to see if enough steps have been taken to time out, if so return Term::TimeOut
-Term TimeOutTermination::CheckTermination()
+Term TimeOutTermination::CheckTermination([[maybe_unused]] const Point& pos, largecounter step)
 {
 	Term ret = Term::Continue;
 
-	if (DecideUpdate(TermOptions->UpdateEveryNSteps))
+	if (DecideUpdate(TermOptions->UpdateEveryNSteps, step))
 	{
 		// Check to see if we have done enough steps to time out the integration already
 		if (m_CurNrSteps >= TermOptions->MaxSteps)
@@ -197,14 +173,14 @@ std::string TimeOutTermination::getFullDescriptionStr() const
 /// </summary>
 
 // Check to see if enough steps have been taken to time out, if so return Term::TimeOut
-Term ThetaSingularityTermination::CheckTermination()
+Term ThetaSingularityTermination::CheckTermination(const Point& pos, largecounter step)
 {
 	Term ret = Term::Continue;
 
-	if (DecideUpdate(TermOptions->UpdateEveryNSteps))
+	if (DecideUpdate(TermOptions->UpdateEveryNSteps, step))
 	{
 		// Check to see if theta is too close to a pole
-		real theta{ m_OwnerGeodesic->getCurrentPos()[2] };
+		real theta{ pos[2] };
 		real eps{ TermOptions->ThetaSingEpsilon };
 		if (fabs(theta) < eps || fabs(pi - theta) < eps)
 			ret = Term::ThetaSingularity;
@@ -216,7 +192,7 @@ Term ThetaSingularityTermination::CheckTermination()
 std::string ThetaSingularityTermination::getFullDescriptionStr() const
 {
 	// Full description string
-	return "Theta singularity (epsilon: " + std::to_string(TermOptions->ThetaSingEpsilon) + ")";
+	return "Theta singularity (epsilon: " + RealToString(TermOptions->ThetaSingEpsilon) + ")";
 }
 
 
@@ -82,17 +82,18 @@ public:
 
 	// Resets Termination object. This is called when the owner Geodesic is reset in order to start integrating
 	// a new geodesic.
-	// The base class implementation only resets m_StepsSinceUpdated
-	// Descendants can override this if they need to reset additional internal variables
+	// The base class implementation does nothing (the base class has no internal state)
+	// Descendants can override this if they need to reset internal variables
 	virtual void Reset();
 
 	// virtual destructor to ensure correct destruction of descendants
 	virtual ~Termination() = default;
 
-	// Function that is called to determine whether Termination wants to
+	// Function that is called (after every step) to determine whether Termination wants to
 	// terminate the Geodesic. Returns Term::Continue if no termination wanted,
-	// otherwise it returns the appropriate Term condition
-	virtual Term CheckTermination() = 0;
+	// otherwise it returns the appropriate Term condition.
+	// The owner Geodesic passes its current position and the number of steps it has taken (step >= 1)
+	virtual Term CheckTermination(const Point& pos, largecounter step) = 0;
 
 	// This returns the full description of the Termination
 	virtual std::string getFullDescriptionStr() const = 0;
@@ -101,13 +102,13 @@ protected:
 	// The geodesic that owns the Termination (a const pointer to the Geodesic)
 	Geodesic* const m_OwnerGeodesic;
 
-	// Helper function to decide if the Termination should indeed update its status, based on
-	// UpdateNSteps (which is set to 0 if we always update)
-	bool DecideUpdate(largecounter UpdateNSteps);
-
-	// The termination is itself in charge of keeping track of how many steps it has been since it has been updated
-	// The Termination's TerminationOptions struct tells it how many steps it needs to wait between updates
-	largecounter m_StepsSinceUpdated{};
+	// Helper function to decide if the Termination should indeed update its status at the given step, based on
+	// UpdateNSteps (which is set to 0 if we always update): it updates every UpdateNSteps steps
+	// (defined here so that it can be inlined in CheckTermination())
+	static bool DecideUpdate(largecounter UpdateNSteps, largecounter step)
+	{
+		return UpdateNSteps == 0 || step % UpdateNSteps == 0;
+	}
 };
 
 // The owner vector of derived Termination classes
@@ -130,7 +131,7 @@ public:
 	HorizonTermination(Geodesic* const theGeodesic) : Termination(theGeodesic) {}
 
 	// Check if we are too close to the horizon
-	Term CheckTermination() final;
+	Term CheckTermination(const Point& pos, largecounter step) final;
 
 	// Description string
 	std::string getFullDescriptionStr() const final;
@@ -151,7 +152,7 @@ public:
 	BoundarySphereTermination(Geodesic* const theGeodesic) : Termination(theGeodesic) {}
 
 	// Check if we have passed the boundary sphere
-	Term CheckTermination() final;
+	Term CheckTermination(const Point& pos, largecounter step) final;
 
 	// Description string
 	std::string getFullDescriptionStr() const final;
@@ -176,7 +177,7 @@ public:
 	void Reset() final;
 
 	// Check if we have already taken too many steps
-	Term CheckTermination() final;
+	Term CheckTermination(const Point& pos, largecounter step) final;
 
 	// Description string
 	std::string getFullDescriptionStr() const final;
@@ -199,7 +200,7 @@ public:
 	// No override of Reset() necessary
 
 	// Check the specific termination condition
-	Term CheckTermination() final;
+	Term CheckTermination(const Point& pos, largecounter step) final;
 
 	// Description string
 	std::string getFullDescriptionStr() const final;
@@ -211,6 +212,7 @@ public:
 
 //// TERMINATION ADD POINT A1 /////
 // Declare your Termination class here, inheriting from Termination.
+// (Optional) also add it to TerminationDispatchList in Geodesic.h, so that the Geodesic calls it without virtual dispatch.
 // Sample code:
 /*
 // Forward declaration needed before Termination
@@ -226,8 +228,9 @@ public:
 	// from within your implementation of MyTermination::Reset(), so that the base class internal variable is also reset!
 	void Reset() final;
 
-	// Check the specific termination condition
-	Term CheckTermination() final;
+	// Check the specific termination condition, given the current position of the Geodesic and the number of steps
+	// it has taken (use DecideUpdate(TermOptions->UpdateEveryNSteps, step) to only check every so many steps)
+	Term CheckTermination(const Point& pos, largecounter step) final;
 
 	// Description string
 	std::string getFullDescriptionStr() const final;
@@ -4,6 +4,12 @@
 #include <sstream>
 #include <iomanip>
 
+#include <omp.h> // Needed to set the OpenMP loop schedule
+#include <algorithm> // std::stable_sort, std::min, std::max
+#include <numeric> // std::iota
+#include <fstream> // checkpoint files
+#include <filesystem> // std::filesystem::rename (checkpoint files)
+
 
 /// <summary>
 /// Utilities::Timer functions
@@ -21,6 +27,154 @@ double Utilities::Timer::elapsed() const
     return std::chrono::duration_cast<Second>(Clock::now() - m_beg).count();
 }
 
+/// <summary>
+/// Utilities::GeodesicScheduler functions
+/// </summary>
+
+Utilities::GeodesicScheduler::GeodesicScheduler(ScheduleType type, int chunksize, bool costordering, int costmapresolution)
+	: m_Type{ type }, m_ChunkSize{ std::max(chunksize, 0) },
+	m_CostOrdering{ costordering }, m_CostMapResolution{ std::max(costmapresolution, 1) }
+{
+	// We have no idea yet how expensive geodesics on any part of the screen are
+	if (m_CostOrdering)
+		m_CostMap = std::vector<double>(static_cast<size_t>(m_CostMapResolution) * m_CostMapResolution, -1.0);
+}
+
+largecounter Utilities::GeodesicScheduler::getCostMapCell(const ViewScreen* theView, largecounter index) const
+{
+	// Unit screen point has (x,y) coordinates between 0 and 1
+	ScreenPoint unitpoint{ theView->getUnitScreenPoint(index) };
+	int x = std::min(std::max(static_cast<int>(unitpoint[0] * m_CostMapResolution), 0), m_CostMapResolution - 1);
+	int y = std::min(std::max(static_cast<int>(unitpoint[1] * m_CostMapResolution), 0), m_CostMapResolution - 1);
+	return static_cast<largecounter>(x) * m_CostMapResolution + y;
+}
+
+void Utilities::GeodesicScheduler::SetSchedule() const
+{
+	// Set the schedule that will be used by the "schedule(runtime)" loop over the geodesics
+	omp_sched_t kind{ omp_sched_static };
+	if (m_Type == ScheduleType::Dynamic)
+		kind = omp_sched_dynamic;
+	else if (m_Type == ScheduleType::Guided)
+		kind = omp_sched_guided;
+	omp_set_schedule(kind, m_ChunkSize);
+}
+
+void Utilities::GeodesicScheduler::PrepareLoop(const ViewScreen* theView, largecounter nrgeodesics)
+{
+	// Reset the busy time of all threads (this can be called from inside or outside the parallel region)
+	m_ThreadBusyTimes = std::vector<double>(std::max(omp_get_num_threads(), omp_get_max_threads()), 0.0);
+
+	m_Order.clear();
+	if (!m_CostOrdering)
+		return;
+
+	m_GeodesicCosts = std::vector<float>(nrgeodesics, 0.0f);
+
+	// Cells that have not been visited by any geodesic yet are estimated to have the average cost
+	double totalcost{ 0.0 };
+	largecounter nrcellsknown{ 0 };
+	for (double c : m_CostMap)
+	{
+		if (c >= 0.0)
+		{
+			totalcost += c;
+			++nrcellsknown;
+		}
+	}
+	// No information at all (e.g. this is the first loop): integrate in natural order
+	if (nrcellsknown == 0)
+		return;
+	double averagecost{ totalcost / nrcellsknown };
+
+	std::vector<double> estimates(nrgeodesics);
+	for (largecounter index = 0; index < nrgeodesics; ++index)
+	{
+		double c{ m_CostMap[getCostMapCell(theView, index)] };
+		estimates[index] = c >= 0.0 ? c : averagecost;
+	}
+
+	// Most expensive geodesics first (stable, so that geodesics of similar cost stay close together on the screen)
+	m_Order.resize(nrgeodesics);
+	std::iota(m_Order.begin(), m_Order.end(), 0);
+	std::stable_sort(m_Order.begin(), m_Order.end(),
+		[&estimates](largecounter i, largecounter j) { return estimates[i] > estimates[j]; });
+}
+
+void Utilities::GeodesicScheduler::ThreadFinished(double busyseconds)
+{
+	// Every thread only writes to its own element
+	m_ThreadBusyTimes[omp_get_thread_num()] = busyseconds;
+}
+
+void Utilities::GeodesicScheduler::EndLoop(const ViewScreen* theView, double looptime)
+{
+	// Report the busy and idle time of every thread (only threads that have actually participated)
+	int nrthreads{ 0 };
+	double totalbusy{ 0.0 };
+	double minbusy{ looptime };
+	double maxbusy{ 0.0 };
+	for (int t = 0; t < static_cast<int>(m_ThreadBusyTimes.size()); ++t)
+	{
+		double busy{ m_ThreadBusyTimes[t] };
+		if (busy <= 0.0)
+			continue;
+		++nrthreads;
+		totalbusy += busy;
+		minbusy = std::min(minbusy, busy);
+		maxbusy = std::max(maxbusy, busy);
+		ScreenOutput("Thread " + std::to_string(t) + ": busy " + std::to_string(busy) + "s, idle "
+			+ std::to_string(std::max(looptime - busy, 0.0)) + "s.", OutputLevel::Level_3_ALLDETAIL);
+	}
+	if (nrthreads > 0 && looptime > 0.0)
+	{
+		double idlefraction{ 1.0 - totalbusy / (nrthreads * looptime) };
+		ScreenOutput("Thread busy time: min " + std::to_string(minbusy) + "s, average " + std::to_string(totalbusy / nrthreads)
+			+ "s, max " + std::to_string(maxbusy) + "s; threads were idle "
+			+ std::to_string(static_cast<int>(100 * std::max(idlefraction, 0.0))) + "% of the loop time.",
+			OutputLevel::Level_2_SUBPROC);
+	}
+
+	if (!m_CostOrdering)
+		return;
+
+	// Update the cost map with the average cost of the geodesics of this loop in every cell;
+	// cells that were not visited this loop keep their old estimate.
+	// Note: this must be called before the Mesh has moved on to its next loop, since we need the screen
+	// points of the geodesics of this loop!
+	std::vector<double> cellcosts(m_CostMap.size(), 0.0);
+	std::vector<largecounter> cellcounts(m_CostMap.size(), 0);
+	for (largecounter index = 0; index < m_GeodesicCosts.size(); ++index)
+	{
+		largecounter cell{ getCostMapCell(theView, index) };
+		cellcosts[cell] += m_GeodesicCosts[index];
+		++cellcounts[cell];
+	}
+	for (size_t cell = 0; cell < m_CostMap.size(); ++cell)
+	{
+		if (cellcounts[cell] > 0)
+			m_CostMap[cell] = cellcosts[cell] / cellcounts[cell];
+	}
+}
+
+std::string Utilities::GeodesicScheduler::getFullDescriptionStr() const
+{
+	std::string thestr{ "Scheduler: " };
+	if (m_Type == ScheduleType::Dynamic)
+		thestr += "dynamic";
+	else if (m_Type == ScheduleType::Guided)
+		thestr += "guided";
+	else
+		thestr += "static";
+	if (m_ChunkSize > 0)
+		thestr += " (chunk size " + std::to_string(m_ChunkSize) + ")";
+	if (m_CostOrdering)
+		thestr += ", ordered by estimated cost (cost map " + std::to_string(m_CostMapResolution) + "x"
+		+ std::to_string(m_CostMapResolution) + ")";
+
+	return thestr;
+}
+
 /// <summary>
 /// Other functions in Utilities
 /// </summary>
@@ -49,6 +203,18 @@ std::vector<std::string> Utilities::GetDiagNameStrings(DiagBitflag alldiags, Dia
 	return thediagstrings;
 }
 
+std::vector<int> Utilities::GetDiagFullDataValCounts(DiagBitflag alldiags, DiagBitflag valdiag)
+{
+	// As above, we temporarily create all the Diagnostics that are turned on
+	std::vector<int> thecounts{};
+	DiagnosticUniqueVector tempDiags{ CreateDiagnosticVector(alldiags, valdiag, nullptr) };
+	thecounts.reserve(tempDiags.size());
+	for (const auto& d : tempDiags)
+		thecounts.push_back(d->getFullDataValCount());
+
+	return thecounts;
+}
+
 std::string Utilities::GetFirstLineInfoString(const Metric* theMetric, const Source* theSource,
 	DiagBitflag alldiags, DiagBitflag valdiag,
 	TermBitflag allterms, const ViewScreen* theView)
@@ -82,4 +248,108 @@ std::string Utilities::GetFirstLineInfoString(const Metric* theMetric, const Sou
 	return "Metric: " + theMetric->getFullDescriptionStr() + "; "
 		+ "Source: " + theSource->getFullDescriptionStr() + "; " + fulldiagstring + "; "
 		+ fulltermstring + "; " + theView->getFullDescriptionStr() + "; " + Integrators::GetFullIntegratorDescription();
-}
\ No newline at end of file
+}
+
+// Checkpoint files start with this, followed by a version number (uint32)
+namespace
+{
+	constexpr char CheckpointMagic[]{ "FOORTCHK" };
+	constexpr std::uint32_t CheckpointVersion{ 1 };
+}
+
+bool Utilities::SaveCheckpoint(const std::string& filename, const std::string& runinfo, largecounter iterations,
+	const ViewScreen* theView, GeodesicOutputHandler* theOutputHandler)
+{
+	const std::string tempfilename{ filename + ".tmp" };
+
+	// Make sure the directory of the checkpoint file exists
+	auto pos = filename.find_last_of("/");
+	if (pos != std::string::npos)
+	{
+		std::error_code ec{};
+		std::filesystem::create_directories(filename.substr(0, pos), ec);
+	}
+
+	{ // temp scope so that the file is closed before it is renamed
+		std::ofstream outf{ tempfilename, std::ios::out | std::ios::trunc | std::ios::binary };
+		if (!outf)
+		{
+			ScreenOutput("Could not open checkpoint file " + tempfilename + "!", OutputLevel::Level_0_WARNING);
+			return false;
+		}
+
+		outf.write(CheckpointMagic, 8);
+		Checkpoint::Write(outf, CheckpointVersion);
+		Checkpoint::WriteString(outf, runinfo);
+		Checkpoint::Write(outf, static_cast<std::uint64_t>(iterations));
+
+		if (!theView->SaveCheckpoint(outf))
+		{
+			ScreenOutput("The Mesh does not support checkpoints; no checkpoint written.", OutputLevel::Level_0_WARNING);
+			outf.close();
+			std::error_code ec{};
+			std::filesystem::remove(tempfilename, ec);
+			return false;
+		}
+		// Note: this writes all output so far to file
+		theOutputHandler->SaveCheckpoint(outf);
+
+		outf.flush();
+		if (!outf)
+		{
+			ScreenOutput("Could not write checkpoint file " + tempfilename + "!", OutputLevel::Level_0_WARNING);
+			return false;
+		}
+	}
+
+	// Replace the previous checkpoint
+	std::error_code ec{};
+	std::filesystem::rename(tempfilename, filename, ec);
+	if (ec)
+	{
+		ScreenOutput("Could not write checkpoint file " + filename + "!", OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	return true;
+}
+
+bool Utilities::LoadCheckpoint(const std::string& filename, const std::string& runinfo, largecounter& iterations,
+	ViewScreen* theView, GeodesicOutputHandler* theOutputHandler)
+{
+	std::ifstream inf{ filename, std::ios::in | std::ios::binary };
+	if (!inf)
+	{
+		ScreenOutput("Could not open checkpoint file " + filename + "!", OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	char magic[8]{};
+	std::uint32_t version{};
+	std::string savedruninfo{};
+	std::uint64_t savediterations{};
+	if (!inf.read(magic, 8) || std::string_view(magic, 8) != std::string_view(CheckpointMagic, 8)
+		|| !Checkpoint::Read(inf, version) || version != CheckpointVersion
+		|| !Checkpoint::ReadString(inf, savedruninfo) || !Checkpoint::Read(inf, savediterations))
+	{
+		ScreenOutput(filename + " is not a valid checkpoint file!", OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	// We can only continue the run if everything is set up exactly the same
+	if (savedruninfo != runinfo)
+	{
+		ScreenOutput("Checkpoint file " + filename + " was written by a run with different settings:\n"
+			+ savedruninfo, OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	if (!theView->LoadCheckpoint(inf) || !theOutputHandler->LoadCheckpoint(inf))
+	{
+		ScreenOutput("Could not load checkpoint from " + filename + "!", OutputLevel::Level_0_WARNING);
+		return false;
+	}
+
+	iterations = static_cast<largecounter>(savediterations);
+	return true;
+}
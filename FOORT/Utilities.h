@@ -14,6 +14,7 @@
 #include "Geodesic.h"
 #include "ViewScreen.h"
 #include "Integrators.h"
+#include "InputOutput.h"
 
 #include <chrono> // for timer functionality
 #include <string> // for strings
@@ -41,16 +42,118 @@ namespace Utilities
         double elapsed() const;
     };
 
+    // How the geodesics of an integration loop are distributed over the threads
+    // (these correspond to the OpenMP loop schedules)
+    enum class ScheduleType
+    {
+        Static,     // every thread gets an (equal) fixed block of geodesics in advance
+        Dynamic,    // threads grab a new chunk of geodesics whenever they are done with their previous chunk
+        Guided      // like Dynamic, but chunks start large and shrink as the loop progresses
+    };
+
+    // GeodesicScheduler decides in which order the geodesics of each integration loop are handed out to the threads,
+    // and keeps track of how much time each thread spends integrating (as opposed to waiting for other threads).
+    // Geodesics can cost vastly different amounts of time (e.g. geodesics falling into a horizon versus geodesics
+    // orbiting close to the photon sphere until they time out), so a static schedule can leave many threads idle
+    // at the end of a loop. If cost ordering is turned on, the time taken by each geodesic is recorded on a
+    // coarse map of the screen, and in the next loop the geodesics landing in the most expensive regions of the screen
+    // are integrated first (so that cheap geodesics can fill up the gaps at the end of the loop).
+    class GeodesicScheduler
+    {
+    public:
+        // Constructor: specify the schedule type and chunk size (0: OpenMP default chunk size),
+        // whether to order geodesics by their estimated cost, and the resolution of the (square) cost map on the screen
+        GeodesicScheduler(ScheduleType type = ScheduleType::Static, int chunksize = 0,
+            bool costordering = false, int costmapresolution = 32);
+
+        // Sets the OpenMP loop schedule; must be called outside of any parallel region
+        // (the threads of a parallel region inherit the schedule from the thread that starts the region)
+        void SetSchedule() const;
+
+        // Called (by a single thread) before every integration loop.
+        // If cost ordering is on, this determines the order of the geodesics
+        void PrepareLoop(const ViewScreen* theView, largecounter nrgeodesics);
+
+        // The geodesic index (as passed to the ViewScreen) that should be integrated as the loopindex-th geodesic
+        largecounter getGeodesicIndex(largecounter loopindex) const
+        {
+            return m_Order.empty() ? loopindex : m_Order[loopindex];
+        }
+
+        // Record the (wall) time taken to integrate a geodesic (threadsafe: every geodesic is only recorded once)
+        void GeodesicCost(largecounter index, double seconds)
+        {
+            if (m_CostOrdering)
+                m_GeodesicCosts[index] = static_cast<float>(seconds);
+        }
+
+        // Record the total time spent integrating geodesics in the current thread (called once by every thread)
+        void ThreadFinished(double busyseconds);
+
+        // Called by a single thread after all threads are done with the loop (and before the ViewScreen ends its loop!):
+        // reports the busy/idle time of each thread, and updates the cost map with the costs of this loop
+        void EndLoop(const ViewScreen* theView, double looptime);
+
+        // Description string getter
+        std::string getFullDescriptionStr() const;
+
+    private:
+        // Schedule and chunk size used for the OpenMP loop
+        const ScheduleType m_Type;
+        const int m_ChunkSize;
+
+        // Cost ordering settings
+        const bool m_CostOrdering;
+        const int m_CostMapResolution;
+
+        // The order in which the geodesics are integrated in the current loop (empty: natural order)
+        std::vector<largecounter> m_Order{};
+        // The time taken by every geodesic in the current loop
+        std::vector<float> m_GeodesicCosts{};
+        // Average time taken by a geodesic in each cell of the cost map on the screen (negative: no estimate yet)
+        std::vector<double> m_CostMap{};
+
+        // Busy time of each thread in the current loop
+        std::vector<double> m_ThreadBusyTimes{};
+
+        // Helper function that returns the cell in the cost map that the geodesic lands in
+        largecounter getCostMapCell(const ViewScreen* theView, largecounter index) const;
+    };
+
     // Returns a string of the current time (in a format that can be used to append to file names)
     std::string GetTimeStampString();
 
     // Helper function to get all Diagnostic Names (for outputting to files)
     std::vector<std::string> GetDiagNameStrings(DiagBitflag alldiags, DiagBitflag valdiag);
 
+    // Helper function to get the (fixed) number of values that every Diagnostic outputs for a geodesic,
+    // in the same order as GetDiagNameStrings() (-1 for a Diagnostic whose number of values can vary)
+    std::vector<int> GetDiagFullDataValCounts(DiagBitflag alldiags, DiagBitflag valdiag);
+
     // This returns the full string to be written to every output file as its first line
     // It contains information about all the settings used to produce the output
     std::string GetFirstLineInfoString(const Metric* theMetric, const Source* theSource,
         DiagBitflag alldiags, DiagBitflag valdiag, TermBitflag allterms, const ViewScreen* theView);
+
+    // Options for checkpointing a run: every few iterations, the state of the Mesh and of the output files
+    // is written to a checkpoint file, so that an interrupted run can be resumed from there
+    struct CheckpointOptions
+    {
+        std::string FileName{};     // the checkpoint file
+        int Interval{ 0 };          // write a checkpoint after every this many iterations (0: never)
+        bool Resume{ false };       // resume the run from the checkpoint file
+    };
+
+    // Writes a checkpoint (between iterations): the description of the run (i.e. the first line info string, see above),
+    // the number of iterations done so far, and the state of the ViewScreen's Mesh and the output handler.
+    // The checkpoint is first written to a temporary file, which then replaces the previous checkpoint
+    // (so that a run interrupted while writing still has the previous checkpoint). Returns false if this failed.
+    bool SaveCheckpoint(const std::string& filename, const std::string& runinfo, largecounter iterations,
+        const ViewScreen* theView, GeodesicOutputHandler* theOutputHandler);
+    // Loads a checkpoint written by SaveCheckpoint() into a freshly created ViewScreen and output handler
+    // (the run must have exactly the same description); sets the number of iterations done. Returns false if this failed
+    bool LoadCheckpoint(const std::string& filename, const std::string& runinfo, largecounter& iterations,
+        ViewScreen* theView, GeodesicOutputHandler* theOutputHandler);
 }
 
 #endif
@@ -1,6 +1,91 @@
 #include "ViewScreen.h" // We are implementing ViewScreen member functions
 
 #include <algorithm> // for std::max
+#include <vector> // buffer of screen points (batches of initial conditions)
+
+/// <summary>
+/// CameraRayGenerator functions
+/// </summary>
+
+CameraRayGenerator::CameraRayGenerator(Point pos, ScreenPoint screensize, ScreenPoint screencenter, bool rlogscale,
+	const TwoIndex& vielbein, const TwoIndex& metric_dd)
+	: m_InitPos{ pos }, m_r{ pos[1] }, m_rSquared{ pos[1] * pos[1] }, m_SinTheta{ sin(pos[2]) },
+	m_ScreenSize{ screensize }, m_ScreenCenter{ screencenter }, m_Metric_t{ metric_dd[0] }
+{
+	// Adjust r coordinate if using logarithmic coordinate
+	m_InitPos[1] = rlogscale ? log(pos[1]) : pos[1];
+
+	for (int i = 0; i < dimension; ++i)
+		for (int j = 0; j < dimension; ++j)
+			m_VielbeinT[i][j] = vielbein[j][i];
+}
+
+OneIndex CameraRayGenerator::FlatVelocity(const ScreenPoint& unitpoint) const
+{
+	// Rescale the screen point into our alpha and beta;
+	// alpha runs from screencenter_x-screenwidth/2 to screencenter_y+screenwidth/2 and beta similarly with screenheight
+	real alpha = m_ScreenCenter[0] + m_ScreenSize[0] * (unitpoint[0] - 0.5);
+	real beta = m_ScreenCenter[1] + m_ScreenSize[1] * (unitpoint[1] - 0.5);
+
+	// Note: currently only radially inpointing camera is supported
+
+	// flat frame initial velocity (see FOORT physics documentation)
+	real densqrt{ sqrt(m_rSquared + alpha * alpha + beta * beta) };
+	return OneIndex{ -1.0, -m_r / densqrt, -beta / m_r / densqrt, alpha / m_r / m_SinTheta / densqrt };
+}
+
+OneIndex CameraRayGenerator::CurvedVelocity(const OneIndex& pflat_u) const
+{
+	// convert flat frame initial velocity to curved space initial velocity using vielbein
+	OneIndex vel{};
+	for (int i = 0; i < dimension; ++i)
+		for (int j = 0; j < dimension; ++j)
+			vel[i] += m_VielbeinT[i][j] * pflat_u[j];
+
+	// rescale velocity so that E = +p_t (+ sign because past-pointing!)
+	real energy{ 1.0 }; // energy is arbitrary for null geodesics
+	real curenergy{};
+	for (int i = 0; i < dimension; ++i)
+		curenergy += m_Metric_t[i] * vel[i];
+	for (int i = 0; i < dimension; ++i)
+		vel[i] = vel[i] * energy / curenergy;
+
+	return vel;
+}
+
+OneIndex CameraRayGenerator::getVelocity(const ScreenPoint& unitpoint) const
+{
+	OneIndex vel{ CurvedVelocity(FlatVelocity(unitpoint)) };
+
+	// Check to make sure vel is still past-pointing and inward-pointing
+	if (vel[0] > 0)
+		ScreenOutput("Initial velocity of geodesic is future-pointing (should be past-pointing)!", OutputLevel::Level_0_WARNING);
+	if (vel[1] > 0)
+		ScreenOutput("Initial velocity of geodesic is outward-pointing (should be inward-pointing)!", OutputLevel::Level_0_WARNING);
+
+	return vel;
+}
+
+void CameraRayGenerator::getVelocities(const ScreenPoint* unitpoints, std::size_t nrpoints, OneIndex* vels) const
+{
+	// The points are independent, so that the compiler can interleave (vectorize) the calculations for several points
+	for (std::size_t k = 0; k < nrpoints; ++k)
+		vels[k] = CurvedVelocity(FlatVelocity(unitpoints[k]));
+
+	// Check to make sure all velocities are still past-pointing and inward-pointing (warning only once for the batch)
+	bool futurepointing{ false };
+	bool outwardpointing{ false };
+	for (std::size_t k = 0; k < nrpoints; ++k)
+	{
+		futurepointing = futurepointing || vels[k][0] > 0;
+		outwardpointing = outwardpointing || vels[k][1] > 0;
+	}
+	if (futurepointing)
+		ScreenOutput("Initial velocity of geodesic is future-pointing (should be past-pointing)!", OutputLevel::Level_0_WARNING);
+	if (outwardpointing)
+		ScreenOutput("Initial velocity of geodesic is outward-pointing (should be inward-pointing)!", OutputLevel::Level_0_WARNING);
+}
+
 
 /// <summary>
 /// ViewScreen functions
@@ -72,50 +157,58 @@ void ViewScreen::ConstructVielbein()
 	}
 }
 
-void ViewScreen::SetNewInitialConditions(largecounter index, Point& pos, OneIndex& vel, ScreenIndex& scrIndex) const
+void ViewScreen::SetUpEquatorialMirror()
 {
-	// The position of all geodesics is the same: the position of the camera
-	pos = m_Pos;
-	// Adjust r coordinate if using logarithmic coordinate
-	pos[1] = m_rLogScale ? log(pos[1]) : pos[1];
+	// The reflection must be a symmetry of the metric and must map the screen onto itself
+	std::string reason{};
+	if (!m_theMetric->IsEquatoriallySymmetric())
+		reason = "the metric is not equatorially symmetric";
+	else if (fabs(m_Pos[2] - pi / 2.0) > 1e-6)
+		reason = "the camera is not on the equator (theta = pi/2)";
+	else if (m_ScreenCenter[1] != 0.0)
+		reason = "the screen is not centered on the equator (screen center y = 0)";
+	else if (!m_theMesh->UseMirrorSymmetry())
+		reason = "the Mesh does not support it";
+
+	if (!reason.empty())
+	{
+		ScreenOutput("Equatorial mirror symmetry cannot be used, since " + reason + "; all pixels will be integrated.",
+			OutputLevel::Level_0_WARNING);
+		return;
+	}
 
+	ScreenOutput("Using equatorial mirror symmetry: only half of the screen will be integrated.", OutputLevel::Level_2_SUBPROC);
+}
+
+void ViewScreen::SetNewInitialConditions(largecounter index, Point& pos, OneIndex& vel, ScreenIndex& scrIndex) const
+{
 	// Get a new screen point (with (x,y) coordinates between 0 and 1)
 	// from the Mesh
 	ScreenPoint UnitScreenPos{};
 	m_theMesh->getNewInitConds(index, UnitScreenPos, scrIndex);
-	// Rescale these into our alpha and beta;
-	// alpha runs from screencenter_x-screenwidth/2 to screencenter_y+screenwidth/2 and beta similarly with screenheight
-	real alpha = m_ScreenCenter[0] + m_ScreenSize[0] * (UnitScreenPos[0] - 0.5);
-	real beta = m_ScreenCenter[1] + m_ScreenSize[1] * (UnitScreenPos[1] - 0.5);
-	
-	// Note: currently only radially inpointing camera is supported (we do not check m_Direction)
-
-	real sintheta0 = sin(pos[2]);
 
-	// flat frame initial velocity (see FOORT physics documentation)
-	real densqrt{ sqrt(m_Pos[1] * m_Pos[1] + alpha * alpha + beta * beta) };
-	OneIndex pflat_u{ -1.0, -m_Pos[1] / densqrt, -beta / m_Pos[1] / densqrt, alpha / m_Pos[1] / sintheta0 / densqrt };
-
-	// convert flat frame initial velocity to curved space initial velocity using vielbein
-	vel = OneIndex{};
-	for (int i = 0; i < dimension; ++i)
-		for (int j = 0; j < dimension; ++j)
-			vel[i] += m_Vielbein[j][i] * pflat_u[j];
+	// The position of all geodesics is the same: the position of the camera;
+	// the ray generator converts the screen point into the initial velocity
+	pos = m_RayGenerator.getPosition();
+	vel = m_RayGenerator.getVelocity(UnitScreenPos);
 
-	// rescale velocity so that E = +p_t (+ sign because past-pointing!)
-	real energy{ 1.0 }; // energy is arbitrary for null geodesics
-	real curenergy{};
-	for (int i = 0; i < dimension; ++i)
-		curenergy += m_Metric_dd[0][i] * vel[i];
-	vel = vel * energy / curenergy;
+	// pos and vel have been set (scrIndex was set above by the call to Mesh already), so we are done!
+}
 
-	// Check to make sure vel is still past-pointing and inward-pointing
-	if (vel[0] > 0)
-		ScreenOutput("Initial velocity of geodesic is future-pointing (should be past-pointing)!", OutputLevel::Level_0_WARNING);
-	if (vel[1] > 0)
-		ScreenOutput("Initial velocity of geodesic is outward-pointing (should be inward-pointing)!", OutputLevel::Level_0_WARNING);
+void ViewScreen::SetNewInitialConditions(const largecounter* indices, std::size_t nrgeodesics,
+	Point* pos, OneIndex* vel, ScreenIndex* scrIndex) const
+{
+	// Get all screen points from the Mesh first (every thread has its own buffer for these)
+	thread_local std::vector<ScreenPoint> UnitScreenPos{};
+	UnitScreenPos.resize(nrgeodesics);
+	for (std::size_t k = 0; k < nrgeodesics; ++k)
+	{
+		m_theMesh->getNewInitConds(indices[k], UnitScreenPos[k], scrIndex[k]);
+		pos[k] = m_RayGenerator.getPosition();
+	}
 
-	// pos and vel have been set (scrIndex was set above by the call to Mesh already), so we are done!
+	// Then convert all of them to initial velocities at once
+	m_RayGenerator.getVelocities(UnitScreenPos.data(), nrgeodesics, vel);
 }
 
 /* OLD (RAPTOR/KERR) IMPLEMENTATION OF INITIAL CONDITIONS
@@ -187,6 +280,15 @@ void ViewScreen::SetNewInitialConditionsOLD(largecounter index, Point& pos, OneI
 }
 */
 
+ScreenPoint ViewScreen::getUnitScreenPoint(largecounter index) const
+{
+	// pass on information to the Mesh (we do not need the screen index)
+	ScreenPoint UnitScreenPos{};
+	ScreenIndex scrIndex{};
+	m_theMesh->getNewInitConds(index, UnitScreenPos, scrIndex);
+	return UnitScreenPos;
+}
+
 bool ViewScreen::IsFinished() const
 {
 	// pass on information to the Mesh
@@ -205,10 +307,40 @@ void ViewScreen::EndCurrentLoop()
 	m_theMesh->EndCurrentLoop();
 }
 
-void ViewScreen::GeodesicFinished(largecounter index, std::vector<real> finalValues)
+void ViewScreen::GeodesicFinished(largecounter index, const std::vector<real>& finalValues)
+{
+	// pass on information to the Mesh
+	m_theMesh->GeodesicFinished(index, finalValues);
+}
+
+bool ViewScreen::SaveCheckpoint(std::ostream& out) const
+{
+	// pass on information to the Mesh
+	return m_theMesh->SaveCheckpoint(out);
+}
+
+bool ViewScreen::LoadCheckpoint(std::istream& in)
+{
+	// pass on information to the Mesh
+	return m_theMesh->LoadCheckpoint(in);
+}
+
+bool ViewScreen::getPreviousOutput(std::string& previousoutput, largecounter& indexscale) const
+{
+	// pass on information to the Mesh
+	return m_theMesh->getPreviousOutput(previousoutput, indexscale);
+}
+
+largecounter ViewScreen::getCurNrMirrorImages() const
+{
+	// pass on information to the Mesh
+	return m_theMesh->getCurNrMirrorImages();
+}
+
+bool ViewScreen::getMirrorImage(largecounter index, largecounter& mirrorindex, ScreenIndex& mirrorscreenindex) const
 {
 	// pass on information to the Mesh
-	m_theMesh->GeodesicFinished(index, std::move(finalValues));
+	return m_theMesh->getMirrorImage(index, mirrorindex, mirrorscreenindex);
 }
 
 std::string ViewScreen::getFullDescriptionStr() const
@@ -17,6 +17,7 @@
 #include <utility> // std::move
 #include <array> // std::array
 #include <string> // strings
+#include <cstddef> // std::size_t
 
 
 // Type of geodesic being integrated. NOTE: only Null supported/implemented at the moment!
@@ -27,6 +28,50 @@ enum class GeodesicType
 	Spacelike = 1,
 };
 
+// CameraRayGenerator: converts points on the screen into the initial conditions (position and velocity) of geodesics.
+// Everything that only depends on the camera (its position in the Metric's coordinates, the vielbein and metric there,
+// the screen size and center) is computed once, when it is constructed, so that generating a ray only takes a few
+// arithmetic operations. Rays can be generated one at a time, or for a whole batch of screen points in one call
+// (e.g. to refill the lanes of a GeodesicBatch).
+class CameraRayGenerator
+{
+public:
+	// Default constructor creates an unusable generator (the ViewScreen creates the actual one once the vielbein is known)
+	CameraRayGenerator() = default;
+	// Construct from the camera position (r not yet logarithmic), screen size and center, whether the Metric
+	// uses a logarithmic r coordinate, and the vielbein and metric at the camera position
+	CameraRayGenerator(Point pos, ScreenPoint screensize, ScreenPoint screencenter, bool rlogscale,
+		const TwoIndex& vielbein, const TwoIndex& metric_dd);
+
+	// The initial position of every geodesic: the position of the camera (in the Metric's coordinates)
+	const Point& getPosition() const { return m_InitPos; }
+
+	// The initial velocity of the geodesic through the screen point with (x,y) coordinates between 0 and 1
+	OneIndex getVelocity(const ScreenPoint& unitpoint) const;
+	// Same, for nrpoints screen points at once (vels must have room for nrpoints velocities)
+	void getVelocities(const ScreenPoint* unitpoints, std::size_t nrpoints, OneIndex* vels) const;
+
+private:
+	// The initial position of every geodesic
+	Point m_InitPos{};
+	// Camera radius (not logarithmic), its square, and sin(theta) at the camera
+	real m_r{};
+	real m_rSquared{};
+	real m_SinTheta{};
+	// The screen size and center (in physical units of length)
+	ScreenPoint m_ScreenSize{};
+	ScreenPoint m_ScreenCenter{};
+	// The vielbein, transposed so that the curved velocity is m_VielbeinT * (flat frame velocity)
+	TwoIndex m_VielbeinT{};
+	// The t row of the metric at the camera (used to normalize the energy of the geodesics)
+	OneIndex m_Metric_t{};
+
+	// Helper function: the flat frame velocity of the geodesic through the screen point
+	OneIndex FlatVelocity(const ScreenPoint& unitpoint) const;
+	// Helper function: the curved space velocity (normalized to have energy 1) corresponding to the flat frame velocity
+	OneIndex CurvedVelocity(const OneIndex& pflat_u) const;
+};
+
 // ViewScreen class: this class is in charge of converting a pixel on the screen (which the Mesh wants to integrate)
 // to physical initial conditions for the position and velocity of a geodesic. It owns a Mesh instance, which will tell it
 // which pixels to integrate etc.
@@ -41,8 +86,10 @@ public:
 	// - the Mesh used (ViewScreen must become a owner of this object!)
 	// - the Metric used (ViewScreen is NOT the owner of the Metric)
 	// - the geodesic type to be integrated (null, timelike, spacelike)
+	// - whether to use the equatorial mirror symmetry of the configuration (only integrating half of the screen, see below)
 	ViewScreen(Point pos, OneIndex dir, ScreenPoint screensize, ScreenPoint screencenter,
-		std::unique_ptr<Mesh> theMesh, const Metric* const theMetric, GeodesicType thegeodtype=GeodesicType::Null) 
+		std::unique_ptr<Mesh> theMesh, const Metric* const theMetric, GeodesicType thegeodtype=GeodesicType::Null,
+		bool equatorialmirror=false) 
 		: m_Pos{ pos }, m_Direction{ dir }, m_ScreenSize{ screensize }, m_ScreenCenter{ screencenter },
 		m_theMesh{ std::move(theMesh) },
 		m_theMetric{theMetric},	m_GeodType{ thegeodtype },
@@ -64,19 +111,44 @@ public:
 
 		// Construct the vielbein now
 		ConstructVielbein();
+
+		// Everything needed to generate the geodesics' initial conditions is known now
+		m_RayGenerator = CameraRayGenerator(m_Pos, m_ScreenSize, m_ScreenCenter, m_rLogScale, m_Vielbein, m_Metric_dd);
+
+		// Check if we can use the mirror symmetry (if asked to)
+		if (equatorialmirror)
+			SetUpEquatorialMirror();
 	}
 
 	// Heart of the ViewScreen: here, the ViewScreen is asked to provide initial conditions
 	// for the geodesic nr index of the current iteration; based on the screen index
 	// that the Mesh gives, it sets up these physical initial conditions.
 	void SetNewInitialConditions(largecounter index, Point& pos, OneIndex& vel, ScreenIndex& scrIndex) const;
+	// Same, for the nrgeodesics geodesics with the given indices at once
+	// (pos, vel and scrIndex must have room for nrgeodesics entries)
+	void SetNewInitialConditions(const largecounter* indices, std::size_t nrgeodesics,
+		Point* pos, OneIndex* vel, ScreenIndex* scrIndex) const;
+
+	// The ray generator that converts screen points to initial conditions (e.g. for use by batched integrators)
+	const CameraRayGenerator& getRayGenerator() const { return m_RayGenerator; }
+
+	// The position on the screen (with (x,y) coordinates between 0 and 1) of the geodesic nr index of the current iteration
+	ScreenPoint getUnitScreenPoint(largecounter index) const;
 
 	// These member functions essentially pass on information to/from the Mesh
 	bool IsFinished() const; // Does the ViewScreen (i.e. the Mesh) want to integrate more geodesics or not?
 	largecounter getCurNrGeodesics() const; // Current number of geodesics in this iteration
 	void EndCurrentLoop(); // The current iteration of geodesics is finished; prepare the next one
 	// NOTE: despite not being const, this function has been designed to be threadsafe!
-	void GeodesicFinished(largecounter index, std::vector<real> finalValues); // This geodesic has been integrated, returning its final "values"
+	void GeodesicFinished(largecounter index, const std::vector<real>& finalValues); // This geodesic has been integrated, returning its final "values"
+	bool SaveCheckpoint(std::ostream& out) const; // Write the state of the Mesh to a checkpoint (false if not supported)
+	bool LoadCheckpoint(std::istream& in); // Read the state of the Mesh back in from a checkpoint (false if failed)
+	// Does the Mesh continue from the output of a previous run? (see Mesh::getPreviousOutput())
+	bool getPreviousOutput(std::string& previousoutput, largecounter& indexscale) const;
+	// Mirror symmetry (see Mesh::UseMirrorSymmetry()): the number of mirror pixels in the current iteration,
+	// and the index and screen index of the mirror image of geodesic nr index (returns false if it has none)
+	largecounter getCurNrMirrorImages() const;
+	bool getMirrorImage(largecounter index, largecounter& mirrorindex, ScreenIndex& mirrorscreenindex) const;
 
 	// Description string getter (spaces allowed), also will contain information about the Mesh
 	std::string getFullDescriptionStr() const;
@@ -90,6 +162,15 @@ private:
 	// Helper function to construct the vielbein given the metric
 	void ConstructVielbein();
 
+	// Helper function that sets up the Mesh to only integrate half of the screen, if the configuration is symmetric
+	// under the equatorial reflection theta -> pi - theta: the camera must sit on the equator of an equatorially symmetric
+	// Metric, with the screen centered on the equator. The image is then symmetric under beta -> -beta,
+	// and the geodesic of a mirror pixel is the reflection of the geodesic of the pixel itself (see Geodesic::ReflectEquatorially()).
+	void SetUpEquatorialMirror();
+
+	// Generates the initial conditions from the screen points (constructed after the vielbein)
+	CameraRayGenerator m_RayGenerator{};
+
 	// The position and looking direction of the camera
 	const Point m_Pos;
 	const OneIndex m_Direction;